@@ -46,7 +46,13 @@ public class Blend4Real : ModuleRules
 				"Kismet",
 				"SubobjectEditor",
 				"SubobjectDataInterface",
-				"ComponentVisualizers"
+				"ComponentVisualizers",
+				"DerivedDataCache",
+				"TypedElementFramework",
+				"TypedElementRuntime",
+				"Foliage",
+				"AnimGraphRuntime",
+				"Persona"
 			}
 		);
 
@@ -2,6 +2,9 @@
 #include "Blend4RealCommands.h"
 #include "Blend4RealStyle.h"
 #include "Blend4RealInputProcessor.h"
+#include "FActorBoundsTree.h"
+#include "FMeshBVHPicker.h"
+#include "FTransformHandlerFactory.h"
 #include "LevelEditor.h"
 #include "Widgets/Docking/SDockTab.h"
 #include "ToolMenus.h"
@@ -35,6 +38,9 @@ void FBlend4RealModule::StartupModule()
 		LevelEditorModule.GetToolBarExtensibilityManager()->AddExtender(ToolbarExtender);
 	}
 
+	FMeshBVHPicker::Initialize();
+	FActorBoundsTree::Initialize();
+	FTransformHandlerFactory::Initialize();
 	BlenderInputHandler = MakeShareable(new FBlend4RealInputProcessor());
 
 	// Subscribe to PIE events to disable the input processor during gameplay
@@ -54,6 +60,10 @@ void FBlend4RealModule::ShutdownModule()
 		BlenderInputHandler.Reset();
 	}
 
+	FMeshBVHPicker::Shutdown();
+	FActorBoundsTree::Shutdown();
+	FTransformHandlerFactory::Shutdown();
+
 	// Unregister UI elements
 	UToolMenus::UnRegisterStartupCallback(this);
 	UToolMenus::UnregisterOwner(this);
@@ -5,6 +5,8 @@
 #include "FTransformController.h"
 #include "FSelectionActionsController.h"
 #include "FPivotVisualizationController.h"
+#include "FViewportRedrawController.h"
+#include "FHoverPickPrefetcher.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Editor.h"
 #include "EditorModeManager.h"
@@ -19,9 +21,11 @@ FBlend4RealInputProcessor::FBlend4RealInputProcessor()
 	  , LastMousePosition(FVector2D::ZeroVector)
 {
 	// Create controllers
-	TransformController = MakeShareable(new FTransformController());
-	NavigationController = MakeShareable(new FNavigationController());
-	SelectionActionsController = MakeShareable(new FSelectionActionsController(TransformController));
+	RedrawController = MakeShareable(new FViewportRedrawController());
+	HoverPickPrefetcher = MakeShareable(new FHoverPickPrefetcher());
+	TransformController = MakeShareable(new FTransformController(RedrawController));
+	NavigationController = MakeShareable(new FNavigationController(RedrawController, HoverPickPrefetcher));
+	SelectionActionsController = MakeShareable(new FSelectionActionsController(TransformController, RedrawController));
 	PivotVisualizationController = MakeShareable(new FPivotVisualizationController());
 
 	// Note: We can't call SharedThis() or GLevelEditorModeTools() during construction.
@@ -92,6 +96,10 @@ void FBlend4RealInputProcessor::ToggleEnabled(const bool bInvalidateRender)
 	}
 	else
 	{
+		// Tick() stops with the input processor (e.g. when PIE starts), nothing may be left in progress.
+		// The redraws requested by the cancellation are done now, for the same reason.
+		SelectionActionsController->CancelPendingOperations();
+		RedrawController->Flush(0.f);
 		UnregisterInputProcessor();
 		PivotVisualizationController->Disable();
 		UE_LOG(LogTemp, Display, TEXT("Blender Controls: Disabled"));
@@ -186,6 +194,37 @@ void FBlend4RealInputProcessor::Tick(const float DeltaTime, FSlateApplication& S
 			}
 		}
 	}
+
+	// Trace the scene under the resting cursor so navigation can start from a cached hit.
+	// The scene and camera are being edited during operations, nothing to prefetch then.
+	if (bIsEnabled && HoverPickPrefetcher.IsValid())
+	{
+		if (NavigationController->IsNavigating() || TransformController->IsTransforming())
+		{
+			HoverPickPrefetcher->Invalidate();
+		}
+		else
+		{
+			HoverPickPrefetcher->Tick(SlateApp.GetCursorPos());
+		}
+	}
+
+	// Apply the async surface snapping and drop to surface results of the previous frames
+	if (bIsEnabled && TransformController.IsValid())
+	{
+		TransformController->Tick();
+	}
+	// Always ticked, a drop in progress restores the selection collision filters when it completes
+	if (SelectionActionsController.IsValid())
+	{
+		SelectionActionsController->Tick();
+	}
+
+	// Perform the viewport redraws requested by the controllers since last tick
+	if (RedrawController.IsValid())
+	{
+		RedrawController->Flush(DeltaTime);
+	}
 }
 
 bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp, const FKeyEvent& InKeyEvent)
@@ -195,6 +234,24 @@ bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp,
 		return false;
 	}
 
+	const EModifierKey::Type ModMask = EModifierKey::FromBools(
+		InKeyEvent.IsControlDown(),
+		InKeyEvent.IsAltDown(),
+		InKeyEvent.IsShiftDown(),
+		InKeyEvent.IsCommandDown());
+	const FKey Key = InKeyEvent.GetKey();
+
+	// Repeat Last spawns over several frames in an open transaction: Escape cancels it, any other key is consumed
+	// wherever the mouse is, so no other edit is recorded in its transaction
+	if (SelectionActionsController->IsRepeating())
+	{
+		if (Key == EKeys::Escape && ModMask == 0)
+		{
+			SelectionActionsController->CancelRepeat();
+		}
+		return true;
+	}
+
 	// Only process input if mouse is over a viewport (not requiring keyboard focus)
 	// This allows transforms to be initiated after selecting components in the outliner
 	// Exception: allow input during ongoing transforms (for axis keys, numeric input, etc.)
@@ -204,13 +261,6 @@ bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp,
 		return false;
 	}
 
-	const EModifierKey::Type ModMask = EModifierKey::FromBools(
-		InKeyEvent.IsControlDown(),
-		InKeyEvent.IsAltDown(),
-		InKeyEvent.IsShiftDown(),
-		InKeyEvent.IsCommandDown());
-	const FKey Key = InKeyEvent.GetKey();
-
 	// Handle transform mode inputs
 	if (TransformController->IsTransforming())
 	{
@@ -255,6 +305,13 @@ bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp,
 			return true;
 		}
 
+		// Proportional editing can be toggled during the transform
+		if (UBlend4RealSettings::MatchesChord(UBlend4RealSettings::Get()->ProportionalEditingKey, InKeyEvent))
+		{
+			TransformController->ToggleProportionalEditing();
+			return true;
+		}
+
 		return false;
 	}
 
@@ -267,11 +324,26 @@ bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp,
 		SelectionActionsController->DuplicateSelectedAndGrab();
 		return true;
 	}
+	if (UBlend4RealSettings::MatchesChord(Settings->InstancedDuplicateKey, InKeyEvent))
+	{
+		SelectionActionsController->InstancedDuplicateSelectedAndGrab();
+		return true;
+	}
+	if (UBlend4RealSettings::MatchesChord(Settings->RepeatLastKey, InKeyEvent))
+	{
+		SelectionActionsController->RepeatLastTransform();
+		return true;
+	}
 	if (UBlend4RealSettings::MatchesChord(Settings->DeleteSelectedKey, InKeyEvent))
 	{
 		SelectionActionsController->DeleteSelected();
 		return true;
 	}
+	if (UBlend4RealSettings::MatchesChord(Settings->DropToSurfaceKey, InKeyEvent))
+	{
+		SelectionActionsController->DropSelectedToSurface();
+		return true;
+	}
 
 	// Transform modes
 	if (UBlend4RealSettings::MatchesChord(Settings->TranslationKey, InKeyEvent))
@@ -290,6 +362,12 @@ bool FBlend4RealInputProcessor::HandleKeyDownEvent(FSlateApplication& SlateApp,
 		return true;
 	}
 
+	if (UBlend4RealSettings::MatchesChord(Settings->ProportionalEditingKey, InKeyEvent))
+	{
+		TransformController->ToggleProportionalEditing();
+		return true;
+	}
+
 	// Transform reset
 	if (UBlend4RealSettings::MatchesChord(Settings->ResetTranslationKey, InKeyEvent))
 	{
@@ -377,6 +455,12 @@ bool FBlend4RealInputProcessor::HandleMouseButtonDownEvent(FSlateApplication& Sl
 		return false;
 	}
 
+	// No clicks while Repeat Last spawns, they would select or edit inside its transaction
+	if (SelectionActionsController->IsRepeating())
+	{
+		return true;
+	}
+
 	const FVector2D MousePosition = MouseEvent.GetScreenSpacePosition();
 
 	// Only process input if mouse is over a viewport
@@ -411,7 +495,7 @@ bool FBlend4RealInputProcessor::HandleMouseButtonDownEvent(FSlateApplication& Sl
 		if (UBlend4RealSettings::MatchesChord(Settings->RelocatePivotKey, MouseEvent))
 		{
 			FVector RayOrigin, RayDirection;
-			FHitResult HitResult = Blend4RealUtils::ScenePickAtPosition(MousePosition, RayOrigin, RayDirection);
+			FHitResult HitResult = HoverPickPrefetcher->PickAtPosition(MousePosition, RayOrigin, RayDirection);
 			if (HitResult.bBlockingHit)
 			{
 				Blend4RealUtils::SetCustomPivot(HitResult.ImpactPoint);
@@ -450,6 +534,11 @@ bool FBlend4RealInputProcessor::HandleMouseButtonDoubleClickEvent(FSlateApplicat
 		return false;
 	}
 
+	if (SelectionActionsController->IsRepeating())
+	{
+		return true;
+	}
+
 	const FVector2D MousePosition = MouseEvent.GetScreenSpacePosition();
 
 	// Only process if mouse is over a viewport
@@ -489,3 +578,16 @@ bool FBlend4RealInputProcessor::HandleMouseButtonUpEvent(FSlateApplication& Slat
 
 	return false;
 }
+
+bool FBlend4RealInputProcessor::HandleMouseWheelOrGestureEvent(FSlateApplication& SlateApp,
+                                                                const FPointerEvent& InWheelEvent,
+                                                                const FPointerEvent* InGestureEvent)
+{
+	if (!bIsEnabled || InGestureEvent)
+	{
+		return false;
+	}
+
+	// The wheel resizes the proportional editing radius during a transform, instead of zooming
+	return TransformController->AdjustProportionalRadius(InWheelEvent.GetWheelDelta());
+}
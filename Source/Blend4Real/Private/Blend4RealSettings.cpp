@@ -46,6 +46,25 @@ bool UBlend4RealSettings::MatchesChord(const FInputChord& Chord, const FPointerE
 	return MatchesChord(Chord, MouseEvent.GetEffectingButton(), ModMask);
 }
 
+FVector UBlend4RealSettings::GetDropDirectionVector() const
+{
+	switch (DropDirection)
+	{
+	case EBlend4RealDropDirection::Up:
+		return FVector::UpVector;
+	case EBlend4RealDropDirection::PositiveX:
+		return FVector::ForwardVector;
+	case EBlend4RealDropDirection::NegativeX:
+		return FVector::BackwardVector;
+	case EBlend4RealDropDirection::PositiveY:
+		return FVector::RightVector;
+	case EBlend4RealDropDirection::NegativeY:
+		return FVector::LeftVector;
+	default:
+		return FVector::DownVector;
+	}
+}
+
 TArray<FString> UBlend4RealSettings::GetConflictingBindings(const FInputChord& Chord, const FName& ExcludeProperty) const
 {
 	TArray<FString> Conflicts;
@@ -56,11 +75,15 @@ TArray<FString> UBlend4RealSettings::GetConflictingBindings(const FInputChord& C
 	Bindings.Add("TranslationKey", {&TranslationKey, TEXT("Begin Translation")});
 	Bindings.Add("RotationKey", {&RotationKey, TEXT("Begin Rotation")});
 	Bindings.Add("ScaleKey", {&ScaleKey, TEXT("Begin Scale")});
+	Bindings.Add("ProportionalEditingKey", {&ProportionalEditingKey, TEXT("Toggle Proportional Editing")});
 	Bindings.Add("ResetTranslationKey", {&ResetTranslationKey, TEXT("Reset Translation")});
 	Bindings.Add("ResetRotationKey", {&ResetRotationKey, TEXT("Reset Rotation")});
 	Bindings.Add("ResetScaleKey", {&ResetScaleKey, TEXT("Reset Scale")});
 	Bindings.Add("DuplicateKey", {&DuplicateKey, TEXT("Duplicate")});
+	Bindings.Add("InstancedDuplicateKey", {&InstancedDuplicateKey, TEXT("Instanced Duplicate")});
+	Bindings.Add("RepeatLastKey", {&RepeatLastKey, TEXT("Repeat Last")});
 	Bindings.Add("DeleteSelectedKey", {&DeleteSelectedKey, TEXT("Delete Selected")});
+	Bindings.Add("DropToSurfaceKey", {&DropToSurfaceKey, TEXT("Drop to Surface")});
 	Bindings.Add("OrbitCameraKey", {&OrbitCameraKey, TEXT("Orbit Camera")});
 	Bindings.Add("PanCameraKey", {&PanCameraKey, TEXT("Pan Camera")});
 	Bindings.Add("FocusOnHitKey", {&FocusOnHitKey, TEXT("Focus on Hit")});
@@ -90,11 +113,15 @@ void UBlend4RealSettings::PostEditChangeProperty(FPropertyChangedEvent& Property
 		if (PropName == "TranslationKey") ChangedChord = &TranslationKey;
 		else if (PropName == "RotationKey") ChangedChord = &RotationKey;
 		else if (PropName == "ScaleKey") ChangedChord = &ScaleKey;
+		else if (PropName == "ProportionalEditingKey") ChangedChord = &ProportionalEditingKey;
 		else if (PropName == "ResetTranslationKey") ChangedChord = &ResetTranslationKey;
 		else if (PropName == "ResetRotationKey") ChangedChord = &ResetRotationKey;
 		else if (PropName == "ResetScaleKey") ChangedChord = &ResetScaleKey;
 		else if (PropName == "DuplicateKey") ChangedChord = &DuplicateKey;
+		else if (PropName == "InstancedDuplicateKey") ChangedChord = &InstancedDuplicateKey;
+		else if (PropName == "RepeatLastKey") ChangedChord = &RepeatLastKey;
 		else if (PropName == "DeleteSelectedKey") ChangedChord = &DeleteSelectedKey;
+		else if (PropName == "DropToSurfaceKey") ChangedChord = &DropToSurfaceKey;
 		else if (PropName == "OrbitCameraKey") ChangedChord = &OrbitCameraKey;
 		else if (PropName == "PanCameraKey") ChangedChord = &PanCameraKey;
 		else if (PropName == "FocusOnHitKey") ChangedChord = &FocusOnHitKey;
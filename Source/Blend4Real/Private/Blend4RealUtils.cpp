@@ -1,12 +1,19 @@
 #include "Blend4RealUtils.h"
+#include "Blend4RealSettings.h"
+#include "FScenePicker.h"
 #include "Editor.h"
 #include "EditorModeManager.h"
 #include "EditorViewportClient.h"
 #include "PlatformInputsUtils.h"
+#include "Engine/Level.h"
 #include "Engine/Selection.h"
 #include "Framework/Application/SlateApplication.h"
+#include "Framework/Notifications/NotificationManager.h"
 #include "Slate/SceneViewport.h"
 #include "Widgets/SViewport.h"
+#include "Widgets/Notifications/SNotificationList.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionEditorLoaderAdapter.h"
 
 
 namespace Blend4RealUtils
@@ -29,6 +36,49 @@ namespace Blend4RealUtils
 			|| TypeString == TEXT("SSCSEditorViewport");
 	}
 
+	// Locate the widget path under a screen position and the innermost editor viewport in it
+	// If a filter is specified, only that viewport type matches
+	// Returns the index of the viewport widget in the path, or INDEX_NONE
+	int32 LocateEditorViewport(const FVector2D& ScreenPosition, const FName& ViewportTypeFilter,
+	                           FWidgetPath& OutPathUnderCursor)
+	{
+		if (!FSlateApplication::IsInitialized())
+		{
+			return INDEX_NONE;
+		}
+
+		// Get all visible windows
+		TArray<TSharedRef<SWindow>> VisibleWindows;
+		FSlateApplication::Get().GetAllVisibleWindowsOrdered(VisibleWindows);
+
+		// Use LocateWindowUnderMouse to find the widget path under cursor
+		OutPathUnderCursor = FSlateApplication::Get().LocateWindowUnderMouse(
+			ScreenPosition,
+			VisibleWindows,
+			true
+		);
+
+		for (int32 i = OutPathUnderCursor.Widgets.Num() - 1; i >= 0; --i)
+		{
+			const FName WidgetType = OutPathUnderCursor.Widgets[i].Widget->GetType();
+
+			// If filter specified, check for exact match
+			if (!ViewportTypeFilter.IsNone())
+			{
+				if (WidgetType == ViewportTypeFilter)
+				{
+					return i;
+				}
+			}
+			// Otherwise check for any editor viewport type
+			else if (IsEditorViewportType(WidgetType.ToString()))
+			{
+				return i;
+			}
+		}
+		return INDEX_NONE;
+	}
+
 	const FColor AxisColors[ETransformAxis::TransformAxes_Count] = {
 		FColor::Black, FColor::Red, FColor::Green, FColor::Blue, FColor::Red, FColor::Green, FColor::Blue
 	};
@@ -47,6 +97,109 @@ namespace Blend4RealUtils
 		return GEditor->GetActiveViewport()->GetClient()->GetWorld();
 	}
 
+	bool ShouldDeferActorMoveUpdates(const UWorld* World)
+	{
+		return World && World->IsPartitionedWorld() && UBlend4RealSettings::Get()->bDeferWorldPartitionUpdates;
+	}
+
+	void WarnActorsOutsideLoadedRegions(const TArray<AActor*>& Actors)
+	{
+		const UWorld* World = Actors.Num() > 0 ? Actors[0]->GetWorld() : nullptr;
+		const UWorldPartition* WorldPartition = World ? World->GetWorldPartition() : nullptr;
+		// Without streaming, every actor stays loaded
+		if (!WorldPartition || !WorldPartition->IsStreamingEnabled())
+		{
+			return;
+		}
+
+		// Regions loaded by every editor loader adapter: user regions, location volumes, loaded cells...
+		TArray<FBox> LoadedRegions;
+		for (const UWorldPartitionEditorLoaderAdapter* EditorLoaderAdapter : WorldPartition->GetRegisteredEditorLoaderAdapters())
+		{
+			const IWorldPartitionActorLoaderInterface::ILoaderAdapter* LoaderAdapter =
+				EditorLoaderAdapter ? EditorLoaderAdapter->GetLoaderAdapter() : nullptr;
+			if (!LoaderAdapter || !LoaderAdapter->IsLoaded())
+			{
+				continue;
+			}
+			if (const TOptional<FBox> Bounds = LoaderAdapter->GetBoundingBox())
+			{
+				LoadedRegions.Add(*Bounds);
+			}
+		}
+		if (LoadedRegions.Num() == 0)
+		{
+			return;
+		}
+
+		int32 NumOutside = 0;
+		for (const AActor* Actor : Actors)
+		{
+			if (!Actor || !Actor->GetIsSpatiallyLoaded())
+			{
+				continue;
+			}
+
+			// The editor keeps the actors whose streaming bounds touch a loaded region
+			const FBox Bounds = Actor->GetStreamingBounds();
+			const bool bInsideLoadedRegion = LoadedRegions.ContainsByPredicate([&Bounds](const FBox& Region)
+			{
+				return Region.Intersect(Bounds);
+			});
+			if (!bInsideLoadedRegion)
+			{
+				NumOutside++;
+			}
+		}
+
+		if (NumOutside > 0)
+		{
+			const FString Message = FString::Printf(
+				TEXT("%d actor(s) moved outside of the loaded regions, they will be unloaded with their cells"), NumOutside);
+			UE_LOG(LogTemp, Warning, TEXT("Blend4Real: %s"), *Message);
+
+			FNotificationInfo Info(FText::FromString(Message));
+			Info.ExpireDuration = 5.f;
+			FSlateNotificationManager::Get().AddNotification(Info);
+		}
+	}
+
+	void DuplicateActorsInOrder(const TArray<AActor*>& Sources, ULevel* Level, const FVector& Offset,
+	                            TArray<AActor*>& OutCopies)
+	{
+		OutCopies.Reset();
+		UWorld* World = Level ? Level->GetWorld() : nullptr;
+		if (!GEditor || !World || Sources.Num() == 0)
+		{
+			return;
+		}
+
+		// DuplicateActors() pastes one copy per source in the input order
+		GEditor->DuplicateActors(Sources, OutCopies, Level, Offset);
+		bool bSameOrder = OutCopies.Num() == Sources.Num();
+		for (int32 Index = 0; bSameOrder && Index < OutCopies.Num(); ++Index)
+		{
+			bSameOrder = OutCopies[Index] && OutCopies[Index]->GetClass() == Sources[Index]->GetClass();
+		}
+		if (ensureMsgf(bSameOrder, TEXT("Blend4Real: Duplicated actors don't match their sources, duplicating one by one")))
+		{
+			return;
+		}
+
+		// Each source is duplicated on its own instead, so its copy is known
+		for (AActor* Copy : OutCopies)
+		{
+			World->EditorDestroyActor(Copy, true);
+		}
+		OutCopies.Reset(Sources.Num());
+		for (AActor* Source : Sources)
+		{
+			TArray<AActor*> Copies;
+			GEditor->DuplicateActors({Source}, Copies, Level, Offset);
+			OutCopies.Add(Copies.Num() > 0 ? Copies[0] : nullptr);
+		}
+	}
+
 	FSceneView* GetActiveSceneView(FEditorViewportClient* EClient)
 	{
 		if (!EClient)
@@ -153,54 +306,61 @@ namespace Blend4RealUtils
 
 	FHitResult ScenePickAtPosition(const FVector2D& MousePosition, FVector& OutRayOrigin, FVector& OutRayDirection)
 	{
-		// Get the viewport client and its screen origin
-		FVector2D ViewportScreenOrigin;
-		FEditorViewportClient* EClient = GetViewportClientAndScreenOrigin(MousePosition, ViewportScreenOrigin);
-		if (EClient == nullptr)
+		FScreenRay Ray;
+		if (!ComputeScreenRay(MousePosition, Ray))
 		{
-			UE_LOG(LogTemp, Display, TEXT("Failed hit: no client"));
+			UE_LOG(LogTemp, Display, TEXT("Failed hit: no viewport under the cursor"));
 			return FHitResult();
 		}
 
-		FViewport* Viewport = EClient->Viewport;
-		if (!Viewport)
+		OutRayOrigin = Ray.Origin;
+		OutRayDirection = Ray.Direction;
+
+		FCollisionQueryParams Params;
+		Params.bTraceComplex = true;
+
+		return ProjectToSurface(Ray.ViewportClient->GetWorld(), OutRayOrigin, OutRayDirection, Params, Ray.MaxDistance);
+	}
+
+	bool ComputeScreenRay(const FVector2D& MousePosition, FScreenRay& OutRay)
+	{
+		// Get the viewport client and its screen origin
+		FVector2D ViewportScreenOrigin;
+		FEditorViewportClient* EClient = GetViewportClientAndScreenOrigin(MousePosition, ViewportScreenOrigin);
+		if (EClient == nullptr || !EClient->Viewport)
 		{
-			UE_LOG(LogTemp, Display, TEXT("Failed hit: no viewport"));
-			return FHitResult();
+			return false;
 		}
 
-		FSceneViewFamily ViewFamily = FSceneViewFamily::ConstructionValues(
-			Viewport, EClient->GetScene(), EClient->EngineShowFlags);
+		// The context owns the view and releases it when going out of scope
+		FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+			EClient->Viewport, EClient->GetScene(), EClient->EngineShowFlags));
 
 		const FSceneView* Scene = EClient->CalcSceneView(&ViewFamily);
 		if (!Scene)
 		{
-			UE_LOG(LogTemp, Display, TEXT("Failed hit: no scene"));
-			return FHitResult();
+			return false;
 		}
 		// Convert screen position to viewport-local coordinates using the widget's screen origin
 		const FVector2D LocalMousePos = MousePosition - ViewportScreenOrigin;
 
-		Scene->DeprojectFVector2D(LocalMousePos, OutRayOrigin, OutRayDirection);
-
-		FCollisionQueryParams Params;
-		Params.bTraceComplex = true;
-
-		return ProjectToSurface(EClient->GetWorld(), OutRayOrigin, OutRayDirection, Params);
+		Scene->DeprojectFVector2D(LocalMousePos, OutRay.Origin, OutRay.Direction);
+
+		const FMatrix ViewProjectionMatrix = Scene->ViewMatrices.GetViewProjectionMatrix();
+		OutRay.ViewportClient = EClient;
+		const float FarClipPlane = EClient->GetFarClipPlaneOverride();
+		OutRay.MaxDistance = FarClipPlane > 0.f ? FMath::Min(FarClipPlane, ScenePickDistance) : ScenePickDistance;
+		OutRay.Pixel = FIntPoint(FMath::FloorToInt32(LocalMousePos.X), FMath::FloorToInt32(LocalMousePos.Y));
+		OutRay.ViewHash = HashCombine(FCrc::MemCrc32(&ViewProjectionMatrix, sizeof(FMatrix)),
+		                              HashCombine(GetTypeHash(Scene->UnscaledViewRect.Min),
+		                                          GetTypeHash(Scene->UnscaledViewRect.Max)));
+		return true;
 	}
 
 	FHitResult ProjectToSurface(const UWorld* World, const FVector& Start, const FVector& Direction,
-	                            const FCollisionQueryParams& Params)
+	                            const FCollisionQueryParams& Params, const float MaxDistance)
 	{
-		FHitResult HitResult;
-		if (!World)
-		{
-			return HitResult;
-		}
-
-		const FVector End = Start + Direction * 1000000.f;
-		World->LineTraceSingleByChannel(HitResult, Start, End, ECC_Camera, Params);
-		return HitResult;
+		return FScenePicker::Trace(World, Start, Direction, Params, MaxDistance);
 	}
 
 	bool IsTransformKey(const FKeyEvent& KeyEvent)
@@ -353,51 +513,11 @@ namespace Blend4RealUtils
 	{
 		OutViewportScreenOrigin = FVector2D::ZeroVector;
 
-		if (!FSlateApplication::IsInitialized())
-		{
-			return nullptr;
-		}
-
-		// Get all visible windows
-		TArray<TSharedRef<SWindow>> VisibleWindows;
-		FSlateApplication::Get().GetAllVisibleWindowsOrdered(VisibleWindows);
-
-		// Use LocateWindowUnderMouse to find the widget path under cursor
-		FWidgetPath PathUnderCursor = FSlateApplication::Get().LocateWindowUnderMouse(
-			ScreenPosition,
-			VisibleWindows,
-			true
-		);
-
 		// First pass: check if there's an editor viewport in the widget path
 		// Only SEditorViewport and its subclasses have FEditorViewportClient
 		// Plain SViewport (e.g., content browser thumbnails) do NOT have FEditorViewportClient
-		// If a filter is specified, only match that specific viewport type
-		bool bHasEditorViewportParent = false;
-		for (int32 i = PathUnderCursor.Widgets.Num() - 1; i >= 0; --i)
-		{
-			const TSharedRef<SWidget>& Widget = PathUnderCursor.Widgets[i].Widget;
-			const FName WidgetType = Widget->GetType();
-			const FString TypeString = WidgetType.ToString();
-
-			// If filter specified, check for exact match
-			if (!ViewportTypeFilter.IsNone())
-			{
-				if (WidgetType == ViewportTypeFilter)
-				{
-					bHasEditorViewportParent = true;
-					break;
-				}
-			}
-			// Otherwise check for any editor viewport type
-			else if (IsEditorViewportType(TypeString))
-			{
-				bHasEditorViewportParent = true;
-				break;
-			}
-		}
-
-		if (!bHasEditorViewportParent)
+		FWidgetPath PathUnderCursor;
+		if (LocateEditorViewport(ScreenPosition, ViewportTypeFilter, PathUnderCursor) == INDEX_NONE)
 		{
 			// No matching editor viewport in path
 			return nullptr;
@@ -523,6 +643,13 @@ namespace Blend4RealUtils
 		return false;
 	}
 
+	TSharedPtr<SWidget> GetViewportWidgetAtPosition(const FVector2D& ScreenPosition, const FName& ViewportType)
+	{
+		FWidgetPath PathUnderCursor;
+		const int32 ViewportIndex = LocateEditorViewport(ScreenPosition, ViewportType, PathUnderCursor);
+		return ViewportIndex != INDEX_NONE ? PathUnderCursor.Widgets[ViewportIndex].Widget : TSharedPtr<SWidget>();
+	}
+
 	bool IsMouseOverViewport(const FVector2D& MousePosition, const FName& ViewportTypeFilter)
 	{
 		return GetViewportClientAtPosition(MousePosition, ViewportTypeFilter) != nullptr;
@@ -0,0 +1,534 @@
+#include "FActorBoundsTree.h"
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Misc/CoreDelegates.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/WorldSettings.h"
+
+namespace
+{
+	// Leaves are enlarged so actors can move a little without being reinserted
+	constexpr double FatBoxMargin = 10.0;
+
+	double SurfaceArea(const FBox& Box)
+	{
+		const FVector Size = Box.GetSize();
+		return 2.0 * (Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X);
+	}
+
+	FBox GetTightBox(const FBox& Bounds, const FVector& Pivot)
+	{
+		// Pivots can lie outside the component bounds, keep them reachable by pivot snapping
+		return Bounds.IsValid ? Bounds + Pivot : FBox(Pivot, Pivot);
+	}
+}
+
+TMap<TObjectKey<UWorld>, TUniquePtr<FActorBoundsTree>> FActorBoundsTree::WorldTrees;
+FDelegateHandle FActorBoundsTree::PostEngineInitHandle;
+FDelegateHandle FActorBoundsTree::ActorMovedHandle;
+FDelegateHandle FActorBoundsTree::ActorAddedHandle;
+FDelegateHandle FActorBoundsTree::ActorDeletedHandle;
+FDelegateHandle FActorBoundsTree::PropertyChangedHandle;
+FDelegateHandle FActorBoundsTree::UndoRedoHandle;
+FDelegateHandle FActorBoundsTree::MapChangedHandle;
+FDelegateHandle FActorBoundsTree::LevelAddedHandle;
+FDelegateHandle FActorBoundsTree::LevelRemovedHandle;
+FDelegateHandle FActorBoundsTree::WorldCleanupHandle;
+
+void FActorBoundsTree::BindEngineDelegates()
+{
+	ActorMovedHandle = GEngine->OnActorMoved().AddLambda([](AActor* Actor)
+	{
+		ForEachWorldTree(Actor, [Actor](FActorBoundsTree& Tree) { Tree.UpdateActorHierarchy(Actor); });
+	});
+	ActorAddedHandle = GEngine->OnLevelActorAdded().AddLambda([](AActor* Actor)
+	{
+		ForEachWorldTree(Actor, [Actor](FActorBoundsTree& Tree) { Tree.UpdateActor(Actor); });
+	});
+	ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddLambda([](AActor* Actor)
+	{
+		ForEachWorldTree(Actor, [Actor](FActorBoundsTree& Tree) { Tree.RemoveActor(Actor); });
+	});
+}
+
+void FActorBoundsTree::Initialize()
+{
+	// The plugin is loaded before the engine is created
+	if (GEngine)
+	{
+		BindEngineDelegates();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddStatic(&FActorBoundsTree::BindEngineDelegates);
+	}
+
+	// Meshes, visibility and transforms edited from the details panel
+	PropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda(
+		[](UObject* Object, FPropertyChangedEvent&)
+		{
+			const AActor* Actor = Cast<AActor>(Object);
+			if (!Actor)
+			{
+				const USceneComponent* Component = Cast<USceneComponent>(Object);
+				Actor = Component ? Component->GetOwner() : nullptr;
+			}
+			if (Actor)
+			{
+				ForEachWorldTree(Actor, [Actor](FActorBoundsTree& Tree) { Tree.UpdateActor(Actor); });
+			}
+		});
+
+	// Undo can move, spawn and delete anything without notification: rebuild on next use
+	UndoRedoHandle = FEditorDelegates::PostUndoRedo.AddLambda([]()
+	{
+		for (TPair<TObjectKey<UWorld>, TUniquePtr<FActorBoundsTree>>& Pair : WorldTrees)
+		{
+			Pair.Value->bDirty = true;
+		}
+	});
+	MapChangedHandle = FEditorDelegates::MapChange.AddLambda([](uint32) { WorldTrees.Reset(); });
+
+	// Streamed and sub-levels
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddLambda([](ULevel* Level, UWorld* World)
+	{
+		if (const TUniquePtr<FActorBoundsTree>* Tree = WorldTrees.Find(World); Tree && Level && !(*Tree)->bDirty)
+		{
+			for (const AActor* Actor : Level->Actors)
+			{
+				(*Tree)->UpdateActor(Actor);
+			}
+		}
+	});
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddLambda([](ULevel* Level, UWorld* World)
+	{
+		if (const TUniquePtr<FActorBoundsTree>* Tree = WorldTrees.Find(World))
+		{
+			if (!Level)
+			{
+				(*Tree)->bDirty = true;
+				return;
+			}
+			for (const AActor* Actor : Level->Actors)
+			{
+				(*Tree)->RemoveActor(Actor);
+			}
+		}
+	});
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([](UWorld* World, bool, bool)
+	{
+		WorldTrees.Remove(World);
+	});
+}
+
+void FActorBoundsTree::Shutdown()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	if (GEngine)
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+		GEngine->OnLevelActorAdded().Remove(ActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+	}
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(PropertyChangedHandle);
+	FEditorDelegates::PostUndoRedo.Remove(UndoRedoHandle);
+	FEditorDelegates::MapChange.Remove(MapChangedHandle);
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+	WorldTrees.Reset();
+}
+
+FActorBoundsTree* FActorBoundsTree::Get(const UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<FActorBoundsTree>& Tree = WorldTrees.FindOrAdd(World);
+	if (!Tree)
+	{
+		Tree = MakeUnique<FActorBoundsTree>();
+	}
+	if (Tree->bDirty)
+	{
+		Tree->Build(World);
+	}
+	else if (Tree->DirtyActors.Num() > 0)
+	{
+		for (const TWeakObjectPtr<const AActor>& Actor : Tree->DirtyActors)
+		{
+			if (Actor.IsValid())
+			{
+				Tree->UpdateActorHierarchy(Actor.Get());
+			}
+		}
+	}
+	Tree->DirtyActors.Reset();
+	return Tree.Get();
+}
+
+void FActorBoundsTree::MarkActorDirty(const AActor* Actor)
+{
+	ForEachWorldTree(Actor, [Actor](FActorBoundsTree& Tree) { Tree.DirtyActors.Add(Actor); });
+}
+
+void FActorBoundsTree::UpdateActorHierarchy(const AActor* Actor)
+{
+	// Attached actors follow their parent without their own notification
+	TArray<AActor*> AttachedActors;
+	Actor->GetAttachedActors(AttachedActors, true, true);
+	UpdateActor(Actor);
+	for (const AActor* AttachedActor : AttachedActors)
+	{
+		UpdateActor(AttachedActor);
+	}
+}
+
+void FActorBoundsTree::ForEachWorldTree(const AActor* Actor, TFunctionRef<void(FActorBoundsTree&)> Callback)
+{
+	// Trees that don't exist yet or are waiting for a rebuild will see the actor when built
+	if (const TUniquePtr<FActorBoundsTree>* Tree = Actor ? WorldTrees.Find(Actor->GetWorld()) : nullptr)
+	{
+		if (!(*Tree)->bDirty)
+		{
+			Callback(**Tree);
+		}
+	}
+}
+
+bool FActorBoundsTree::ShouldTrack(const AActor* Actor)
+{
+	return IsValid(Actor) && Actor->GetRootComponent() && !Actor->IsA<AWorldSettings>() && !Actor->IsHiddenEd();
+}
+
+void FActorBoundsTree::ComputeActorBounds(const AActor* Actor, FBox& OutBounds, FVector& OutPivot)
+{
+	// Modular pieces often have no collision: include every primitive
+	OutBounds = Actor->GetComponentsBoundingBox(true, true);
+	OutPivot = Actor->GetActorLocation();
+}
+
+void FActorBoundsTree::Build(const UWorld* World)
+{
+	Nodes.Reset();
+	ActorProxies.Reset();
+	Root = INDEX_NONE;
+	FreeList = INDEX_NONE;
+
+	for (TActorIterator<AActor> It(const_cast<UWorld*>(World)); It; ++It)
+	{
+		AddActor(*It);
+	}
+	bDirty = false;
+}
+
+int32 FActorBoundsTree::FindProxy(const AActor* Actor) const
+{
+	const int32* ProxyId = ActorProxies.Find(Actor);
+	return ProxyId ? *ProxyId : INDEX_NONE;
+}
+
+void FActorBoundsTree::AddActor(const AActor* Actor)
+{
+	if (!ShouldTrack(Actor) || ActorProxies.Contains(Actor))
+	{
+		return;
+	}
+
+	const int32 Leaf = AllocateNode();
+	FNode& Node = Nodes[Leaf];
+	Node.Actor = Actor;
+	ComputeActorBounds(Actor, Node.Bounds, Node.Pivot);
+	Node.Box = GetTightBox(Node.Bounds, Node.Pivot).ExpandBy(FatBoxMargin);
+	Node.Height = 0;
+	InsertLeaf(Leaf);
+	ActorProxies.Add(Actor, Leaf);
+}
+
+void FActorBoundsTree::RemoveActor(const AActor* Actor)
+{
+	int32 Leaf;
+	if (ActorProxies.RemoveAndCopyValue(Actor, Leaf))
+	{
+		RemoveLeaf(Leaf);
+		FreeNode(Leaf);
+	}
+}
+
+void FActorBoundsTree::UpdateActor(const AActor* Actor)
+{
+	const int32 Leaf = FindProxy(Actor);
+	if (Leaf == INDEX_NONE)
+	{
+		AddActor(Actor);
+		return;
+	}
+	if (!ShouldTrack(Actor))
+	{
+		RemoveActor(Actor);
+		return;
+	}
+
+	FNode& Node = Nodes[Leaf];
+	ComputeActorBounds(Actor, Node.Bounds, Node.Pivot);
+	const FBox TightBox = GetTightBox(Node.Bounds, Node.Pivot);
+	if (Node.Box.IsInsideOrOn(TightBox.Min) && Node.Box.IsInsideOrOn(TightBox.Max))
+	{
+		return;
+	}
+
+	RemoveLeaf(Leaf);
+	Nodes[Leaf].Box = TightBox.ExpandBy(FatBoxMargin);
+	InsertLeaf(Leaf);
+}
+
+void FActorBoundsTree::Query(TFunctionRef<bool(const FBox& Box)> NodeFilter,
+                             TFunctionRef<void(int32 ProxyId)> Visit) const
+{
+	if (Root == INDEX_NONE)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(Root);
+	while (Stack.Num() > 0)
+	{
+		const int32 NodeIndex = Stack.Pop(EAllowShrinking::No);
+		const FNode& Node = Nodes[NodeIndex];
+		if (!NodeFilter(Node.Box))
+		{
+			continue;
+		}
+
+		if (Node.IsLeaf())
+		{
+			Visit(NodeIndex);
+		}
+		else
+		{
+			Stack.Add(Node.Child1);
+			Stack.Add(Node.Child2);
+		}
+	}
+}
+
+int32 FActorBoundsTree::AllocateNode()
+{
+	if (FreeList == INDEX_NONE)
+	{
+		return Nodes.AddDefaulted();
+	}
+	const int32 NodeIndex = FreeList;
+	FreeList = Nodes[NodeIndex].Parent;
+	Nodes[NodeIndex] = FNode();
+	return NodeIndex;
+}
+
+void FActorBoundsTree::FreeNode(const int32 NodeIndex)
+{
+	Nodes[NodeIndex] = FNode();
+	Nodes[NodeIndex].Parent = FreeList;
+	FreeList = NodeIndex;
+}
+
+void FActorBoundsTree::InsertLeaf(const int32 Leaf)
+{
+	if (Root == INDEX_NONE)
+	{
+		Root = Leaf;
+		Nodes[Root].Parent = INDEX_NONE;
+		return;
+	}
+
+	// Find the best sibling by descending along the cheapest surface area increase
+	const FBox LeafBox = Nodes[Leaf].Box;
+	int32 Index = Root;
+	while (!Nodes[Index].IsLeaf())
+	{
+		const FNode& Node = Nodes[Index];
+		const double Area = SurfaceArea(Node.Box);
+		const double CombinedArea = SurfaceArea(Node.Box + LeafBox);
+
+		// Cost of creating a new parent for this node and the new leaf
+		const double Cost = 2.0 * CombinedArea;
+		// Minimum cost of pushing the leaf further down the tree
+		const double InheritanceCost = 2.0 * (CombinedArea - Area);
+
+		auto ChildCost = [this, &LeafBox, InheritanceCost](const int32 Child)
+		{
+			const FNode& ChildNode = Nodes[Child];
+			const double NewArea = SurfaceArea(ChildNode.Box + LeafBox);
+			return ChildNode.IsLeaf()
+				       ? NewArea + InheritanceCost
+				       : NewArea - SurfaceArea(ChildNode.Box) + InheritanceCost;
+		};
+		const double Cost1 = ChildCost(Node.Child1);
+		const double Cost2 = ChildCost(Node.Child2);
+
+		if (Cost < Cost1 && Cost < Cost2)
+		{
+			break;
+		}
+		Index = Cost1 < Cost2 ? Node.Child1 : Node.Child2;
+	}
+	const int32 Sibling = Index;
+
+	// Create a new parent for the sibling and the leaf
+	const int32 OldParent = Nodes[Sibling].Parent;
+	const int32 NewParent = AllocateNode();
+	{
+		FNode& Parent = Nodes[NewParent];
+		Parent.Parent = OldParent;
+		Parent.Box = LeafBox + Nodes[Sibling].Box;
+		Parent.Height = Nodes[Sibling].Height + 1;
+		Parent.Child1 = Sibling;
+		Parent.Child2 = Leaf;
+	}
+	if (OldParent != INDEX_NONE)
+	{
+		if (Nodes[OldParent].Child1 == Sibling)
+		{
+			Nodes[OldParent].Child1 = NewParent;
+		}
+		else
+		{
+			Nodes[OldParent].Child2 = NewParent;
+		}
+	}
+	else
+	{
+		Root = NewParent;
+	}
+	Nodes[Sibling].Parent = NewParent;
+	Nodes[Leaf].Parent = NewParent;
+
+	// Walk back up the tree fixing heights and boxes
+	Index = Nodes[Leaf].Parent;
+	while (Index != INDEX_NONE)
+	{
+		Index = Balance(Index);
+		FNode& Node = Nodes[Index];
+		Node.Height = 1 + FMath::Max(Nodes[Node.Child1].Height, Nodes[Node.Child2].Height);
+		Node.Box = Nodes[Node.Child1].Box + Nodes[Node.Child2].Box;
+		Index = Node.Parent;
+	}
+}
+
+void FActorBoundsTree::RemoveLeaf(const int32 Leaf)
+{
+	if (Leaf == Root)
+	{
+		Root = INDEX_NONE;
+		return;
+	}
+
+	const int32 Parent = Nodes[Leaf].Parent;
+	const int32 GrandParent = Nodes[Parent].Parent;
+	const int32 Sibling = Nodes[Parent].Child1 == Leaf ? Nodes[Parent].Child2 : Nodes[Parent].Child1;
+
+	if (GrandParent != INDEX_NONE)
+	{
+		// Connect the sibling to the grand parent and destroy the parent
+		if (Nodes[GrandParent].Child1 == Parent)
+		{
+			Nodes[GrandParent].Child1 = Sibling;
+		}
+		else
+		{
+			Nodes[GrandParent].Child2 = Sibling;
+		}
+		Nodes[Sibling].Parent = GrandParent;
+		FreeNode(Parent);
+
+		int32 Index = GrandParent;
+		while (Index != INDEX_NONE)
+		{
+			Index = Balance(Index);
+			FNode& Node = Nodes[Index];
+			Node.Box = Nodes[Node.Child1].Box + Nodes[Node.Child2].Box;
+			Node.Height = 1 + FMath::Max(Nodes[Node.Child1].Height, Nodes[Node.Child2].Height);
+			Index = Node.Parent;
+		}
+	}
+	else
+	{
+		Root = Sibling;
+		Nodes[Sibling].Parent = INDEX_NONE;
+		FreeNode(Parent);
+	}
+	Nodes[Leaf].Parent = INDEX_NONE;
+}
+
+int32 FActorBoundsTree::Balance(const int32 A)
+{
+	// Rotate the taller grand child up if the subtree of A is unbalanced. Returns the new root of the subtree.
+	if (Nodes[A].IsLeaf() || Nodes[A].Height < 2)
+	{
+		return A;
+	}
+
+	const int32 B = Nodes[A].Child1;
+	const int32 C = Nodes[A].Child2;
+	const int32 Delta = Nodes[C].Height - Nodes[B].Height;
+
+	auto Rotate = [this, A](const int32 Up, const int32 Other)
+	{
+		// Up (a child of A) replaces A, A takes the shorter child of Up
+		const int32 F = Nodes[Up].Child1;
+		const int32 G = Nodes[Up].Child2;
+
+		Nodes[Up].Child1 = A;
+		Nodes[Up].Parent = Nodes[A].Parent;
+		Nodes[A].Parent = Up;
+
+		if (Nodes[Up].Parent != INDEX_NONE)
+		{
+			FNode& UpParent = Nodes[Nodes[Up].Parent];
+			if (UpParent.Child1 == A)
+			{
+				UpParent.Child1 = Up;
+			}
+			else
+			{
+				UpParent.Child2 = Up;
+			}
+		}
+		else
+		{
+			Root = Up;
+		}
+
+		const bool bKeepF = Nodes[F].Height > Nodes[G].Height;
+		const int32 Kept = bKeepF ? F : G;
+		const int32 Given = bKeepF ? G : F;
+		Nodes[Up].Child2 = Kept;
+		if (Nodes[A].Child1 == Up)
+		{
+			Nodes[A].Child1 = Given;
+		}
+		else
+		{
+			Nodes[A].Child2 = Given;
+		}
+		Nodes[Given].Parent = A;
+
+		Nodes[A].Box = Nodes[Other].Box + Nodes[Given].Box;
+		Nodes[A].Height = 1 + FMath::Max(Nodes[Other].Height, Nodes[Given].Height);
+		Nodes[Up].Box = Nodes[A].Box + Nodes[Kept].Box;
+		Nodes[Up].Height = 1 + FMath::Max(Nodes[A].Height, Nodes[Kept].Height);
+		return Up;
+	};
+
+	if (Delta > 1)
+	{
+		return Rotate(C, B);
+	}
+	if (Delta < -1)
+	{
+		return Rotate(B, C);
+	}
+	return A;
+}
@@ -1,21 +1,88 @@
 #include "FActorTransformHandler.h"
 #include "Blend4RealUtils.h"
+#include "FActorBoundsTree.h"
 #include "Editor.h"
 #include "Engine/Selection.h"
 
+FActorTransformHandler::FActorTransformHandler(const TArray<AActor*>& InActors)
+	: bActorsCached(true)
+{
+	CachedActors.Reserve(InActors.Num());
+	for (AActor* Actor : InActors)
+	{
+		CachedActors.Add(Actor);
+	}
+}
+
+TArray<AActor*> FActorTransformHandler::GetActors() const
+{
+	TArray<AActor*> Actors;
+	if (bActorsCached)
+	{
+		Actors.Reserve(CachedActors.Num());
+		for (const TWeakObjectPtr<AActor>& Actor : CachedActors)
+		{
+			if (Actor.IsValid())
+			{
+				Actors.Add(Actor.Get());
+			}
+		}
+		return Actors;
+	}
+
+	if (!GEditor)
+	{
+		return Actors;
+	}
+
+	USelection* SelectedActors = GEditor->GetSelectedActors();
+	Actors.Reserve(SelectedActors->Num());
+	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	{
+		if (AActor* Actor = Cast<AActor>(*It))
+		{
+			Actors.Add(Actor);
+		}
+	}
+	return Actors;
+}
+
 bool FActorTransformHandler::HasSelection() const
 {
-	return GEditor && GEditor->GetSelectedActors()->Num() > 0;
+	return GetSelectionCount() > 0;
 }
 
 int32 FActorTransformHandler::GetSelectionCount() const
 {
+	if (bActorsCached)
+	{
+		return GetActors().Num();
+	}
 	return GEditor ? GEditor->GetSelectedActors()->Num() : 0;
 }
 
 FTransform FActorTransformHandler::ComputeSelectionPivot() const
 {
-	return Blend4RealUtils::ComputeSelectionPivot();
+	if (!bActorsCached || Blend4RealUtils::HasCustomPivot())
+	{
+		return Blend4RealUtils::ComputeSelectionPivot();
+	}
+
+	// Same as the selection pivot, over the cached actors
+	FTransform Pivot;
+	const TArray<AActor*> Actors = GetActors();
+	if (Actors.Num() == 0)
+	{
+		return Pivot;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const AActor* Actor : Actors)
+	{
+		Center += Actor->GetActorTransform().TransformPosition(Actor->GetPivotOffset());
+	}
+	Pivot.SetLocation(Center / Actors.Num());
+	return Pivot;
 }
 
 FTransform FActorTransformHandler::GetFirstSelectedItemTransform() const
@@ -25,7 +92,18 @@ FTransform FActorTransformHandler::GetFirstSelectedItemTransform() const
 		return FTransform::Identity;
 	}
 
-	if (const AActor* Actor = GEditor->GetSelectedActors()->GetTop<AActor>())
+	const AActor* Actor = nullptr;
+	if (bActorsCached)
+	{
+		const TArray<AActor*> Actors = GetActors();
+		Actor = Actors.Num() > 0 ? Actors[0] : nullptr;
+	}
+	else
+	{
+		Actor = GEditor->GetSelectedActors()->GetTop<AActor>();
+	}
+
+	if (Actor)
 	{
 		return InitialTransforms[Actor->GetUniqueID()];
 	}
@@ -35,13 +113,8 @@ FTransform FActorTransformHandler::GetFirstSelectedItemTransform() const
 
 FVector FActorTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 {
-	if (!GEditor)
-	{
-		return FVector::ZeroVector;
-	}
-
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	if (SelectedActors->Num() == 0)
+	const TArray<AActor*> Actors = GetActors();
+	if (Actors.Num() == 0)
 	{
 		return FVector::ZeroVector;
 	}
@@ -50,34 +123,31 @@ FVector FActorTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 	FVector AccumulatedAxis = FVector::ZeroVector;
 	int32 Count = 0;
 
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	for (const AActor* Actor : Actors)
 	{
-		if (const AActor* Actor = Cast<AActor>(*It))
+		if (const FTransform* Transform = InitialTransforms.Find(Actor->GetUniqueID()))
 		{
-			if (const FTransform* Transform = InitialTransforms.Find(Actor->GetUniqueID()))
+			const FQuat Rotation = Transform->GetRotation();
+			FVector AxisVector;
+
+			switch (Axis)
 			{
-				const FQuat Rotation = Transform->GetRotation();
-				FVector AxisVector;
-
-				switch (Axis)
-				{
-				case EAxis::X:
-					AxisVector = Rotation.GetForwardVector();
-					break;
-				case EAxis::Y:
-					AxisVector = Rotation.GetRightVector();
-					break;
-				case EAxis::Z:
-					AxisVector = Rotation.GetUpVector();
-					break;
-				default:
-					AxisVector = FVector::ZeroVector;
-					break;
-				}
-
-				AccumulatedAxis += AxisVector;
-				Count++;
+			case EAxis::X:
+				AxisVector = Rotation.GetForwardVector();
+				break;
+			case EAxis::Y:
+				AxisVector = Rotation.GetRightVector();
+				break;
+			case EAxis::Z:
+				AxisVector = Rotation.GetUpVector();
+				break;
+			default:
+				AxisVector = FVector::ZeroVector;
+				break;
 			}
+
+			AccumulatedAxis += AxisVector;
+			Count++;
 		}
 	}
 
@@ -93,71 +163,78 @@ void FActorTransformHandler::CaptureInitialState()
 {
 	InitialTransforms.Empty();
 
-	if (!GEditor)
+	const TArray<AActor*> Actors = GetActors();
+	if (!bActorsCached)
 	{
-		return;
+		CachedActors.Reserve(Actors.Num());
+		for (AActor* Actor : Actors)
+		{
+			CachedActors.Add(Actor);
+		}
+		bActorsCached = true;
 	}
 
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	for (const AActor* Actor : Actors)
 	{
-		if (AActor* Actor = Cast<AActor>(*It))
-		{
-			InitialTransforms.Add(Actor->GetUniqueID(), Actor->GetActorTransform());
-		}
+		InitialTransforms.Add(Actor->GetUniqueID(), Actor->GetActorTransform());
 	}
+	bDeferMoveUpdates = Actors.Num() > 0 && Blend4RealUtils::ShouldDeferActorMoveUpdates(Actors[0]->GetWorld());
 }
 
-void FActorTransformHandler::RestoreInitialState()
+bool FActorTransformHandler::RecaptureInitialState()
 {
-	if (!GEditor)
+	if (!bActorsCached)
 	{
-		return;
+		return false;
 	}
 
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	// The actors were moved by the previous transform, or undone since
+	for (const TWeakObjectPtr<AActor>& Actor : CachedActors)
 	{
-		if (AActor* Actor = Cast<AActor>(*It))
+		if (!Actor.IsValid())
 		{
-			if (const FTransform* Original = InitialTransforms.Find(Actor->GetUniqueID()))
-			{
-				Actor->SetActorTransform(*Original, false, nullptr, ETeleportType::None);
-				// Notify actor that movement is complete (restored to original position)
-				Actor->PostEditMove(true);
-			}
+			return false;
 		}
+		InitialTransforms.Add(Actor->GetUniqueID(), Actor->GetActorTransform());
 	}
+	return true;
 }
 
-void FActorTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
-                                                       const FTransform& NewPivotTransform)
+void FActorTransformHandler::RestoreInitialState()
 {
-	if (!GEditor)
+	for (AActor* Actor : GetActors())
 	{
-		return;
+		if (const FTransform* Original = InitialTransforms.Find(Actor->GetUniqueID()))
+		{
+			Actor->SetActorTransform(*Original, false, nullptr, ETeleportType::None);
+			// Notify actor that movement is complete (restored to original position)
+			Actor->PostEditMove(true);
+		}
 	}
+}
 
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+void FActorTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                       const FTransform& NewPivotTransform)
+{
+	for (AActor* Actor : GetActors())
 	{
-		if (AActor* Actor = Cast<AActor>(*It))
+		const FTransform* InitialActorTransform = InitialTransforms.Find(Actor->GetUniqueID());
+		if (!InitialActorTransform)
 		{
-			const FTransform* InitialActorTransform = InitialTransforms.Find(Actor->GetUniqueID());
-			if (!InitialActorTransform)
-			{
-				continue;
-			}
+			continue;
+		}
 
-			// Transform actor relative to pivot:
-			// 1. Remove initial pivot transform
-			// 2. Apply new pivot transform
-			FTransform ActorTransform = *InitialActorTransform * InitialPivot.Inverse();
-			ActorTransform = ActorTransform * NewPivotTransform;
+		// Transform actor relative to pivot:
+		// 1. Remove initial pivot transform
+		// 2. Apply new pivot transform
+		FTransform ActorTransform = *InitialActorTransform * InitialPivot.Inverse();
+		ActorTransform = ActorTransform * NewPivotTransform;
 
-			if (!ActorTransform.ContainsNaN())
+		if (!ActorTransform.ContainsNaN())
+		{
+			Actor->SetActorTransform(ActorTransform, false, nullptr, ETeleportType::None);
+			if (!bDeferMoveUpdates)
 			{
-				Actor->SetActorTransform(ActorTransform, false, nullptr, ETeleportType::None);
 				// Notify actor of movement (bFinished=false indicates movement is still in progress)
 				Actor->PostEditMove(false);
 			}
@@ -167,34 +244,53 @@ void FActorTransformHandler::ApplyTransformAroundPivot(const FTransform& Initial
 
 void FActorTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale)
 {
-	if (!GEditor)
+	for (AActor* Actor : GetActors())
+	{
+		FTransform ActorTransform = Actor->GetActorTransform();
+
+		if (Location)
+		{
+			ActorTransform.SetLocation(*Location);
+		}
+		if (Rotation)
+		{
+			ActorTransform.SetRotation(Rotation->Quaternion());
+		}
+		if (Scale)
+		{
+			ActorTransform.SetScale3D(*Scale);
+		}
+
+		if (!ActorTransform.ContainsNaN())
+		{
+			Actor->SetActorTransform(ActorTransform, false, nullptr, ETeleportType::None);
+			// Notify actor of movement (bFinished=false indicates movement is still in progress)
+			Actor->PostEditMove(false);
+		}
+	}
+}
+
+bool FActorTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms = InitialTransforms;
+	return true;
+}
+
+void FActorTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	if (Transforms.Num() == 0)
 	{
 		return;
 	}
 
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	for (AActor* Actor : GetActors())
 	{
-		if (AActor* Actor = Cast<AActor>(*It))
+		const FTransform* ActorTransform = Transforms.Find(Actor->GetUniqueID());
+		if (ActorTransform && !ActorTransform->ContainsNaN())
 		{
-			FTransform ActorTransform = Actor->GetActorTransform();
-
-			if (Location)
-			{
-				ActorTransform.SetLocation(*Location);
-			}
-			if (Rotation)
-			{
-				ActorTransform.SetRotation(Rotation->Quaternion());
-			}
-			if (Scale)
-			{
-				ActorTransform.SetScale3D(*Scale);
-			}
-
-			if (!ActorTransform.ContainsNaN())
+			Actor->SetActorTransform(*ActorTransform, false, nullptr, ETeleportType::None);
+			if (!bDeferMoveUpdates)
 			{
-				Actor->SetActorTransform(ActorTransform, false, nullptr, ETeleportType::None);
 				// Notify actor of movement (bFinished=false indicates movement is still in progress)
 				Actor->PostEditMove(false);
 			}
@@ -212,13 +308,9 @@ int32 FActorTransformHandler::BeginTransaction(const FText& Description)
 	const int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
 
 	// Mark all selected actors as modified
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	for (AActor* Actor : GetActors())
 	{
-		if (AActor* Actor = Cast<AActor>(*It))
-		{
-			Actor->Modify();
-		}
+		Actor->Modify();
 	}
 
 	return TransactionIndex;
@@ -230,13 +322,11 @@ void FActorTransformHandler::EndTransaction()
 	{
 		// Notify all selected actors that movement has finished
 		// This triggers construction script reruns, OnActorMoved broadcasts, etc.
-		USelection* SelectedActors = GEditor->GetSelectedActors();
-		for (FSelectionIterator It(*SelectedActors); It; ++It)
+		// With deferred updates, this is also where World Partition reassigns the actors, in one batch
+		for (AActor* Actor : GetActors())
 		{
-			if (AActor* Actor = Cast<AActor>(*It))
-			{
-				Actor->PostEditMove(true);
-			}
+			Actor->PostEditMove(true);
+			FActorBoundsTree::MarkActorDirty(Actor);
 		}
 
 		GEditor->EndTransaction();
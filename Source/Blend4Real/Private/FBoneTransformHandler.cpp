@@ -0,0 +1,306 @@
+#include "FBoneTransformHandler.h"
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#include "IPersonaPreviewScene.h"
+#include "AnimPreviewInstance.h"
+#include "Animation/DebugSkelMeshComponent.h"
+#include "BoneControllers/AnimNode_ModifyBone.h"
+
+FBoneTransformHandler::FBoneTransformHandler(UDebugSkelMeshComponent* InPreviewComponent)
+	: PreviewComponent(InPreviewComponent)
+{
+	if (!InPreviewComponent || !InPreviewComponent->PreviewInstance)
+	{
+		return;
+	}
+
+	const TSet<int32> SelectedIndices(InPreviewComponent->BonesOfInterest);
+	for (const int32 BoneIndex : InPreviewComponent->BonesOfInterest)
+	{
+		const FName BoneName = InPreviewComponent->GetBoneName(BoneIndex);
+		if (BoneName == NAME_None)
+		{
+			continue;
+		}
+
+		// Bones whose ancestor is selected already follow it
+		bool bHasSelectedAncestor = false;
+		for (FName Parent = InPreviewComponent->GetParentBone(BoneName); Parent != NAME_None;
+		     Parent = InPreviewComponent->GetParentBone(Parent))
+		{
+			if (SelectedIndices.Contains(InPreviewComponent->GetBoneIndex(Parent)))
+			{
+				bHasSelectedAncestor = true;
+				break;
+			}
+		}
+
+		if (!bHasSelectedAncestor)
+		{
+			FSelectedBone& Bone = Bones.AddDefaulted_GetRef();
+			Bone.Name = BoneName;
+			Bone.Index = BoneIndex;
+		}
+	}
+}
+
+UDebugSkelMeshComponent* FBoneTransformHandler::FindPreviewComponent(FEditorViewportClient* ViewportClient)
+{
+	// The preview scene of every Persona viewport (SAnimationEditorViewport) is an IPersonaPreviewScene
+	FPreviewScene* PreviewScene = ViewportClient ? ViewportClient->GetPreviewScene() : nullptr;
+	if (!PreviewScene)
+	{
+		return nullptr;
+	}
+
+	UDebugSkelMeshComponent* Component = static_cast<IPersonaPreviewScene*>(PreviewScene)->GetPreviewMeshComponent();
+	return Component && Component->IsRegistered() && Component->PreviewInstance ? Component : nullptr;
+}
+
+bool FBoneTransformHandler::HasSelection() const
+{
+	return PreviewComponent.IsValid() && Bones.Num() > 0;
+}
+
+int32 FBoneTransformHandler::GetSelectionCount() const
+{
+	return Bones.Num();
+}
+
+FTransform FBoneTransformHandler::ComputeSelectionPivot() const
+{
+	FTransform Pivot;
+	if (Bones.Num() == 1)
+	{
+		// A single bone rotates around its joint, in its own orientation
+		Pivot.SetLocation(Bones[0].Initial.GetLocation());
+		Pivot.SetRotation(Bones[0].Initial.GetRotation());
+		return Pivot;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const FSelectedBone& Bone : Bones)
+	{
+		Center += Bone.Initial.GetLocation();
+	}
+	if (Bones.Num() > 0)
+	{
+		Pivot.SetLocation(Center / Bones.Num());
+	}
+	return Pivot;
+}
+
+FTransform FBoneTransformHandler::GetFirstSelectedItemTransform() const
+{
+	return Bones.Num() > 0 ? Bones[0].Initial : FTransform::Identity;
+}
+
+FVector FBoneTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
+{
+	if (Bones.Num() == 0)
+	{
+		return FVector::ZeroVector;
+	}
+
+	FVector AccumulatedAxis = FVector::ZeroVector;
+	for (const FSelectedBone& Bone : Bones)
+	{
+		const FQuat Rotation = Bone.Initial.GetRotation();
+		AccumulatedAxis += Axis == EAxis::X
+			                   ? Rotation.GetForwardVector()
+			                   : Axis == EAxis::Y
+			                   ? Rotation.GetRightVector()
+			                   : Rotation.GetUpVector();
+	}
+	return (AccumulatedAxis / Bones.Num()).GetSafeNormal();
+}
+
+void FBoneTransformHandler::CaptureInitialState()
+{
+	bDirty = false;
+	bCaptured = true;
+	UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!Component || !Component->PreviewInstance)
+	{
+		return;
+	}
+
+	// Cached once, the drag only reads the selected bones from it
+	const TArray<FTransform>& Pose = Component->GetComponentSpaceTransforms();
+	const FTransform ComponentToWorld = Component->GetComponentTransform();
+	for (FSelectedBone& Bone : Bones)
+	{
+		const FTransform ComponentSpace = Pose.IsValidIndex(Bone.Index) ? Pose[Bone.Index] : FTransform::Identity;
+		Bone.Initial = Bone.Current = ComponentSpace * ComponentToWorld;
+
+		// Parent bone space, as FAnimationRuntime::ConvertCSTransformToBoneSpace() with BCS_ParentBoneSpace
+		const int32 ParentIndex = Component->GetBoneIndex(Component->GetParentBone(Bone.Name));
+		Bone.ParentComponentSpace = Pose.IsValidIndex(ParentIndex) ? Pose[ParentIndex] : FTransform::Identity;
+		const FTransform Local = ComponentSpace.GetRelativeTransform(Bone.ParentComponentSpace);
+
+		// The pose already contains the modifier of the bone, it's removed to get the local pose it applies to
+		// (the reference pose, unless an animation is previewed)
+		const FAnimNode_ModifyBone* Modifier = Component->PreviewInstance->FindModifiedBone(Bone.Name);
+		Bone.bHadModifier = Modifier != nullptr;
+		Bone.InitialModifier = Modifier
+			                       ? FTransform(Modifier->Rotation, Modifier->Translation, Modifier->Scale)
+			                       : FTransform::Identity;
+		Bone.BaseLocal = FTransform(
+			Bone.InitialModifier.GetRotation().Inverse() * Local.GetRotation(),
+			Local.GetTranslation() - Bone.InitialModifier.GetTranslation(),
+			Local.GetScale3D() * FTransform::GetSafeScaleReciprocal(Bone.InitialModifier.GetScale3D()));
+	}
+}
+
+FTransform FBoneTransformHandler::ComputeModifier(const FTransform& ParentComponentSpace, const FTransform& BaseLocal,
+                                                  const FTransform& Target)
+{
+	const FTransform Local = Target.GetRelativeTransform(ParentComponentSpace);
+	return FTransform(
+		Local.GetRotation() * BaseLocal.GetRotation().Inverse(),
+		Local.GetTranslation() - BaseLocal.GetTranslation(),
+		Local.GetScale3D() * FTransform::GetSafeScaleReciprocal(BaseLocal.GetScale3D()));
+}
+
+void FBoneTransformHandler::RestoreInitialState()
+{
+	bDirty = false;
+	UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!Component || !Component->PreviewInstance)
+	{
+		return;
+	}
+
+	for (FSelectedBone& Bone : Bones)
+	{
+		Bone.Current = Bone.Initial;
+		if (Bone.bHadModifier)
+		{
+			WriteModifier(Bone, Bone.InitialModifier);
+		}
+		else
+		{
+			Component->PreviewInstance->RemoveBoneModification(Bone.Name);
+		}
+	}
+}
+
+void FBoneTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                      const FTransform& NewPivotTransform)
+{
+	const FTransform InitialPivotInverse = InitialPivot.Inverse();
+	for (FSelectedBone& Bone : Bones)
+	{
+		const FTransform BoneTransform = Bone.Initial * InitialPivotInverse * NewPivotTransform;
+		if (!BoneTransform.ContainsNaN())
+		{
+			Bone.Current = BoneTransform;
+		}
+	}
+	bDirty = true;
+}
+
+void FBoneTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
+                                               const FVector* Scale)
+{
+	// Resetting a bone brings it back to its pose without modifier
+	const UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!Component)
+	{
+		return;
+	}
+
+	// Reset Transform doesn't begin a transform session
+	if (!bCaptured)
+	{
+		CaptureInitialState();
+	}
+
+	const FTransform ComponentToWorld = Component->GetComponentTransform();
+	for (FSelectedBone& Bone : Bones)
+	{
+		const FTransform BaseWorld = Bone.BaseLocal * Bone.ParentComponentSpace * ComponentToWorld;
+		if (Location)
+		{
+			Bone.Current.SetLocation(BaseWorld.GetLocation());
+		}
+		if (Rotation)
+		{
+			Bone.Current.SetRotation(BaseWorld.GetRotation());
+		}
+		if (Scale)
+		{
+			Bone.Current.SetScale3D(BaseWorld.GetScale3D());
+		}
+	}
+	bDirty = true;
+}
+
+void FBoneTransformHandler::FlushDeferredUpdates()
+{
+	const UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!bDirty || !Component)
+	{
+		return;
+	}
+
+	bDirty = false;
+	const FTransform ComponentToWorld = Component->GetComponentTransform();
+	for (const FSelectedBone& Bone : Bones)
+	{
+		const FTransform ComponentSpace = Bone.Current.GetRelativeTransform(ComponentToWorld);
+		WriteModifier(Bone, ComputeModifier(Bone.ParentComponentSpace, Bone.BaseLocal, ComponentSpace));
+	}
+}
+
+int32 FBoneTransformHandler::BeginTransaction(const FText& Description)
+{
+	UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!GEditor || !Component || !Component->PreviewInstance)
+	{
+		return -1;
+	}
+
+	const int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
+	// Same as Persona: the bone modifiers are recorded with the preview instance
+	Component->PreviewInstance->SetFlags(RF_Transactional);
+	Component->PreviewInstance->Modify();
+	return TransactionIndex;
+}
+
+void FBoneTransformHandler::EndTransaction()
+{
+	FlushDeferredUpdates();
+	if (GEditor)
+	{
+		GEditor->EndTransaction();
+	}
+}
+
+void FBoneTransformHandler::CancelTransaction(int32 TransactionIndex)
+{
+	if (GEditor && TransactionIndex >= 0)
+	{
+		GEditor->CancelTransaction(TransactionIndex);
+	}
+}
+
+UWorld* FBoneTransformHandler::GetVisualizationWorld() const
+{
+	const UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	return Component ? Component->GetWorld() : nullptr;
+}
+
+void FBoneTransformHandler::WriteModifier(const FSelectedBone& Bone, const FTransform& Modifier) const
+{
+	UDebugSkelMeshComponent* Component = PreviewComponent.Get();
+	if (!Component || !Component->PreviewInstance || Modifier.ContainsNaN())
+	{
+		return;
+	}
+
+	FAnimNode_ModifyBone& Node = Component->PreviewInstance->ModifyBone(Bone.Name);
+	Node.Translation = Modifier.GetLocation();
+	Node.Rotation = Modifier.Rotator();
+	Node.Scale = Modifier.GetScale3D();
+}
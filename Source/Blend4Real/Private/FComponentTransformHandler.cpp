@@ -1,4 +1,5 @@
 #include "FComponentTransformHandler.h"
+#include "FActorBoundsTree.h"
 #include "Editor.h"
 #include "Engine/Selection.h"
 #include "Components/SceneComponent.h"
@@ -8,32 +9,92 @@ USelection* FComponentTransformHandler::GetSelectedComponents() const
 	return GEditor ? GEditor->GetSelectedComponents() : nullptr;
 }
 
-bool FComponentTransformHandler::HasSelection() const
+TArray<USceneComponent*> FComponentTransformHandler::GetComponents() const
 {
+	TArray<USceneComponent*> Components;
+	if (bComponentsCached)
+	{
+		Components.Reserve(CachedComponents.Num());
+		for (const TWeakObjectPtr<USceneComponent>& Component : CachedComponents)
+		{
+			if (Component.IsValid())
+			{
+				Components.Add(Component.Get());
+			}
+		}
+		return Components;
+	}
+
 	USelection* Selection = GetSelectedComponents();
-	return Selection && Selection->Num() > 0;
+	if (!Selection)
+	{
+		return Components;
+	}
+
+	Components.Reserve(Selection->Num());
+	for (FSelectionIterator It(*Selection); It; ++It)
+	{
+		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		{
+			Components.Add(Component);
+		}
+	}
+	return Components;
+}
+
+bool FComponentTransformHandler::HasSelection() const
+{
+	return GetSelectionCount() > 0;
 }
 
 int32 FComponentTransformHandler::GetSelectionCount() const
 {
+	if (bComponentsCached)
+	{
+		return GetComponents().Num();
+	}
 	USelection* Selection = GetSelectedComponents();
 	return Selection ? Selection->Num() : 0;
 }
 
 FTransform FComponentTransformHandler::ComputeSelectionPivot() const
 {
-	return Blend4RealUtils::ComputeSelectionPivot();
+	if (Blend4RealUtils::HasCustomPivot())
+	{
+		return Blend4RealUtils::ComputeSelectionPivot();
+	}
+
+	// Center of the handled components only, the selected actors (e.g. in a composite) have their own handler
+	FTransform Pivot;
+	const TArray<USceneComponent*> Components = GetComponents();
+	if (Components.Num() == 0)
+	{
+		return Pivot;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const USceneComponent* Component : Components)
+	{
+		Center += Component->GetComponentLocation();
+	}
+	Pivot.SetLocation(Center / Components.Num());
+	return Pivot;
 }
 
 FTransform FComponentTransformHandler::GetFirstSelectedItemTransform() const
 {
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection)
+	const USceneComponent* Component = nullptr;
+	if (bComponentsCached)
+	{
+		const TArray<USceneComponent*> Components = GetComponents();
+		Component = Components.Num() > 0 ? Components[0] : nullptr;
+	}
+	else if (USelection* Selection = GetSelectedComponents())
 	{
-		return FTransform::Identity;
+		Component = Selection->GetTop<USceneComponent>();
 	}
 
-	if (USceneComponent* Component = Selection->GetTop<USceneComponent>())
+	if (Component)
 	{
 		return InitialTransforms[Component->GetUniqueID()];
 	}
@@ -43,8 +104,8 @@ FTransform FComponentTransformHandler::GetFirstSelectedItemTransform() const
 
 FVector FComponentTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 {
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection || Selection->Num() == 0)
+	const TArray<USceneComponent*> Components = GetComponents();
+	if (Components.Num() == 0)
 	{
 		return FVector::ZeroVector;
 	}
@@ -53,34 +114,31 @@ FVector FComponentTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) co
 	FVector AccumulatedAxis = FVector::ZeroVector;
 	int32 Count = 0;
 
-	for (FSelectionIterator It(*Selection); It; ++It)
+	for (const USceneComponent* Component : Components)
 	{
-		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		if (const FTransform* Transform = InitialTransforms.Find(Component->GetUniqueID()))
 		{
-			if (const FTransform* Transform = InitialTransforms.Find(Component->GetUniqueID()))
+			const FQuat Rotation = Transform->GetRotation();
+			FVector AxisVector;
+
+			switch (Axis)
 			{
-				const FQuat Rotation = Transform->GetRotation();
-				FVector AxisVector;
-
-				switch (Axis)
-				{
-				case EAxis::X:
-					AxisVector = Rotation.GetForwardVector();
-					break;
-				case EAxis::Y:
-					AxisVector = Rotation.GetRightVector();
-					break;
-				case EAxis::Z:
-					AxisVector = Rotation.GetUpVector();
-					break;
-				default:
-					AxisVector = FVector::ZeroVector;
-					break;
-				}
-
-				AccumulatedAxis += AxisVector;
-				Count++;
+			case EAxis::X:
+				AxisVector = Rotation.GetForwardVector();
+				break;
+			case EAxis::Y:
+				AxisVector = Rotation.GetRightVector();
+				break;
+			case EAxis::Z:
+				AxisVector = Rotation.GetUpVector();
+				break;
+			default:
+				AxisVector = FVector::ZeroVector;
+				break;
 			}
+
+			AccumulatedAxis += AxisVector;
+			Count++;
 		}
 	}
 
@@ -96,53 +154,59 @@ void FComponentTransformHandler::CaptureInitialState()
 {
 	InitialTransforms.Empty();
 
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection)
+	const TArray<USceneComponent*> Components = GetComponents();
+	if (!bComponentsCached)
 	{
-		return;
+		CachedComponents.Reserve(Components.Num());
+		for (USceneComponent* Component : Components)
+		{
+			CachedComponents.Add(Component);
+		}
+		bComponentsCached = true;
 	}
 
-	for (FSelectionIterator It(*Selection); It; ++It)
+	for (const USceneComponent* Component : Components)
 	{
-		if (USceneComponent* Component = Cast<USceneComponent>(*It))
-		{
-			// Store world transform for computing deltas later
-			InitialTransforms.Add(Component->GetUniqueID(), Component->GetComponentTransform());
-		}
+		// Store world transform for computing deltas later
+		InitialTransforms.Add(Component->GetUniqueID(), Component->GetComponentTransform());
 	}
 }
 
-void FComponentTransformHandler::RestoreInitialState()
+bool FComponentTransformHandler::RecaptureInitialState()
 {
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection)
+	if (!bComponentsCached)
 	{
-		return;
+		return false;
 	}
 
-	for (FSelectionIterator It(*Selection); It; ++It)
+	// The components were moved by the previous transform, or undone since
+	for (const TWeakObjectPtr<USceneComponent>& Component : CachedComponents)
 	{
-		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		if (!Component.IsValid())
 		{
-			if (const FTransform* Original = InitialTransforms.Find(Component->GetUniqueID()))
-			{
-				Component->SetWorldTransform(*Original);
-				// Notify component that movement is complete (restored to original position)
-				Component->PostEditComponentMove(true);
-			}
+			return false;
 		}
+		InitialTransforms.Add(Component->GetUniqueID(), Component->GetComponentTransform());
 	}
+	return true;
 }
 
-void FComponentTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
-                                                           const FTransform& NewPivotTransform)
+void FComponentTransformHandler::RestoreInitialState()
 {
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection)
+	for (USceneComponent* Component : GetComponents())
 	{
-		return;
+		if (const FTransform* Original = InitialTransforms.Find(Component->GetUniqueID()))
+		{
+			Component->SetWorldTransform(*Original);
+			// Notify component that movement is complete (restored to original position)
+			Component->PostEditComponentMove(true);
+		}
 	}
+}
 
+void FComponentTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                           const FTransform& NewPivotTransform)
+{
 	// Calculate the delta between initial and new pivot transforms
 	const FVector DeltaTranslation = NewPivotTransform.GetLocation() - InitialPivot.GetLocation();
 	const FQuat DeltaRotation = NewPivotTransform.GetRotation() * InitialPivot.GetRotation().Inverse();
@@ -150,43 +214,40 @@ void FComponentTransformHandler::ApplyTransformAroundPivot(const FTransform& Ini
 
 	const FVector PivotLocation = InitialPivot.GetLocation();
 
-	for (FSelectionIterator It(*Selection); It; ++It)
+	for (USceneComponent* Component : GetComponents())
 	{
-		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		const FTransform* InitialComponentTransform = InitialTransforms.Find(Component->GetUniqueID());
+		if (!InitialComponentTransform)
 		{
-			const FTransform* InitialComponentTransform = InitialTransforms.Find(Component->GetUniqueID());
-			if (!InitialComponentTransform)
-			{
-				continue;
-			}
+			continue;
+		}
 
-			// Calculate the component's position relative to pivot
-			const FVector InitialRelativeToPivot = InitialComponentTransform->GetLocation() - PivotLocation;
+		// Calculate the component's position relative to pivot
+		const FVector InitialRelativeToPivot = InitialComponentTransform->GetLocation() - PivotLocation;
 
-			// Apply rotation around pivot to get new position offset
-			const FVector RotatedOffset = DeltaRotation.RotateVector(InitialRelativeToPivot);
+		// Apply rotation around pivot to get new position offset
+		const FVector RotatedOffset = DeltaRotation.RotateVector(InitialRelativeToPivot);
 
-			// Apply scale around pivot
-			const FVector ScaledOffset = RotatedOffset * DeltaScale;
+		// Apply scale around pivot
+		const FVector ScaledOffset = RotatedOffset * DeltaScale;
 
-			// Calculate new world position
-			const FVector NewLocation = PivotLocation + DeltaTranslation + ScaledOffset;
+		// Calculate new world position
+		const FVector NewLocation = PivotLocation + DeltaTranslation + ScaledOffset;
 
-			// Apply rotation to the component's own rotation
-			const FQuat NewRotation = DeltaRotation * InitialComponentTransform->GetRotation();
+		// Apply rotation to the component's own rotation
+		const FQuat NewRotation = DeltaRotation * InitialComponentTransform->GetRotation();
 
-			// Apply scale to the component's own scale
-			const FVector NewScale = InitialComponentTransform->GetScale3D() * DeltaScale;
+		// Apply scale to the component's own scale
+		const FVector NewScale = InitialComponentTransform->GetScale3D() * DeltaScale;
 
-			// Build new transform
-			FTransform NewTransform(NewRotation, NewLocation, NewScale);
+		// Build new transform
+		FTransform NewTransform(NewRotation, NewLocation, NewScale);
 
-			if (NewTransform.IsValid())
-			{
-				Component->SetWorldTransform(NewTransform);
-				// Notify component of movement (bFinished=false indicates movement is still in progress)
-				Component->PostEditComponentMove(false);
-			}
+		if (NewTransform.IsValid())
+		{
+			Component->SetWorldTransform(NewTransform);
+			// Notify component of movement (bFinished=false indicates movement is still in progress)
+			Component->PostEditComponentMove(false);
 		}
 	}
 }
@@ -194,34 +255,50 @@ void FComponentTransformHandler::ApplyTransformAroundPivot(const FTransform& Ini
 void FComponentTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
                                                     const FVector* Scale)
 {
-	USelection* Selection = GetSelectedComponents();
-	if (!Selection)
+	for (USceneComponent* Component : GetComponents())
+	{
+		FTransform CurrentTransform = Component->GetComponentTransform();
+
+		if (Location)
+		{
+			CurrentTransform.SetLocation(*Location);
+		}
+		if (Rotation)
+		{
+			CurrentTransform.SetRotation(Rotation->Quaternion());
+		}
+		if (Scale)
+		{
+			CurrentTransform.SetScale3D(*Scale);
+		}
+
+		Component->SetWorldTransform(CurrentTransform);
+		// Notify component of movement (bFinished=false indicates movement is still in progress)
+		Component->PostEditComponentMove(false);
+	}
+}
+
+bool FComponentTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms = InitialTransforms;
+	return true;
+}
+
+void FComponentTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	if (Transforms.Num() == 0)
 	{
 		return;
 	}
 
-	for (FSelectionIterator It(*Selection); It; ++It)
+	for (USceneComponent* Component : GetComponents())
 	{
-		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		const FTransform* ComponentTransform = Transforms.Find(Component->GetUniqueID());
+		if (ComponentTransform && ComponentTransform->IsValid())
 		{
-			FTransform CurrentTransform = Component->GetComponentTransform();
-
-			if (Location)
-			{
-				CurrentTransform.SetLocation(*Location);
-			}
-			if (Rotation)
-			{
-				CurrentTransform.SetRotation(Rotation->Quaternion());
-			}
-			if (Scale)
-			{
-				CurrentTransform.SetScale3D(*Scale);
-			}
-
-			Component->SetWorldTransform(CurrentTransform);
-				// Notify component of movement (bFinished=false indicates movement is still in progress)
-				Component->PostEditComponentMove(false);
+			Component->SetWorldTransform(*ComponentTransform);
+			// Notify component of movement (bFinished=false indicates movement is still in progress)
+			Component->PostEditComponentMove(false);
 		}
 	}
 }
@@ -236,16 +313,9 @@ int32 FComponentTransformHandler::BeginTransaction(const FText& Description)
 	int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
 
 	// Mark all selected components as modified
-	USelection* Selection = GetSelectedComponents();
-	if (Selection)
+	for (USceneComponent* Component : GetComponents())
 	{
-		for (FSelectionIterator It(*Selection); It; ++It)
-		{
-			if (USceneComponent* Component = Cast<USceneComponent>(*It))
-			{
-				Component->Modify();
-			}
-		}
+		Component->Modify();
 	}
 
 	return TransactionIndex;
@@ -256,16 +326,11 @@ void FComponentTransformHandler::EndTransaction()
 	if (GEditor)
 	{
 		// Notify all selected components that movement has finished
-		USelection* Selection = GetSelectedComponents();
-		if (Selection)
+		// Component moves don't broadcast OnActorMoved, so the owners' bounds are refreshed explicitly
+		for (USceneComponent* Component : GetComponents())
 		{
-			for (FSelectionIterator It(*Selection); It; ++It)
-			{
-				if (USceneComponent* Component = Cast<USceneComponent>(*It))
-				{
-					Component->PostEditComponentMove(true);
-				}
-			}
+			Component->PostEditComponentMove(true);
+			FActorBoundsTree::MarkActorDirty(Component->GetOwner());
 		}
 
 		GEditor->EndTransaction();
@@ -0,0 +1,199 @@
+#include "FCompositeTransformHandler.h"
+#include "Blend4RealUtils.h"
+
+FCompositeTransformHandler::FCompositeTransformHandler(
+	const TArray<TSharedPtr<IBlend4RealTransformHandler>>& InHandlers)
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : InHandlers)
+	{
+		if (Handler && Handler->HasSelection())
+		{
+			Handlers.Add(Handler);
+		}
+	}
+}
+
+bool FCompositeTransformHandler::HasSelection() const
+{
+	return Handlers.Num() > 0;
+}
+
+int32 FCompositeTransformHandler::GetSelectionCount() const
+{
+	int32 Count = 0;
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Count += Handler->GetSelectionCount();
+	}
+	return Count;
+}
+
+FTransform FCompositeTransformHandler::ComputeSelectionPivot() const
+{
+	FTransform Pivot;
+	if (Blend4RealUtils::HasCustomPivot())
+	{
+		Pivot.SetLocation(Blend4RealUtils::GetCustomPivot());
+		return Pivot;
+	}
+
+	// Each sub-handler pivot weighs as many items as it transforms, so the pivot rules of each item type
+	// (e.g. actor pivot offsets) are kept
+	FVector Center = FVector::ZeroVector;
+	int32 Count = 0;
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		const int32 HandlerCount = Handler->GetSelectionCount();
+		Center += Handler->ComputeSelectionPivot().GetLocation() * HandlerCount;
+		Count += HandlerCount;
+	}
+	if (Count > 0)
+	{
+		Pivot.SetLocation(Center / Count);
+	}
+	return Pivot;
+}
+
+FTransform FCompositeTransformHandler::GetFirstSelectedItemTransform() const
+{
+	return Handlers.Num() > 0 ? Handlers[0]->GetFirstSelectedItemTransform() : FTransform::Identity;
+}
+
+FVector FCompositeTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
+{
+	// Each sub-handler axis weighs as many items as it transforms
+	FVector AccumulatedAxis = FVector::ZeroVector;
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		AccumulatedAxis += Handler->ComputeAverageLocalAxis(Axis) * Handler->GetSelectionCount();
+	}
+	return AccumulatedAxis.GetSafeNormal();
+}
+
+void FCompositeTransformHandler::CaptureInitialState()
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->CaptureInitialState();
+	}
+}
+
+void FCompositeTransformHandler::RestoreInitialState()
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->RestoreInitialState();
+	}
+}
+
+bool FCompositeTransformHandler::RecaptureInitialState()
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		if (!Handler->RecaptureInitialState())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FCompositeTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                           const FTransform& NewPivotTransform)
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->ApplyTransformAroundPivot(InitialPivot, NewPivotTransform);
+	}
+}
+
+void FCompositeTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
+                                                    const FVector* Scale)
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->SetDirectTransform(Location, Rotation, Scale);
+	}
+}
+
+bool FCompositeTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset();
+	TMap<uint32, FTransform> ItemTransforms;
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		if (!Handler->GetInitialItemTransforms(ItemTransforms))
+		{
+			OutTransforms.Reset();
+			return false;
+		}
+		OutTransforms.Append(ItemTransforms);
+	}
+	return true;
+}
+
+void FCompositeTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	// Each sub-handler only looks up the ids of its own items
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->SetItemTransforms(Transforms);
+	}
+}
+
+void FCompositeTransformHandler::GetMovedInstances(
+	TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->GetMovedInstances(OutInstances);
+	}
+}
+
+void FCompositeTransformHandler::GetMovedActors(TArray<AActor*>& OutActors) const
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->GetMovedActors(OutActors);
+	}
+}
+
+void FCompositeTransformHandler::FlushDeferredUpdates()
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->FlushDeferredUpdates();
+	}
+}
+
+int32 FCompositeTransformHandler::BeginTransaction(const FText& Description)
+{
+	// The transactions of the other sub-handlers are nested in the first one, and recorded with it
+	int32 TransactionIndex = -1;
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		const int32 HandlerTransactionIndex = Handler->BeginTransaction(Description);
+		if (TransactionIndex < 0)
+		{
+			TransactionIndex = HandlerTransactionIndex;
+		}
+	}
+	return TransactionIndex;
+}
+
+void FCompositeTransformHandler::EndTransaction()
+{
+	for (const TSharedPtr<IBlend4RealTransformHandler>& Handler : Handlers)
+	{
+		Handler->EndTransaction();
+	}
+}
+
+void FCompositeTransformHandler::CancelTransaction(int32 TransactionIndex)
+{
+	// Cancelling the outer transaction discards the nested ones
+	if (Handlers.Num() > 0)
+	{
+		Handlers[0]->CancelTransaction(TransactionIndex);
+	}
+}
@@ -0,0 +1,329 @@
+#include "FElementSnapper.h"
+#include "Blend4RealUtils.h"
+#include "FActorBoundsTree.h"
+#include "FMeshBVHPicker.h"
+#include "EditorViewportClient.h"
+#include "SceneView.h"
+#include "UnrealClient.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+
+namespace
+{
+	// Edges are reached from their vertices, searched in a wider cone than vertices
+	constexpr double EdgeSearchRadiusScale = 2.0;
+
+	struct FSnapSearch
+	{
+		const FSceneView* View = nullptr;
+		FVector2D CursorPixel = FVector2D::ZeroVector;
+		FVector RayOrigin = FVector::ZeroVector;
+		FVector RayDirection = FVector::ZeroVector;
+		double RadiusPixels = 0.0;
+		// World radius of the snap cone at distance T along the ray is ConeOffset + ConeSlope * T
+		double ConeOffset = 0.0;
+		double ConeSlope = 0.0;
+		bool bVertex = false;
+		bool bEdge = false;
+
+		double BestVertexDistance = TNumericLimits<double>::Max();
+		FVector BestVertex = FVector::ZeroVector;
+		double BestEdgeDistance = TNumericLimits<double>::Max();
+		FVector BestEdgePoint = FVector::ZeroVector;
+
+		/** Returns true if the box reaches the snap cone scaled by RadiusScale, starting before MaxDepth along the ray */
+		bool ReachesCone(const FBox& Box, const double MaxDepth, const double RadiusScale = 1.0) const
+		{
+			const FVector Center = Box.GetCenter();
+			const double HalfDiagonal = Box.GetExtent().Size();
+			const double CenterT = (Center - RayOrigin) | RayDirection;
+			const double FarthestT = CenterT + HalfDiagonal;
+			if (FarthestT < 0.0 || CenterT - HalfDiagonal > MaxDepth)
+			{
+				return false;
+			}
+			const double DistanceToRay = (Center - (RayOrigin + RayDirection * CenterT)).Size();
+			return DistanceToRay - HalfDiagonal <= RadiusScale * (ConeOffset + ConeSlope * FarthestT);
+		}
+
+		/** Pixel distance from the cursor, false if the point is behind the view */
+		bool GetPixelDistance(const FVector& WorldPoint, double& OutDistance) const
+		{
+			FVector2D Pixel;
+			if (!View->WorldToPixel(WorldPoint, Pixel))
+			{
+				return false;
+			}
+			OutDistance = FVector2D::Distance(Pixel, CursorPixel);
+			return true;
+		}
+
+		void ConsiderEdge(const FVector& A, const FVector& B)
+		{
+			FVector PointOnEdge, PointOnRay;
+			FMath::SegmentDistToSegmentSafe(A, B, RayOrigin, RayOrigin + RayDirection * Blend4RealUtils::ScenePickDistance,
+			                                PointOnEdge, PointOnRay);
+			double Distance;
+			if (GetPixelDistance(PointOnEdge, Distance) && Distance <= RadiusPixels && Distance < BestEdgeDistance)
+			{
+				BestEdgeDistance = Distance;
+				BestEdgePoint = PointOnEdge;
+			}
+		}
+
+		void SearchComponent(const UStaticMeshComponent* Component)
+		{
+			const TSharedPtr<const FMeshVertexKDTree> Tree = FMeshBVHPicker::FindOrBuildVertexTree(
+				Component->GetStaticMesh());
+			if (!Tree.IsValid())
+			{
+				return;
+			}
+
+			// Search in mesh space. The ray parameter is the world distance along the ray in both spaces.
+			const FTransform& ComponentTransform = Component->GetComponentTransform();
+			const FVector3f LocalOrigin(ComponentTransform.InverseTransformPosition(RayOrigin));
+			const FVector3f LocalDirection(ComponentTransform.InverseTransformVector(RayDirection));
+			const float LocalDirectionSize = LocalDirection.Size();
+			if (LocalDirectionSize <= UE_SMALL_NUMBER)
+			{
+				return;
+			}
+			// Conservative for non-uniform scale: local distances are at least world distances / min scale
+			const double MinScale = FMath::Max(ComponentTransform.GetScale3D().GetAbs().GetMin(), UE_SMALL_NUMBER);
+			const double SearchScale = bEdge ? EdgeSearchRadiusScale : 1.0;
+
+			auto NodeFilter = [&](const FVector3f& Min, const FVector3f& Max)
+			{
+				const FVector3f Center = (Min + Max) * 0.5f;
+				const float HalfDiagonal = ((Max - Min) * 0.5f).Size();
+				const float CenterT = ((Center - LocalOrigin) | LocalDirection) / (LocalDirectionSize * LocalDirectionSize);
+				const float FarthestT = CenterT + HalfDiagonal / LocalDirectionSize;
+				if (FarthestT < 0.f)
+				{
+					return false;
+				}
+				const float DistanceToRay = (Center - (LocalOrigin + LocalDirection * CenterT)).Size();
+				return MinScale * (DistanceToRay - HalfDiagonal) <= SearchScale * (ConeOffset + ConeSlope * FarthestT);
+			};
+
+			auto Visit = [&](const uint32 Vertex)
+			{
+				const FVector WorldVertex = ComponentTransform.TransformPosition(FVector(Tree->GetPosition(Vertex)));
+				double Distance;
+				if (!GetPixelDistance(WorldVertex, Distance))
+				{
+					return;
+				}
+				if (bVertex && Distance <= RadiusPixels && Distance < BestVertexDistance)
+				{
+					BestVertexDistance = Distance;
+					BestVertex = WorldVertex;
+				}
+				if (bEdge && Distance <= RadiusPixels * EdgeSearchRadiusScale)
+				{
+					for (const uint32 Neighbor : Tree->GetNeighbors(Vertex))
+					{
+						ConsiderEdge(WorldVertex, ComponentTransform.TransformPosition(FVector(Tree->GetPosition(Neighbor))));
+					}
+				}
+			};
+
+			Tree->ForEachVertex(NodeFilter, Visit);
+
+			// Long edges can pass under the cursor with both vertices far from it: also try the triangle under the cursor
+			if (bEdge)
+			{
+				const FVector3f LocalEnd(ComponentTransform.InverseTransformPosition(
+					RayOrigin + RayDirection * Blend4RealUtils::ScenePickDistance));
+				float Time = 1.f;
+				int32 Triangle;
+				if (Tree->Mesh->Raycast(LocalOrigin, LocalEnd - LocalOrigin, Time, Triangle))
+				{
+					for (int32 Corner = 0; Corner < 3; ++Corner)
+					{
+						ConsiderEdge(
+							ComponentTransform.TransformPosition(FVector(Tree->GetPosition(Tree->Mesh->Indices[Triangle * 3 + Corner]))),
+							ComponentTransform.TransformPosition(FVector(Tree->GetPosition(Tree->Mesh->Indices[Triangle * 3 + (Corner + 1) % 3]))));
+					}
+				}
+			}
+		}
+	};
+
+	/** Snap the pivot to the actor pivot closest to the cursor */
+	bool FindPivotSnap(const FActorBoundsTree& Tree, const FSnapSearch& Search, const FElementSnapContext& Context,
+	                   FVector& OutLocation)
+	{
+		auto NodeFilter = [&Search](const FBox& Box)
+		{
+			return Search.ReachesCone(Box, TNumericLimits<double>::Max());
+		};
+
+		double BestDistance = Search.RadiusPixels;
+		bool bFound = false;
+		Tree.Query(NodeFilter, [&](const int32 ProxyId)
+		{
+			double Distance;
+			if (!Context.ExcludedBoundsProxies.Contains(ProxyId)
+				&& Search.GetPixelDistance(Tree.GetPivot(ProxyId), Distance) && Distance <= BestDistance)
+			{
+				BestDistance = Distance;
+				OutLocation = Tree.GetPivot(ProxyId);
+				bFound = true;
+			}
+		});
+		return bFound;
+	}
+
+	/** Offset the proposed pivot so the moved bounds touch or align with the closest faces of the nearby actors bounds */
+	bool FindBoundsFaceSnap(const FActorBoundsTree& Tree, const FSnapSearch& Search, const FElementSnapContext& Context,
+	                        const FVector& ProposedPivot, FVector& OutLocation)
+	{
+		if (!Context.SelectionBounds.IsValid)
+		{
+			return false;
+		}
+
+		// Snap distance in world units at the depth of the moved selection
+		const double Depth = FMath::Max((ProposedPivot - Search.RayOrigin) | Search.RayDirection, 0.0);
+		const double Threshold = Search.ConeOffset + Search.ConeSlope * Depth;
+		const FBox Moved = Context.SelectionBounds.ShiftBy(ProposedPivot - Context.InitialPivot);
+		const FBox SearchBox = Moved.ExpandBy(Threshold);
+
+		FVector BestOffset = FVector::ZeroVector;
+		FVector BestDistance(TNumericLimits<double>::Max());
+		Tree.Query([&SearchBox](const FBox& Box) { return Box.Intersect(SearchBox); }, [&](const int32 ProxyId)
+		{
+			const FBox& Bounds = Tree.GetBounds(ProxyId);
+			if (!Bounds.IsValid || !Bounds.Intersect(SearchBox) || Context.ExcludedBoundsProxies.Contains(ProxyId))
+			{
+				return;
+			}
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				// Butt the faces against each other, or align them
+				const double Offsets[] = {
+					Bounds.Min[Axis] - Moved.Max[Axis], Bounds.Max[Axis] - Moved.Min[Axis],
+					Bounds.Min[Axis] - Moved.Min[Axis], Bounds.Max[Axis] - Moved.Max[Axis]
+				};
+				for (const double Offset : Offsets)
+				{
+					if (FMath::Abs(Offset) <= Threshold && FMath::Abs(Offset) < BestDistance[Axis])
+					{
+						BestDistance[Axis] = FMath::Abs(Offset);
+						BestOffset[Axis] = Offset;
+					}
+				}
+			}
+		});
+
+		if (BestDistance.GetMin() > Threshold)
+		{
+			return false;
+		}
+		OutLocation = ProposedPivot + BestOffset;
+		return true;
+	}
+}
+
+bool FElementSnapper::FindSnapLocation(FEditorViewportClient* ViewportClient, const EBlend4RealSnapElement Element,
+                                       const FElementSnapContext& Context, const FCollisionQueryParams& TraceParams,
+                                       const FVector& ProposedPivot, FVector& OutLocation)
+{
+	if (!ViewportClient || !ViewportClient->Viewport || Element == EBlend4RealSnapElement::None)
+	{
+		return false;
+	}
+	const TSet<const UObject*>& ExcludedObjects = Context.ExcludedObjects;
+
+	FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+		ViewportClient->Viewport, ViewportClient->GetScene(), ViewportClient->EngineShowFlags));
+	const FSceneView* View = ViewportClient->CalcSceneView(&ViewFamily);
+	if (!View)
+	{
+		return false;
+	}
+
+	FIntPoint MousePos;
+	ViewportClient->Viewport->GetMousePos(MousePos);
+
+	FSnapSearch Search;
+	Search.View = View;
+	Search.CursorPixel = FVector2D(MousePos);
+	Search.RadiusPixels = FMath::Max(UBlend4RealSettings::Get()->ElementSnapRadius, 1);
+	Search.bVertex = Element == EBlend4RealSnapElement::Vertex || Element == EBlend4RealSnapElement::VertexAndEdge;
+	Search.bEdge = Element == EBlend4RealSnapElement::Edge || Element == EBlend4RealSnapElement::VertexAndEdge;
+	View->DeprojectFVector2D(Search.CursorPixel, Search.RayOrigin, Search.RayDirection);
+
+	// Snap radius in world units, growing with distance in perspective views
+	const double NDCRadius = 2.0 * Search.RadiusPixels / FMath::Max(View->UnscaledViewRect.Width(), 1);
+	const double ProjectionScale = FMath::Max(FMath::Abs(View->ViewMatrices.GetProjectionMatrix().M[0][0]), UE_SMALL_NUMBER);
+	if (View->IsPerspectiveProjection())
+	{
+		Search.ConeSlope = NDCRadius / ProjectionScale;
+	}
+	else
+	{
+		Search.ConeOffset = NDCRadius / ProjectionScale;
+	}
+
+	const UWorld* World = ViewportClient->GetWorld();
+	const FActorBoundsTree* Tree = FActorBoundsTree::Get(World);
+	if (!Tree)
+	{
+		return false;
+	}
+
+	if (Element == EBlend4RealSnapElement::BoundsFace || Element == EBlend4RealSnapElement::Pivot)
+	{
+		return Element == EBlend4RealSnapElement::Pivot
+			       ? FindPivotSnap(*Tree, Search, Context, OutLocation)
+			       : FindBoundsFaceSnap(*Tree, Search, Context, ProposedPivot, OutLocation);
+	}
+
+	// The hit proxies aren't refreshed during the grab: candidates are the actors whose bounds reach the snap cone
+	// in front of the first surface under the cursor, the moved objects being ignored by the trace
+	const FHitResult SurfaceHit = Blend4RealUtils::ProjectToSurface(World, Search.RayOrigin, Search.RayDirection,
+	                                                                TraceParams);
+	const double MaxDepth = SurfaceHit.bBlockingHit ? SurfaceHit.Distance : Blend4RealUtils::ScenePickDistance;
+	const double SearchScale = Search.bEdge ? EdgeSearchRadiusScale : 1.0;
+	TArray<const AActor*> Actors;
+	Tree->Query([&Search, MaxDepth, SearchScale](const FBox& Box)
+	{
+		return Search.ReachesCone(Box, MaxDepth, SearchScale);
+	}, [&Actors, Tree](const int32 ProxyId)
+	{
+		Actors.Add(Tree->GetActor(ProxyId));
+	});
+
+	for (const AActor* Actor : Actors)
+	{
+		if (!Actor || ExcludedObjects.Contains(Actor))
+		{
+			continue;
+		}
+		Actor->ForEachComponent<UStaticMeshComponent>(false, [&Search, &ExcludedObjects](const UStaticMeshComponent* Component)
+		{
+			// Instances would need a per instance transform, not supported
+			if (Component->GetStaticMesh() && Component->IsVisibleInEditor() && !ExcludedObjects.Contains(Component)
+				&& !Component->IsA<UInstancedStaticMeshComponent>())
+			{
+				Search.SearchComponent(Component);
+			}
+		});
+	}
+
+	// Vertices have priority over edges, like in Blender
+	if (Search.BestVertexDistance <= Search.RadiusPixels)
+	{
+		OutLocation = Search.BestVertex;
+		return true;
+	}
+	if (Search.BestEdgeDistance <= Search.RadiusPixels)
+	{
+		OutLocation = Search.BestEdgePoint;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,350 @@
+#include "FFoliageTransformHandler.h"
+#include "Blend4RealUtils.h"
+#include "Editor.h"
+#include "EditorModeManager.h"
+#include "EditorModes.h"
+#include "EngineUtils.h"
+#include "FoliageType.h"
+#include "InstancedFoliage.h"
+#include "InstancedFoliageActor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+FFoliageTransformHandler::FFoliageTransformHandler()
+{
+	UWorld* World = Blend4RealUtils::GetEditorWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (TActorIterator<AInstancedFoliageActor> It(World); It; ++It)
+	{
+		AInstancedFoliageActor* FoliageActor = *It;
+		FoliageActor->ForEachFoliageInfo([this, FoliageActor](UFoliageType* FoliageType, FFoliageInfo& Info)
+		{
+			if (Info.SelectedIndices.Num() > 0)
+			{
+				FFoliageSelection& Selection = Selections.AddDefaulted_GetRef();
+				Selection.FoliageActor = FoliageActor;
+				Selection.FoliageType = FoliageType;
+				Selection.Indices = Info.SelectedIndices.Array();
+				Selection.Indices.Sort();
+				Selection.FirstItemId = NumInstances;
+				NumInstances += Selection.Indices.Num();
+			}
+			return true;
+		});
+	}
+}
+
+bool FFoliageTransformHandler::IsFoliageModeActive()
+{
+	return GLevelEditorModeTools().IsModeActive(FBuiltinEditorModes::EM_Foliage);
+}
+
+bool FFoliageTransformHandler::HasSelection() const
+{
+	return NumInstances > 0;
+}
+
+int32 FFoliageTransformHandler::GetSelectionCount() const
+{
+	return NumInstances;
+}
+
+FTransform FFoliageTransformHandler::ComputeSelectionPivot() const
+{
+	FTransform Pivot;
+	if (Blend4RealUtils::HasCustomPivot())
+	{
+		Pivot.SetLocation(Blend4RealUtils::GetCustomPivot());
+		return Pivot;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const FFoliageSelection& Selection : Selections)
+	{
+		for (const FTransform& Transform : Selection.Initial)
+		{
+			Center += Transform.GetLocation();
+		}
+	}
+	if (NumInstances > 0)
+	{
+		Pivot.SetLocation(Center / NumInstances);
+	}
+	return Pivot;
+}
+
+FTransform FFoliageTransformHandler::GetFirstSelectedItemTransform() const
+{
+	return Selections.Num() > 0 && Selections[0].Initial.Num() > 0 ? Selections[0].Initial[0] : FTransform::Identity;
+}
+
+FVector FFoliageTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
+{
+	FVector AccumulatedAxis = FVector::ZeroVector;
+	for (const FFoliageSelection& Selection : Selections)
+	{
+		for (const FTransform& Transform : Selection.Initial)
+		{
+			const FQuat Rotation = Transform.GetRotation();
+			AccumulatedAxis += Axis == EAxis::X
+				                   ? Rotation.GetForwardVector()
+				                   : Axis == EAxis::Y
+				                   ? Rotation.GetRightVector()
+				                   : Rotation.GetUpVector();
+		}
+	}
+	return NumInstances > 0 ? (AccumulatedAxis / NumInstances).GetSafeNormal() : FVector::ZeroVector;
+}
+
+void FFoliageTransformHandler::CaptureInitialState()
+{
+	for (FFoliageSelection& Selection : Selections)
+	{
+		Selection.Initial.SetNum(Selection.Indices.Num());
+		Selection.WriteRuns.Reset();
+		Selection.bDirty = false;
+		Selection.bMoving = false;
+
+		const FFoliageInfo* Info = FindInfo(Selection);
+		if (!Info)
+		{
+			Selection.Current = Selection.Initial;
+			continue;
+		}
+
+		for (int32 Item = 0; Item < Selection.Indices.Num(); ++Item)
+		{
+			Selection.Initial[Item] = Info->Instances[Selection.Indices[Item]].GetInstanceWorldTransform();
+		}
+		Selection.Current = Selection.Initial;
+
+		// Only static mesh foliage has an instance component, other foliage types are moved on confirm
+		Selection.WriteRuns.Capture(Info->GetComponent(), Selection.Indices);
+	}
+}
+
+void FFoliageTransformHandler::RestoreInitialState()
+{
+	for (FFoliageSelection& Selection : Selections)
+	{
+		Selection.Current = Selection.Initial;
+		Selection.bDirty = false;
+		if (Selection.bMoving)
+		{
+			FinishMove(Selection);
+		}
+	}
+}
+
+void FFoliageTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                         const FTransform& NewPivotTransform)
+{
+	const FTransform InitialPivotInverse = InitialPivot.Inverse();
+	for (FFoliageSelection& Selection : Selections)
+	{
+		for (int32 Item = 0; Item < Selection.Indices.Num(); ++Item)
+		{
+			const FTransform InstanceTransform = Selection.Initial[Item] * InitialPivotInverse * NewPivotTransform;
+			if (!InstanceTransform.ContainsNaN())
+			{
+				Selection.Current[Item] = InstanceTransform;
+			}
+		}
+		Selection.bDirty = true;
+	}
+}
+
+void FFoliageTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
+                                                  const FVector* Scale)
+{
+	for (FFoliageSelection& Selection : Selections)
+	{
+		// Reset Transform doesn't begin a transform session
+		if (Selection.Current.Num() != Selection.Indices.Num())
+		{
+			CaptureInitialState();
+		}
+		for (FTransform& Transform : Selection.Current)
+		{
+			if (Location)
+			{
+				Transform.SetLocation(*Location);
+			}
+			if (Rotation)
+			{
+				Transform.SetRotation(Rotation->Quaternion());
+			}
+			if (Scale)
+			{
+				Transform.SetScale3D(*Scale);
+			}
+		}
+		Selection.bDirty = true;
+	}
+}
+
+bool FFoliageTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset();
+	OutTransforms.Reserve(NumInstances);
+	for (const FFoliageSelection& Selection : Selections)
+	{
+		for (int32 Item = 0; Item < Selection.Initial.Num(); ++Item)
+		{
+			OutTransforms.Add(Selection.FirstItemId + Item, Selection.Initial[Item]);
+		}
+	}
+	return true;
+}
+
+void FFoliageTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	if (Transforms.Num() == 0)
+	{
+		return;
+	}
+
+	for (FFoliageSelection& Selection : Selections)
+	{
+		for (int32 Item = 0; Item < Selection.Current.Num(); ++Item)
+		{
+			const FTransform* InstanceTransform = Transforms.Find(Selection.FirstItemId + Item);
+			if (InstanceTransform && !InstanceTransform->ContainsNaN())
+			{
+				Selection.Current[Item] = *InstanceTransform;
+				Selection.bDirty = true;
+			}
+		}
+	}
+}
+
+void FFoliageTransformHandler::GetMovedInstances(
+	TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const
+{
+	for (const FFoliageSelection& Selection : Selections)
+	{
+		const FFoliageInfo* Info = FindInfo(Selection);
+		if (UHierarchicalInstancedStaticMeshComponent* Component = Info ? Info->GetComponent() : nullptr)
+		{
+			OutInstances.FindOrAdd(Component).Append(Selection.Indices);
+		}
+	}
+}
+
+void FFoliageTransformHandler::FlushDeferredUpdates()
+{
+	for (FFoliageSelection& Selection : Selections)
+	{
+		if (Selection.bDirty)
+		{
+			WriteInstances(Selection);
+		}
+	}
+}
+
+int32 FFoliageTransformHandler::BeginTransaction(const FText& Description)
+{
+	if (!GEditor)
+	{
+		return -1;
+	}
+
+	const int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
+	for (const FFoliageSelection& Selection : Selections)
+	{
+		if (AInstancedFoliageActor* FoliageActor = Selection.FoliageActor.Get())
+		{
+			FoliageActor->Modify();
+		}
+	}
+	return TransactionIndex;
+}
+
+void FFoliageTransformHandler::EndTransaction()
+{
+	for (FFoliageSelection& Selection : Selections)
+	{
+		// Items that weren't flushed yet (e.g. a confirm in the same frame as the last move) are moved too
+		if (Selection.bDirty || Selection.bMoving)
+		{
+			BeginMove(Selection);
+			FinishMove(Selection);
+		}
+	}
+	if (GEditor)
+	{
+		GEditor->EndTransaction();
+	}
+}
+
+void FFoliageTransformHandler::CancelTransaction(int32 TransactionIndex)
+{
+	if (GEditor && TransactionIndex >= 0)
+	{
+		GEditor->CancelTransaction(TransactionIndex);
+	}
+}
+
+FFoliageInfo* FFoliageTransformHandler::FindInfo(const FFoliageSelection& Selection) const
+{
+	AInstancedFoliageActor* FoliageActor = Selection.FoliageActor.Get();
+	const UFoliageType* FoliageType = Selection.FoliageType.Get();
+	return FoliageActor && FoliageType ? FoliageActor->FindInfo(FoliageType) : nullptr;
+}
+
+void FFoliageTransformHandler::BeginMove(FFoliageSelection& Selection) const
+{
+	if (Selection.bMoving)
+	{
+		return;
+	}
+
+	if (FFoliageInfo* Info = FindInfo(Selection))
+	{
+		Info->PreMoveInstances(Selection.Indices);
+		Selection.bMoving = true;
+	}
+}
+
+void FFoliageTransformHandler::FinishMove(FFoliageSelection& Selection) const
+{
+	FFoliageInfo* Info = FindInfo(Selection);
+	if (!Info)
+	{
+		Selection.bMoving = false;
+		return;
+	}
+
+	for (int32 Item = 0; Item < Selection.Indices.Num(); ++Item)
+	{
+		const FTransform& Transform = Selection.Current[Item];
+		FFoliageInstance& Instance = Info->Instances[Selection.Indices[Item]];
+		Instance.Location = Transform.GetLocation();
+		Instance.Rotation = Transform.Rotator();
+		Instance.DrawScale3D = FVector3f(Transform.GetScale3D());
+	}
+
+	// Inserts the instances back into the foliage hash and rebuilds the instance tree
+	Info->PostMoveInstances(Selection.Indices, true);
+	Selection.bMoving = false;
+	Selection.bDirty = false;
+}
+
+void FFoliageTransformHandler::WriteInstances(FFoliageSelection& Selection) const
+{
+	Selection.bDirty = false;
+	FFoliageInfo* Info = FindInfo(Selection);
+	UHierarchicalInstancedStaticMeshComponent* Component = Info ? Info->GetComponent() : nullptr;
+	if (!Component || Selection.WriteRuns.IsEmpty())
+	{
+		// Without an instance component the instances are only moved on confirm
+		Selection.bDirty = true;
+		return;
+	}
+
+	BeginMove(Selection);
+	Selection.WriteRuns.Write(Component, Selection.Indices, Selection.Current);
+}
@@ -0,0 +1,313 @@
+#include "FGhostDuplicateTransformHandler.h"
+#include "Blend4RealUtils.h"
+#include "Editor.h"
+#include "Engine/Selection.h"
+#include "Engine/World.h"
+#include "Components/LineBatchComponent.h"
+
+namespace
+{
+	// Half size of the box drawn for actors without primitive components
+	constexpr double EmptyGhostExtent = 10.0;
+}
+
+FGhostDuplicateTransformHandler::FGhostDuplicateTransformHandler()
+{
+	if (!GEditor)
+	{
+		return;
+	}
+
+	for (FSelectionIterator It(*GEditor->GetSelectedActors()); It; ++It)
+	{
+		if (AActor* Actor = Cast<AActor>(*It))
+		{
+			FGhostItem& Item = Items.AddDefaulted_GetRef();
+			Item.Source = Actor;
+			Item.LocalBounds = Actor->CalculateComponentsBoundingBoxInLocalSpace(true);
+			if (!Item.LocalBounds.IsValid)
+			{
+				Item.LocalBounds = FBox(FVector(-EmptyGhostExtent), FVector(EmptyGhostExtent));
+			}
+		}
+	}
+}
+
+FGhostDuplicateTransformHandler::~FGhostDuplicateTransformHandler()
+{
+	ClearGhosts();
+}
+
+bool FGhostDuplicateTransformHandler::HasSelection() const
+{
+	return Items.Num() > 0;
+}
+
+int32 FGhostDuplicateTransformHandler::GetSelectionCount() const
+{
+	return Items.Num();
+}
+
+FTransform FGhostDuplicateTransformHandler::ComputeSelectionPivot() const
+{
+	// The sources are still the selected actors
+	return Blend4RealUtils::ComputeSelectionPivot();
+}
+
+FTransform FGhostDuplicateTransformHandler::GetFirstSelectedItemTransform() const
+{
+	return Items.Num() > 0 ? Items[0].Initial : FTransform::Identity;
+}
+
+FVector FGhostDuplicateTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
+{
+	if (Items.Num() == 0)
+	{
+		return FVector::ZeroVector;
+	}
+
+	FVector AccumulatedAxis = FVector::ZeroVector;
+	for (const FGhostItem& Item : Items)
+	{
+		const FQuat Rotation = Item.Initial.GetRotation();
+		AccumulatedAxis += Axis == EAxis::X
+			                   ? Rotation.GetForwardVector()
+			                   : Axis == EAxis::Y
+			                   ? Rotation.GetRightVector()
+			                   : Rotation.GetUpVector();
+	}
+	return (AccumulatedAxis / Items.Num()).GetSafeNormal();
+}
+
+void FGhostDuplicateTransformHandler::CaptureInitialState()
+{
+	for (FGhostItem& Item : Items)
+	{
+		if (const AActor* Source = Item.Source.Get())
+		{
+			Item.Initial = Item.Current = Source->GetActorTransform();
+		}
+	}
+	bUniformTranslation = true;
+	UniformTranslation = FVector::ZeroVector;
+	DrawGhosts();
+}
+
+void FGhostDuplicateTransformHandler::RestoreInitialState()
+{
+	// Nothing was spawned
+	for (FGhostItem& Item : Items)
+	{
+		Item.Current = Item.Initial;
+	}
+	ClearGhosts();
+}
+
+void FGhostDuplicateTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                                const FTransform& NewPivotTransform)
+{
+	const FTransform InitialPivotInverse = InitialPivot.Inverse();
+	for (FGhostItem& Item : Items)
+	{
+		const FTransform ItemTransform = Item.Initial * InitialPivotInverse * NewPivotTransform;
+		if (!ItemTransform.ContainsNaN())
+		{
+			Item.Current = ItemTransform;
+		}
+	}
+
+	bUniformTranslation = NewPivotTransform.GetRotation().Equals(InitialPivot.GetRotation())
+		&& NewPivotTransform.GetScale3D().Equals(InitialPivot.GetScale3D());
+	UniformTranslation = NewPivotTransform.GetLocation() - InitialPivot.GetLocation();
+	DrawGhosts();
+}
+
+void FGhostDuplicateTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
+                                                         const FVector* Scale)
+{
+	for (FGhostItem& Item : Items)
+	{
+		if (Location)
+		{
+			Item.Current.SetLocation(*Location);
+		}
+		if (Rotation)
+		{
+			Item.Current.SetRotation(Rotation->Quaternion());
+		}
+		if (Scale)
+		{
+			Item.Current.SetScale3D(*Scale);
+		}
+	}
+	bUniformTranslation = false;
+	DrawGhosts();
+}
+
+bool FGhostDuplicateTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset();
+	for (const FGhostItem& Item : Items)
+	{
+		if (const AActor* Source = Item.Source.Get())
+		{
+			OutTransforms.Add(Source->GetUniqueID(), Item.Initial);
+		}
+	}
+	return true;
+}
+
+void FGhostDuplicateTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	if (Transforms.Num() == 0)
+	{
+		return;
+	}
+
+	for (FGhostItem& Item : Items)
+	{
+		const AActor* Source = Item.Source.Get();
+		const FTransform* ItemTransform = Source ? Transforms.Find(Source->GetUniqueID()) : nullptr;
+		if (ItemTransform && !ItemTransform->ContainsNaN())
+		{
+			Item.Current = *ItemTransform;
+		}
+	}
+	bUniformTranslation = false;
+	DrawGhosts();
+}
+
+int32 FGhostDuplicateTransformHandler::BeginTransaction(const FText& Description)
+{
+	if (!GEditor)
+	{
+		return -1;
+	}
+
+	// Named after the action rather than the transform mode, the transaction only contains the copies
+	return GEditor->BeginTransaction(TEXT(""), FText::FromString(TEXT("Duplicate")), nullptr);
+}
+
+void FGhostDuplicateTransformHandler::EndTransaction()
+{
+	ClearGhosts();
+	if (GEditor)
+	{
+		SpawnDuplicates();
+		GEditor->EndTransaction();
+	}
+}
+
+void FGhostDuplicateTransformHandler::CancelTransaction(int32 TransactionIndex)
+{
+	ClearGhosts();
+	if (GEditor && TransactionIndex >= 0)
+	{
+		GEditor->CancelTransaction(TransactionIndex);
+	}
+}
+
+void FGhostDuplicateTransformHandler::SpawnDuplicates()
+{
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	if (!World)
+	{
+		return;
+	}
+
+	TArray<AActor*> Sources;
+	TArray<const FGhostItem*> SourceItems;
+	Sources.Reserve(Items.Num());
+	SourceItems.Reserve(Items.Num());
+	for (const FGhostItem& Item : Items)
+	{
+		if (AActor* Source = Item.Source.Get())
+		{
+			Sources.Add(Source);
+			SourceItems.Add(&Item);
+		}
+	}
+	if (Sources.Num() == 0)
+	{
+		return;
+	}
+
+	// A plain grab is applied as the paste offset: the copies are spawned and constructed at their final location
+	TArray<AActor*> NewActors;
+	Blend4RealUtils::DuplicateActorsInOrder(Sources, World->GetCurrentLevel(),
+	                                        bUniformTranslation ? UniformTranslation : FVector::ZeroVector, NewActors);
+
+	if (!bUniformTranslation)
+	{
+		// Items moved independently (surface snapping, rotation, scale): the copies are pasted over their source and
+		// moved to the transform of their item
+		for (int32 Index = 0; Index < NewActors.Num(); ++Index)
+		{
+			if (AActor* NewActor = NewActors[Index])
+			{
+				NewActor->SetActorTransform(SourceItems[Index]->Current, false, nullptr, ETeleportType::None);
+				NewActor->PostEditMove(true);
+			}
+		}
+	}
+	NewActors.Remove(nullptr);
+
+	// The copies replace the sources in the selection, like a regular duplicate
+	GEditor->SelectNone(false, true, false);
+	for (AActor* NewActor : NewActors)
+	{
+		GEditor->SelectActor(NewActor, true, false);
+	}
+	GEditor->NoteSelectionChange();
+
+	UE_LOG(LogTemp, Display, TEXT("Blend4Real: Duplicated %d actors"), NewActors.Num());
+}
+
+void FGhostDuplicateTransformHandler::DrawGhosts()
+{
+	if (!LineBatcher)
+	{
+		UWorld* World = Blend4RealUtils::GetEditorWorld();
+		LineBatcher = World ? World->GetLineBatcher(UWorld::ELineBatcherType::WorldPersistent) : nullptr;
+		if (!LineBatcher)
+		{
+			return;
+		}
+	}
+
+	LineBatcher->ClearBatch(GHOST_DUPLICATE_BATCH_ID);
+
+	// Corner bit i selects Max on axis i; edges join the corners differing by one bit
+	static constexpr int32 Edges[12][2] = {
+		{0, 1}, {2, 3}, {4, 5}, {6, 7},
+		{0, 2}, {1, 3}, {4, 6}, {5, 7},
+		{0, 4}, {1, 5}, {2, 6}, {3, 7}
+	};
+	const FLinearColor GhostColor(FColor::Orange);
+	for (const FGhostItem& Item : Items)
+	{
+		FVector Corners[8];
+		for (int32 Corner = 0; Corner < 8; ++Corner)
+		{
+			const FVector LocalCorner(
+				(Corner & 1) ? Item.LocalBounds.Max.X : Item.LocalBounds.Min.X,
+				(Corner & 2) ? Item.LocalBounds.Max.Y : Item.LocalBounds.Min.Y,
+				(Corner & 4) ? Item.LocalBounds.Max.Z : Item.LocalBounds.Min.Z);
+			Corners[Corner] = Item.Current.TransformPosition(LocalCorner);
+		}
+		for (const auto& Edge : Edges)
+		{
+			LineBatcher->DrawLine(Corners[Edge[0]], Corners[Edge[1]], GhostColor, SDPG_World, 1.0f, 0.0f,
+			                      GHOST_DUPLICATE_BATCH_ID);
+		}
+	}
+}
+
+void FGhostDuplicateTransformHandler::ClearGhosts()
+{
+	if (LineBatcher)
+	{
+		LineBatcher->ClearBatch(GHOST_DUPLICATE_BATCH_ID);
+		LineBatcher = nullptr;
+	}
+}
@@ -0,0 +1,164 @@
+#include "FHoverPickPrefetcher.h"
+#include "Blend4RealSettings.h"
+#include "FScenePicker.h"
+#include "FMeshBVHPicker.h"
+#include "EditorViewportClient.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Scene content can change without the cursor or camera moving (undo, actors moved from the details panel...),
+	// so cached picks expire and are traced again after this delay.
+	constexpr double MaxCachedPickAge = 0.25;
+
+	// Traces not completed within this delay are dropped (e.g. the world stopped ticking)
+	constexpr double MaxPendingTraceAge = 1.0;
+}
+
+FHoverPickPrefetcher::FPickKey FHoverPickPrefetcher::MakeKey(const Blend4RealUtils::FScreenRay& Ray)
+{
+	FPickKey Key;
+	Key.ViewportClient = Ray.ViewportClient;
+	Key.Pixel = Ray.Pixel;
+	Key.ViewHash = Ray.ViewHash;
+	return Key;
+}
+
+void FHoverPickPrefetcher::Tick(const FVector2D& MousePosition)
+{
+	if (!UBlend4RealSettings::Get()->bPrefetchHoverPick)
+	{
+		Invalidate();
+		return;
+	}
+
+	CollectPendingTrace();
+
+	// One trace at a time, results of the previous one are needed before issuing another
+	if (PendingTrace.IsValid())
+	{
+		return;
+	}
+
+	Blend4RealUtils::FScreenRay Ray;
+	if (!Blend4RealUtils::ComputeScreenRay(MousePosition, Ray))
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const FPickKey Key = MakeKey(Ray);
+	if (bHasCachedPick && Key == CachedKey && Now - CachedTime < MaxCachedPickAge)
+	{
+		return;
+	}
+
+	UWorld* World = Ray.ViewportClient->GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	// Same query as Blend4RealUtils::ScenePickAtPosition, as a single complex trace since it doesn't block
+	FCollisionQueryParams Params;
+	Params.bTraceComplex = true;
+	const float TraceLength = FScenePicker::ComputeTraceLength(World, Ray.Origin, Ray.Direction, Ray.MaxDistance);
+	const FVector End = Ray.Origin + Ray.Direction * TraceLength;
+	PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Ray.Origin, End, ECC_Camera, Params);
+	PendingKey = Key;
+	PendingWorld = World;
+	PendingOrigin = Ray.Origin;
+	PendingDirection = Ray.Direction;
+	PendingLength = TraceLength;
+	PendingIssueTime = Now;
+}
+
+void FHoverPickPrefetcher::CollectPendingTrace()
+{
+	if (!PendingTrace.IsValid())
+	{
+		return;
+	}
+
+	UWorld* World = PendingWorld.Get();
+	if (!World)
+	{
+		PendingTrace = FTraceHandle();
+		return;
+	}
+
+	FTraceDatum Datum;
+	if (World->QueryTraceData(PendingTrace, Datum))
+	{
+		bHasCachedPick = true;
+		CachedKey = PendingKey;
+		CachedHit = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+		if (UBlend4RealSettings::Get()->bPickMeshesWithoutCollision)
+		{
+			FMeshBVHPicker::Trace(World, PendingOrigin, PendingDirection, FCollisionQueryParams(), PendingLength,
+			                      CachedHit);
+		}
+		CachedWorld = World;
+		CachedTime = FPlatformTime::Seconds();
+		PendingTrace = FTraceHandle();
+		PrebuildSnapTree(CachedHit);
+	}
+	else if (FPlatformTime::Seconds() - PendingIssueTime > MaxPendingTraceAge)
+	{
+		PendingTrace = FTraceHandle();
+	}
+}
+
+void FHoverPickPrefetcher::PrebuildSnapTree(const FHitResult& Hit)
+{
+	const EBlend4RealSnapElement SnapElement = UBlend4RealSettings::Get()->SnapElement;
+	if (SnapElement != EBlend4RealSnapElement::Vertex && SnapElement != EBlend4RealSnapElement::Edge
+		&& SnapElement != EBlend4RealSnapElement::VertexAndEdge)
+	{
+		return;
+	}
+
+	// Instances aren't searched by the element snapper
+	const UStaticMeshComponent* Component = Cast<UStaticMeshComponent>(Hit.GetComponent());
+	if (Component && Component->GetStaticMesh() && !Component->IsA<UInstancedStaticMeshComponent>())
+	{
+		FMeshBVHPicker::FindOrBuildVertexTree(Component->GetStaticMesh());
+	}
+}
+
+FHitResult FHoverPickPrefetcher::PickAtPosition(const FVector2D& MousePosition, FVector& OutRayOrigin,
+                                                FVector& OutRayDirection)
+{
+	Blend4RealUtils::FScreenRay Ray;
+	if (!Blend4RealUtils::ComputeScreenRay(MousePosition, Ray))
+	{
+		return FHitResult();
+	}
+
+	OutRayOrigin = Ray.Origin;
+	OutRayDirection = Ray.Direction;
+
+	// The trace may have completed since the last tick
+	CollectPendingTrace();
+
+	UWorld* World = Ray.ViewportClient->GetWorld();
+	if (bHasCachedPick && CachedKey == MakeKey(Ray) && CachedWorld.Get() == World
+		&& FPlatformTime::Seconds() - CachedTime < MaxCachedPickAge)
+	{
+		return CachedHit;
+	}
+
+	FCollisionQueryParams Params;
+	Params.bTraceComplex = true;
+	return Blend4RealUtils::ProjectToSurface(World, OutRayOrigin, OutRayDirection, Params, Ray.MaxDistance);
+}
+
+void FHoverPickPrefetcher::Invalidate()
+{
+	bHasCachedPick = false;
+	CachedWorld.Reset();
+	PendingTrace = FTraceHandle();
+	PendingWorld.Reset();
+}
@@ -0,0 +1,353 @@
+#include "FInstanceTransformHandler.h"
+#include "Blend4RealUtils.h"
+#include "FActorBoundsTree.h"
+#include "Editor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+namespace
+{
+	// Unselected instances between two selected ones rewritten within a run, beyond it the run is split
+	constexpr int32 MaxWriteRunGap = 16;
+}
+
+void FInstanceWriteRuns::Capture(const UInstancedStaticMeshComponent* Component, const TArray<int32>& SortedIndices,
+                                 TArray<FTransform>* OutTransforms)
+{
+	Runs.Reset();
+	if (OutTransforms)
+	{
+		OutTransforms->SetNum(SortedIndices.Num());
+	}
+	if (!Component)
+	{
+		return;
+	}
+
+	for (int32 Item = 0; Item < SortedIndices.Num(); ++Item)
+	{
+		const int32 Index = SortedIndices[Item];
+		if (Runs.Num() == 0 || Index - Runs.Last().GetEndIndex() > MaxWriteRunGap)
+		{
+			Runs.AddDefaulted_GetRef().StartIndex = Index;
+		}
+
+		FRun& Run = Runs.Last();
+		while (Run.GetEndIndex() <= Index)
+		{
+			Component->GetInstanceTransform(Run.GetEndIndex(), Run.Transforms.AddDefaulted_GetRef(), true);
+		}
+		if (OutTransforms)
+		{
+			(*OutTransforms)[Item] = Run.Transforms[Index - Run.StartIndex];
+		}
+	}
+}
+
+void FInstanceWriteRuns::Write(UInstancedStaticMeshComponent* Component, const TArray<int32>& SortedIndices,
+                               const TArray<FTransform>& Transforms)
+{
+	if (!Component || Runs.Num() == 0)
+	{
+		return;
+	}
+
+	int32 RunIndex = 0;
+	for (int32 Item = 0; Item < SortedIndices.Num(); ++Item)
+	{
+		const int32 Index = SortedIndices[Item];
+		while (Index >= Runs[RunIndex].GetEndIndex())
+		{
+			++RunIndex;
+		}
+		Runs[RunIndex].Transforms[Index - Runs[RunIndex].StartIndex] = Transforms[Item];
+	}
+
+	// The render state is marked dirty once, with the last run
+	for (int32 Run = 0; Run < Runs.Num(); ++Run)
+	{
+		Component->BatchUpdateInstancesTransforms(Runs[Run].StartIndex, Runs[Run].Transforms, true,
+		                                          Run == Runs.Num() - 1, true);
+	}
+}
+
+FInstanceTransformHandler::FInstanceTransformHandler(
+	const TMap<UInstancedStaticMeshComponent*, TArray<int32>>& InInstances)
+{
+	SetInstances(InInstances);
+}
+
+FInstanceTransformHandler::FInstanceTransformHandler(const int32 InNumInstances, FAddInstances InAddInstances,
+                                                     const FText& InDescription)
+	: NumInstances(InNumInstances)
+	  , AddInstances(MoveTemp(InAddInstances))
+	  , AddInstancesDescription(InDescription)
+{
+}
+
+void FInstanceTransformHandler::SetInstances(const TMap<UInstancedStaticMeshComponent*, TArray<int32>>& InInstances)
+{
+	Components.Reset();
+	NumInstances = 0;
+	for (const TPair<UInstancedStaticMeshComponent*, TArray<int32>>& Pair : InInstances)
+	{
+		if (!Pair.Key || Pair.Value.Num() == 0)
+		{
+			continue;
+		}
+
+		FComponentInstances& Instances = Components.AddDefaulted_GetRef();
+		Instances.Component = Pair.Key;
+		Instances.Indices = Pair.Value;
+		Instances.Indices.Sort();
+		Instances.FirstItemId = NumInstances;
+		NumInstances += Instances.Indices.Num();
+	}
+}
+
+bool FInstanceTransformHandler::HasSelection() const
+{
+	return NumInstances > 0;
+}
+
+int32 FInstanceTransformHandler::GetSelectionCount() const
+{
+	return NumInstances;
+}
+
+FTransform FInstanceTransformHandler::ComputeSelectionPivot() const
+{
+	FTransform Pivot;
+	if (Blend4RealUtils::HasCustomPivot())
+	{
+		Pivot.SetLocation(Blend4RealUtils::GetCustomPivot());
+		return Pivot;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const FComponentInstances& Instances : Components)
+	{
+		for (const FTransform& Transform : Instances.Initial)
+		{
+			Center += Transform.GetLocation();
+		}
+	}
+	if (NumInstances > 0)
+	{
+		Pivot.SetLocation(Center / NumInstances);
+	}
+	return Pivot;
+}
+
+FTransform FInstanceTransformHandler::GetFirstSelectedItemTransform() const
+{
+	return Components.Num() > 0 && Components[0].Initial.Num() > 0 ? Components[0].Initial[0] : FTransform::Identity;
+}
+
+FVector FInstanceTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
+{
+	FVector AccumulatedAxis = FVector::ZeroVector;
+	for (const FComponentInstances& Instances : Components)
+	{
+		for (const FTransform& Transform : Instances.Initial)
+		{
+			const FQuat Rotation = Transform.GetRotation();
+			AccumulatedAxis += Axis == EAxis::X
+				                   ? Rotation.GetForwardVector()
+				                   : Axis == EAxis::Y
+				                   ? Rotation.GetRightVector()
+				                   : Rotation.GetUpVector();
+		}
+	}
+	return NumInstances > 0 ? (AccumulatedAxis / NumInstances).GetSafeNormal() : FVector::ZeroVector;
+}
+
+void FInstanceTransformHandler::CaptureInitialState()
+{
+	for (FComponentInstances& Instances : Components)
+	{
+		Instances.WriteRuns.Capture(Instances.Component.Get(), Instances.Indices, &Instances.Initial);
+		Instances.Current = Instances.Initial;
+		Instances.bDirty = false;
+	}
+}
+
+void FInstanceTransformHandler::RestoreInitialState()
+{
+	for (FComponentInstances& Instances : Components)
+	{
+		Instances.Current = Instances.Initial;
+		WriteInstances(Instances);
+	}
+}
+
+void FInstanceTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
+                                                          const FTransform& NewPivotTransform)
+{
+	const FTransform InitialPivotInverse = InitialPivot.Inverse();
+	for (FComponentInstances& Instances : Components)
+	{
+		for (int32 Item = 0; Item < Instances.Indices.Num(); ++Item)
+		{
+			const FTransform InstanceTransform = Instances.Initial[Item] * InitialPivotInverse * NewPivotTransform;
+			if (!InstanceTransform.ContainsNaN())
+			{
+				Instances.Current[Item] = InstanceTransform;
+			}
+		}
+		Instances.bDirty = true;
+	}
+}
+
+void FInstanceTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation,
+                                                   const FVector* Scale)
+{
+	for (FComponentInstances& Instances : Components)
+	{
+		// Reset Transform doesn't begin a transform session
+		if (Instances.Current.Num() != Instances.Indices.Num())
+		{
+			CaptureInitialState();
+		}
+		for (FTransform& Transform : Instances.Current)
+		{
+			if (Location)
+			{
+				Transform.SetLocation(*Location);
+			}
+			if (Rotation)
+			{
+				Transform.SetRotation(Rotation->Quaternion());
+			}
+			if (Scale)
+			{
+				Transform.SetScale3D(*Scale);
+			}
+		}
+		Instances.bDirty = true;
+	}
+}
+
+bool FInstanceTransformHandler::GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset();
+	OutTransforms.Reserve(NumInstances);
+	for (const FComponentInstances& Instances : Components)
+	{
+		for (int32 Item = 0; Item < Instances.Initial.Num(); ++Item)
+		{
+			OutTransforms.Add(Instances.FirstItemId + Item, Instances.Initial[Item]);
+		}
+	}
+	return true;
+}
+
+void FInstanceTransformHandler::SetItemTransforms(const TMap<uint32, FTransform>& Transforms)
+{
+	if (Transforms.Num() == 0)
+	{
+		return;
+	}
+
+	for (FComponentInstances& Instances : Components)
+	{
+		for (int32 Item = 0; Item < Instances.Current.Num(); ++Item)
+		{
+			const FTransform* InstanceTransform = Transforms.Find(Instances.FirstItemId + Item);
+			if (InstanceTransform && !InstanceTransform->ContainsNaN())
+			{
+				Instances.Current[Item] = *InstanceTransform;
+				Instances.bDirty = true;
+			}
+		}
+	}
+}
+
+void FInstanceTransformHandler::GetMovedInstances(
+	TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const
+{
+	for (const FComponentInstances& Instances : Components)
+	{
+		if (UInstancedStaticMeshComponent* Component = Instances.Component.Get())
+		{
+			OutInstances.FindOrAdd(Component).Append(Instances.Indices);
+		}
+	}
+}
+
+void FInstanceTransformHandler::FlushDeferredUpdates()
+{
+	for (FComponentInstances& Instances : Components)
+	{
+		if (Instances.bDirty)
+		{
+			WriteInstances(Instances);
+		}
+	}
+}
+
+int32 FInstanceTransformHandler::BeginTransaction(const FText& Description)
+{
+	if (!GEditor)
+	{
+		return -1;
+	}
+
+	// Added instances are part of the transaction, named after the action rather than the transform mode
+	const int32 TransactionIndex = GEditor->BeginTransaction(
+		TEXT(""), AddInstances ? AddInstancesDescription : Description, nullptr);
+	if (AddInstances)
+	{
+		SetInstances(AddInstances());
+		AddInstances = nullptr;
+		bAddedInstances = true;
+	}
+
+	for (const FComponentInstances& Instances : Components)
+	{
+		if (UInstancedStaticMeshComponent* Component = Instances.Component.Get())
+		{
+			Component->Modify();
+		}
+	}
+	return TransactionIndex;
+}
+
+void FInstanceTransformHandler::EndTransaction()
+{
+	FlushDeferredUpdates();
+	// Moving instances changes the bounds of the owning actors without an OnActorMoved broadcast
+	for (const FComponentInstances& Instances : Components)
+	{
+		if (const UInstancedStaticMeshComponent* Component = Instances.Component.Get())
+		{
+			FActorBoundsTree::MarkActorDirty(Component->GetOwner());
+		}
+	}
+	if (GEditor)
+	{
+		GEditor->EndTransaction();
+	}
+}
+
+void FInstanceTransformHandler::CancelTransaction(int32 TransactionIndex)
+{
+	if (!GEditor || TransactionIndex < 0)
+	{
+		return;
+	}
+
+	if (bAddedInstances)
+	{
+		// Cancelling would keep the added instances and the components created for them: undo them, without redo
+		GEditor->EndTransaction();
+		GEditor->UndoTransaction(false);
+		return;
+	}
+	GEditor->CancelTransaction(TransactionIndex);
+}
+
+void FInstanceTransformHandler::WriteInstances(FComponentInstances& Instances)
+{
+	Instances.bDirty = false;
+	Instances.WriteRuns.Write(Instances.Component.Get(), Instances.Indices, Instances.Current);
+}
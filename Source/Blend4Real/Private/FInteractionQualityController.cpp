@@ -0,0 +1,131 @@
+#include "FInteractionQualityController.h"
+#include "Blend4RealSettings.h"
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#include "Engine/Engine.h"
+
+#define LOCTEXT_NAMESPACE "FBlend4RealModule"
+
+namespace
+{
+	FText GetRealtimeOverrideName()
+	{
+		return LOCTEXT("InteractionQualityRealtimeOverride", "Blend4Real Interaction");
+	}
+}
+
+FInteractionQualityController::~FInteractionQualityController()
+{
+	End();
+}
+
+void FInteractionQualityController::Begin(FEditorViewportClient* ViewportClient, const TCHAR* OperationName)
+{
+	// Make sure a previous operation didn't leave the profile applied
+	End();
+
+	const FBlend4RealInteractionQuality& Profile = UBlend4RealSettings::Get()->InteractionQuality;
+	if (!Profile.bEnabled || !ViewportClient)
+	{
+		return;
+	}
+
+	AppliedViewportClient = ViewportClient;
+	CurrentOperationName = OperationName;
+
+	// Show flags
+	SavedShowFlags = ViewportClient->EngineShowFlags;
+	if (Profile.bDisableDynamicShadows)
+	{
+		ViewportClient->EngineShowFlags.SetDynamicShadows(false);
+	}
+	if (Profile.bDisableGlobalIllumination)
+	{
+		ViewportClient->EngineShowFlags.SetGlobalIllumination(false);
+	}
+	if (Profile.bDisableTranslucency)
+	{
+		ViewportClient->EngineShowFlags.SetTranslucency(false);
+	}
+	if (Profile.bDisablePostProcessing)
+	{
+		ViewportClient->EngineShowFlags.SetPostProcessing(false);
+	}
+
+	// Screen percentage
+	bScreenPercentageApplied = false;
+	if (Profile.ScreenPercentage < 100 && ViewportClient->SupportsPreviewResolutionFraction())
+	{
+		bSavedPreviewingScreenPercentage = ViewportClient->IsPreviewingScreenPercentage();
+		SavedScreenPercentage = ViewportClient->GetPreviewScreenPercentage();
+		ViewportClient->SetPreviewingScreenPercentage(true);
+		ViewportClient->SetPreviewScreenPercentage(Profile.ScreenPercentage);
+		bScreenPercentageApplied = true;
+	}
+
+	// Realtime
+	bRealtimeOverrideApplied = false;
+	if (Profile.bForceRealtime)
+	{
+		ViewportClient->AddRealtimeOverride(true, GetRealtimeOverrideName());
+		bRealtimeOverrideApplied = true;
+	}
+
+	// Frame rate before the interaction is the engine's running average
+	bReportFrameRate = Profile.bReportFrameRate;
+	if (bReportFrameRate)
+	{
+		FrameRateBefore = GAverageFPS;
+		StartFrameCounter = GFrameCounter;
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	ViewportClient->Invalidate();
+}
+
+void FInteractionQualityController::End()
+{
+	if (!AppliedViewportClient)
+	{
+		return;
+	}
+
+	FEditorViewportClient* ViewportClient = AppliedViewportClient;
+	AppliedViewportClient = nullptr;
+
+	// The viewport may have been closed during the operation
+	if (!GEditor || !GEditor->GetAllViewportClients().Contains(ViewportClient))
+	{
+		return;
+	}
+
+	if (bReportFrameRate)
+	{
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		const uint64 Frames = GFrameCounter - StartFrameCounter;
+		if (Elapsed > 0.0 && Frames > 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Blend4Real %s: %.1f FPS before, %.1f FPS during interaction (%llu frames)"),
+			       *CurrentOperationName, FrameRateBefore, Frames / Elapsed, Frames);
+		}
+	}
+
+	ViewportClient->EngineShowFlags = SavedShowFlags;
+
+	if (bScreenPercentageApplied)
+	{
+		ViewportClient->SetPreviewScreenPercentage(SavedScreenPercentage);
+		ViewportClient->SetPreviewingScreenPercentage(bSavedPreviewingScreenPercentage);
+		bScreenPercentageApplied = false;
+	}
+
+	if (bRealtimeOverrideApplied)
+	{
+		ViewportClient->RemoveRealtimeOverride(GetRealtimeOverrideName());
+		bRealtimeOverrideApplied = false;
+	}
+
+	ViewportClient->Invalidate();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,375 @@
+#include "FMeshBVHPicker.h"
+#include "Blend4RealUtils.h"
+#include "FActorBoundsTree.h"
+#include "FScenePicker.h"
+#include "FSelectionTraceFilter.h"
+#include "CollisionQueryParams.h"
+#include "DerivedDataCacheInterface.h"
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#include "EngineUtils.h"
+#include "SceneView.h"
+#include "StaticMeshResources.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectIterator.h"
+
+// Change when the BVH layout or build changes to invalidate the cached data
+#define MESH_BVH_DERIVEDDATA_VER TEXT("6F1C2B7E8A4D4C0B9E3F5A1D2C7B8E01")
+
+TMap<TObjectKey<UStaticMesh>, FMeshBVHPicker::FCachedMeshBVH> FMeshBVHPicker::MeshBVHs;
+TMap<TObjectKey<UStaticMesh>, TSharedPtr<const FMeshVertexKDTree>> FMeshBVHPicker::VertexTrees;
+FDelegateHandle FMeshBVHPicker::PostGarbageCollectHandle;
+
+void FMeshBVHPicker::Initialize()
+{
+	// Deleted components and unloaded maps only release their meshes on garbage collection
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(
+		&FMeshBVHPicker::EvictUnusedMeshes);
+}
+
+void FMeshBVHPicker::Shutdown()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	MeshBVHs.Reset();
+	VertexTrees.Reset();
+}
+
+void FMeshBVHPicker::EvictUnusedMeshes()
+{
+	if (MeshBVHs.Num() == 0)
+	{
+		return;
+	}
+
+	// Evicted BVHs are loaded back from the DDC if their mesh is used again
+	TSet<const UStaticMesh*> UsedMeshes;
+	for (TObjectIterator<UStaticMeshComponent> It(RF_ClassDefaultObject | RF_ArchetypeObject); It; ++It)
+	{
+		if (It->IsRegistered())
+		{
+			UsedMeshes.Add(It->GetStaticMesh());
+		}
+	}
+
+	for (auto It = MeshBVHs.CreateIterator(); It; ++It)
+	{
+		const UStaticMesh* Mesh = It.Key().ResolveObjectPtr();
+		if (!Mesh || !UsedMeshes.Contains(Mesh))
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = VertexTrees.CreateIterator(); It; ++It)
+	{
+		if (!MeshBVHs.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool FMeshBVHPicker::NeedsBVHPicking(const UStaticMeshComponent* Component)
+{
+	// Instanced components need a per instance transform, not supported
+	if (!Component || !Component->GetStaticMesh() || Component->IsA<UInstancedStaticMeshComponent>())
+	{
+		return false;
+	}
+	const FBodyInstance* BodyInstance = Component->GetBodyInstance();
+	return !Component->IsQueryCollisionEnabled() || !BodyInstance || !BodyInstance->IsValidBodyInstance();
+}
+
+TSharedPtr<const FMeshTriangleBVH> FMeshBVHPicker::FindOrBuildBVH(const UStaticMesh* Mesh)
+{
+	const FStaticMeshRenderData* RenderData = Mesh ? Mesh->GetRenderData() : nullptr;
+	if (!RenderData || RenderData->LODResources.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const FString& SourceKey = RenderData->DerivedDataKey;
+	if (const FCachedMeshBVH* Cached = MeshBVHs.Find(Mesh))
+	{
+		if (Cached->SourceKey == SourceKey)
+		{
+			return Cached->BVH;
+		}
+	}
+
+	const TSharedRef<FMeshTriangleBVH> BVH = MakeShared<FMeshTriangleBVH>();
+	const FString CacheKey = SourceKey.IsEmpty()
+		                         ? FString()
+		                         : FDerivedDataCacheInterface::BuildCacheKey(
+			                         TEXT("BLEND4REAL_MESHBVH"), MESH_BVH_DERIVEDDATA_VER, *SourceKey);
+
+	bool bLoaded = false;
+	if (!CacheKey.IsEmpty())
+	{
+		TArray<uint8> Data;
+		if (GetDerivedDataCacheRef().GetSynchronous(*CacheKey, Data, Mesh->GetPathName()))
+		{
+			FMemoryReader Reader(Data);
+			Reader << *BVH;
+			bLoaded = !Reader.IsError();
+		}
+	}
+
+	if (!bLoaded)
+	{
+		// The CPU copy of the render data is kept in the editor
+		const FStaticMeshLODResources& LOD = RenderData->LODResources[0];
+		const FPositionVertexBuffer& PositionBuffer = LOD.VertexBuffers.PositionVertexBuffer;
+		if (!PositionBuffer.GetVertexData() || PositionBuffer.GetNumVertices() == 0)
+		{
+			return nullptr;
+		}
+
+		TArray<FVector3f> Positions;
+		Positions.SetNumUninitialized(PositionBuffer.GetNumVertices());
+		for (uint32 Vertex = 0; Vertex < PositionBuffer.GetNumVertices(); ++Vertex)
+		{
+			Positions[Vertex] = PositionBuffer.VertexPosition(Vertex);
+		}
+		TArray<uint32> Indices;
+		LOD.IndexBuffer.GetCopy(Indices);
+
+		BVH->Build(MoveTemp(Positions), Indices);
+
+		if (!CacheKey.IsEmpty())
+		{
+			TArray<uint8> Data;
+			FMemoryWriter Writer(Data);
+			Writer << *BVH;
+			GetDerivedDataCacheRef().Put(*CacheKey, Data, Mesh->GetPathName());
+		}
+	}
+
+	FCachedMeshBVH& Cached = MeshBVHs.FindOrAdd(Mesh);
+	Cached.SourceKey = SourceKey;
+	Cached.BVH = BVH;
+	return Cached.BVH;
+}
+
+TSharedPtr<const FMeshVertexKDTree> FMeshBVHPicker::FindOrBuildVertexTree(const UStaticMesh* Mesh)
+{
+	const TSharedPtr<const FMeshTriangleBVH> BVH = FindOrBuildBVH(Mesh);
+	if (!BVH.IsValid())
+	{
+		return nullptr;
+	}
+
+	// A new BVH means the mesh was rebuilt
+	TSharedPtr<const FMeshVertexKDTree>& Tree = VertexTrees.FindOrAdd(Mesh);
+	if (!Tree.IsValid() || Tree->Mesh != BVH)
+	{
+		const TSharedRef<FMeshVertexKDTree> NewTree = MakeShared<FMeshVertexKDTree>();
+		NewTree->Build(BVH);
+		Tree = NewTree;
+	}
+	return Tree;
+}
+
+bool FMeshBVHPicker::TraceComponent(const UStaticMeshComponent* Component, const FVector& Start, const FVector& End,
+                                    FHitResult& InOutHit)
+{
+	const float MaxTime = InOutHit.bBlockingHit ? InOutHit.Time : 1.f;
+	if (!FMath::LineBoxIntersection(Component->Bounds.GetBox(), Start, End, End - Start))
+	{
+		return false;
+	}
+
+	const TSharedPtr<const FMeshTriangleBVH> BVH = FindOrBuildBVH(Component->GetStaticMesh());
+	if (!BVH.IsValid())
+	{
+		return false;
+	}
+
+	// Trace in mesh space, the ray parameter stays the same as in world space
+	const FTransform& ComponentTransform = Component->GetComponentTransform();
+	const FVector LocalStart = ComponentTransform.InverseTransformPosition(Start);
+	const FVector LocalEnd = ComponentTransform.InverseTransformPosition(End);
+	float Time = MaxTime;
+	int32 Triangle = INDEX_NONE;
+	if (!BVH->Raycast(FVector3f(LocalStart), FVector3f(LocalEnd - LocalStart), Time, Triangle))
+	{
+		return false;
+	}
+
+	// Normals are transformed by the inverse transpose to support non-uniform scale
+	const FVector TraceDirection = End - Start;
+	FVector Normal = ComponentTransform.ToInverseMatrixWithScale().GetTransposed()
+	                                   .TransformVector(FVector(BVH->GetTriangleNormal(Triangle))).GetSafeNormal();
+	if ((Normal | TraceDirection) > 0.f)
+	{
+		Normal = -Normal;
+	}
+
+	FHitResult Hit(const_cast<AActor*>(Component->GetOwner()), const_cast<UStaticMeshComponent*>(Component),
+	               Start + TraceDirection * Time, Normal);
+	Hit.bBlockingHit = true;
+	Hit.Time = Time;
+	Hit.Distance = TraceDirection.Size() * Time;
+	Hit.TraceStart = Start;
+	Hit.TraceEnd = End;
+	InOutHit = Hit;
+	return true;
+}
+
+bool FMeshBVHPicker::Trace(const UWorld* World, const FVector& Start, const FVector& Direction,
+                           const FCollisionQueryParams& Params, const float MaxDistance, FHitResult& InOutHit)
+{
+	FActorBoundsTree* Tree = World ? FActorBoundsTree::Get(World) : nullptr;
+	if (!Tree)
+	{
+		return false;
+	}
+
+	// Keep the physics hit if there is one, only a closer mesh can replace it
+	const FVector End = Start + Direction * MaxDistance;
+	FHitResult Hit;
+	if (InOutHit.bBlockingHit)
+	{
+		Hit = InOutHit;
+		Hit.Time = InOutHit.Distance / MaxDistance;
+	}
+
+	// Only the actors whose bounds the ray crosses before the closest hit so far are visited
+	bool bHit = false;
+	auto NodeFilter = [&Start, &End, &Hit](const FBox& Box)
+	{
+		const FVector ClippedEnd = Hit.bBlockingHit ? Start + (End - Start) * Hit.Time : End;
+		return FMath::LineBoxIntersection(Box, Start, ClippedEnd, ClippedEnd - Start);
+	};
+	Tree->Query(NodeFilter, [&](const int32 ProxyId)
+	{
+		const AActor* Owner = Tree->GetActor(ProxyId);
+		if (!Owner || Owner->IsHiddenEd())
+		{
+			return;
+		}
+		Owner->ForEachComponent<UStaticMeshComponent>(false, [&](const UStaticMeshComponent* Component)
+		{
+			if (NeedsBVHPicking(Component) && Component->IsRegistered() && Component->IsVisibleInEditor()
+				&& !FSelectionTraceFilter::IsIgnored(Component, Params))
+			{
+				bHit |= TraceComponent(Component, Start, End, Hit);
+			}
+		});
+	});
+
+	if (bHit)
+	{
+		InOutHit = Hit;
+	}
+	return bHit;
+}
+
+namespace
+{
+	/**
+	 * Measures rays per second of physics traces and mesh BVH traces through random pixels of the focused viewport.
+	 * The BVH path traces every static mesh component of the world, with or without collision.
+	 * Usage: Blend4Real.BenchmarkMeshBVH [NumRays]
+	 */
+	void BenchmarkMeshBVH(const TArray<FString>& Args)
+	{
+		FEditorViewportClient* ViewportClient = Blend4RealUtils::GetFocusedViewportClient();
+		if (!ViewportClient || !ViewportClient->Viewport || !ViewportClient->GetWorld())
+		{
+			UE_LOG(LogTemp, Display, TEXT("Blend4Real.BenchmarkMeshBVH: no viewport"));
+			return;
+		}
+
+		const int32 NumRays = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 100000) : 1000;
+		UWorld* World = ViewportClient->GetWorld();
+
+		FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+			ViewportClient->Viewport, ViewportClient->GetScene(), ViewportClient->EngineShowFlags));
+		const FSceneView* View = ViewportClient->CalcSceneView(&ViewFamily);
+		if (!View)
+		{
+			return;
+		}
+
+		TArray<const UStaticMeshComponent*> Components;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			It->ForEachComponent<UStaticMeshComponent>(false, [&Components](const UStaticMeshComponent* Component)
+			{
+				if (Component->GetStaticMesh() && !Component->IsA<UInstancedStaticMeshComponent>())
+				{
+					Components.Add(Component);
+				}
+			});
+		}
+
+		// Build outside of the measurement
+		SIZE_T BVHMemory = 0;
+		TSet<const UStaticMesh*> Meshes;
+		for (const UStaticMeshComponent* Component : Components)
+		{
+			bool bAlreadyInSet;
+			Meshes.Add(Component->GetStaticMesh(), &bAlreadyInSet);
+			if (!bAlreadyInSet)
+			{
+				if (const TSharedPtr<const FMeshTriangleBVH> BVH = FMeshBVHPicker::FindOrBuildBVH(Component->GetStaticMesh()))
+				{
+					BVHMemory += BVH->GetAllocatedSize();
+				}
+			}
+		}
+
+		const FIntPoint Size = ViewportClient->Viewport->GetSizeXY();
+		FRandomStream Random(NumRays);
+		TArray<TPair<FVector, FVector>> Rays;
+		for (int32 Ray = 0; Ray < NumRays; ++Ray)
+		{
+			FVector Origin, Direction;
+			View->DeprojectFVector2D(FVector2D(Random.FRand() * Size.X, Random.FRand() * Size.Y), Origin, Direction);
+			Rays.Emplace(Origin, Direction);
+		}
+
+		FCollisionQueryParams Params;
+		Params.bTraceComplex = true;
+		int32 PhysicsHits = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Ray : Rays)
+		{
+			PhysicsHits += FScenePicker::TraceComplex(World, Ray.Key, Ray.Value, Params,
+			                                          Blend4RealUtils::ScenePickDistance).bBlockingHit ? 1 : 0;
+		}
+		const double PhysicsTime = FPlatformTime::Seconds() - StartTime;
+
+		int32 BVHHits = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Ray : Rays)
+		{
+			const FVector End = Ray.Key + Ray.Value * Blend4RealUtils::ScenePickDistance;
+			FHitResult Hit;
+			for (const UStaticMeshComponent* Component : Components)
+			{
+				FMeshBVHPicker::TraceComponent(Component, Ray.Key, End, Hit);
+			}
+			BVHHits += Hit.bBlockingHit ? 1 : 0;
+		}
+		const double BVHTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display,
+		       TEXT("Blend4Real.BenchmarkMeshBVH: %d rays, %d components, %d meshes (%.1f MB of BVH)"),
+		       NumRays, Components.Num(), Meshes.Num(), BVHMemory / (1024.0 * 1024.0));
+		UE_LOG(LogTemp, Display, TEXT("  Physics: %.0f rays/s, %d hits"), NumRays / FMath::Max(PhysicsTime, 1e-9),
+		       PhysicsHits);
+		UE_LOG(LogTemp, Display, TEXT("  Mesh BVH: %.0f rays/s, %d hits"), NumRays / FMath::Max(BVHTime, 1e-9),
+		       BVHHits);
+	}
+
+	FAutoConsoleCommand BenchmarkMeshBVHCommand(
+		TEXT("Blend4Real.BenchmarkMeshBVH"),
+		TEXT("Compare rays per second of physics traces and mesh BVH traces in the focused viewport. Args: [NumRays]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMeshBVH));
+}
@@ -0,0 +1,241 @@
+#include "FMeshTriangleBVH.h"
+
+namespace
+{
+	constexpr int32 MaxLeafTriangles = 4;
+	constexpr int32 MaxDepth = 48;
+	constexpr int32 TraversalStackSize = 64;
+
+	/** Slab test, returns the entry distance of the ray in OutTMin */
+	FORCEINLINE bool IntersectBox(const FVector3f& Min, const FVector3f& Max, const FVector3f& Origin,
+	                              const FVector3f& InvDirection, const float MaxT, float& OutTMin)
+	{
+		const FVector3f T1 = (Min - Origin) * InvDirection;
+		const FVector3f T2 = (Max - Origin) * InvDirection;
+		const float TMin = FMath::Max3(FMath::Min(T1.X, T2.X), FMath::Min(T1.Y, T2.Y), FMath::Min(T1.Z, T2.Z));
+		const float TMax = FMath::Min3(FMath::Max(T1.X, T2.X), FMath::Max(T1.Y, T2.Y), FMath::Max(T1.Z, T2.Z));
+		OutTMin = FMath::Max(TMin, 0.f);
+		return TMax >= OutTMin && TMin <= MaxT;
+	}
+
+	/** Moller-Trumbore, two sided */
+	FORCEINLINE bool IntersectTriangle(const FVector3f& Origin, const FVector3f& Direction, const FVector3f& P0,
+	                                   const FVector3f& P1, const FVector3f& P2, float& OutT)
+	{
+		const FVector3f Edge1 = P1 - P0;
+		const FVector3f Edge2 = P2 - P0;
+		const FVector3f PVec = Direction ^ Edge2;
+		const float Det = Edge1 | PVec;
+		if (Det == 0.f)
+		{
+			return false;
+		}
+		const float InvDet = 1.f / Det;
+		const FVector3f TVec = Origin - P0;
+		const float U = (TVec | PVec) * InvDet;
+		if (U < 0.f || U > 1.f)
+		{
+			return false;
+		}
+		const FVector3f QVec = TVec ^ Edge1;
+		const float V = (Direction | QVec) * InvDet;
+		if (V < 0.f || U + V > 1.f)
+		{
+			return false;
+		}
+		OutT = (Edge2 | QVec) * InvDet;
+		return OutT >= 0.f;
+	}
+
+	FORCEINLINE float SafeInverse(const float Value)
+	{
+		return Value != 0.f ? 1.f / Value : UE_BIG_NUMBER;
+	}
+}
+
+void FMeshTriangleBVH::Build(TArray<FVector3f>&& InPositions, const TArray<uint32>& InIndices)
+{
+	Positions = MoveTemp(InPositions);
+	Indices.Reset();
+	Nodes.Reset();
+
+	const int32 NumTriangles = InIndices.Num() / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	TArray<int32> TriangleOrder;
+	TArray<FVector3f> Centroids;
+	TriangleOrder.SetNumUninitialized(NumTriangles);
+	Centroids.SetNumUninitialized(NumTriangles);
+	for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+	{
+		TriangleOrder[Triangle] = Triangle;
+		Centroids[Triangle] = (Positions[InIndices[Triangle * 3]] + Positions[InIndices[Triangle * 3 + 1]]
+			+ Positions[InIndices[Triangle * 3 + 2]]) / 3.f;
+	}
+
+	Nodes.Reserve(2 * NumTriangles / MaxLeafTriangles + 1);
+	BuildNode(TriangleOrder, Centroids, InIndices, 0, NumTriangles, 0);
+	Nodes.Shrink();
+
+	// Store triangles in leaf order so leaves reference contiguous ranges
+	Indices.SetNumUninitialized(NumTriangles * 3);
+	for (int32 Index = 0; Index < NumTriangles; ++Index)
+	{
+		const int32 Triangle = TriangleOrder[Index];
+		Indices[Index * 3] = InIndices[Triangle * 3];
+		Indices[Index * 3 + 1] = InIndices[Triangle * 3 + 1];
+		Indices[Index * 3 + 2] = InIndices[Triangle * 3 + 2];
+	}
+}
+
+int32 FMeshTriangleBVH::BuildNode(TArray<int32>& TriangleOrder, const TArray<FVector3f>& Centroids,
+                                  const TArray<uint32>& SourceIndices, const int32 Begin, const int32 End,
+                                  const int32 Depth)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox3f Bounds(ForceInit);
+	FBox3f CentroidBounds(ForceInit);
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		const int32 Triangle = TriangleOrder[Index];
+		Bounds += Positions[SourceIndices[Triangle * 3]];
+		Bounds += Positions[SourceIndices[Triangle * 3 + 1]];
+		Bounds += Positions[SourceIndices[Triangle * 3 + 2]];
+		CentroidBounds += Centroids[Triangle];
+	}
+
+	const int32 Count = End - Begin;
+	const FVector3f CentroidExtent = CentroidBounds.GetSize();
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z
+		                   ? 0
+		                   : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+
+	if (Count <= MaxLeafTriangles || Depth >= MaxDepth || CentroidExtent[Axis] <= UE_KINDA_SMALL_NUMBER)
+	{
+		FNode& Leaf = Nodes[NodeIndex];
+		Leaf.Min = Bounds.Min;
+		Leaf.Max = Bounds.Max;
+		Leaf.Offset = Begin;
+		Leaf.Count = Count;
+		return NodeIndex;
+	}
+
+	// Median split along the largest centroid axis
+	MakeArrayView(TriangleOrder.GetData() + Begin, Count).Sort([&Centroids, Axis](const int32 A, const int32 B)
+	{
+		return Centroids[A][Axis] < Centroids[B][Axis];
+	});
+	const int32 Middle = Begin + Count / 2;
+
+	BuildNode(TriangleOrder, Centroids, SourceIndices, Begin, Middle, Depth + 1);
+	const int32 SecondChild = BuildNode(TriangleOrder, Centroids, SourceIndices, Middle, End, Depth + 1);
+
+	FNode& Node = Nodes[NodeIndex];
+	Node.Min = Bounds.Min;
+	Node.Max = Bounds.Max;
+	Node.Offset = SecondChild;
+	Node.Count = 0;
+	return NodeIndex;
+}
+
+bool FMeshTriangleBVH::Raycast(const FVector3f& Origin, const FVector3f& Direction, float& InOutT,
+                               int32& OutTriangle) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector3f InvDirection(SafeInverse(Direction.X), SafeInverse(Direction.Y), SafeInverse(Direction.Z));
+
+	float EntryT;
+	if (!IntersectBox(Nodes[0].Min, Nodes[0].Max, Origin, InvDirection, InOutT, EntryT))
+	{
+		return false;
+	}
+
+	int32 Stack[TraversalStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+	bool bHit = false;
+
+	while (StackSize > 0)
+	{
+		const int32 NodeIndex = Stack[--StackSize];
+		const FNode& Node = Nodes[NodeIndex];
+
+		if (Node.Count > 0)
+		{
+			for (uint32 Triangle = Node.Offset; Triangle < Node.Offset + Node.Count; ++Triangle)
+			{
+				float T;
+				if (IntersectTriangle(Origin, Direction, Positions[Indices[Triangle * 3]],
+				                      Positions[Indices[Triangle * 3 + 1]], Positions[Indices[Triangle * 3 + 2]], T)
+					&& T < InOutT)
+				{
+					InOutT = T;
+					OutTriangle = Triangle;
+					bHit = true;
+				}
+			}
+			continue;
+		}
+
+		// Visit the nearest child first so farther ones can be culled by the closest hit
+		const int32 FirstChild = NodeIndex + 1;
+		const int32 SecondChild = Node.Offset;
+		float FirstT, SecondT;
+		const bool bFirst = IntersectBox(Nodes[FirstChild].Min, Nodes[FirstChild].Max, Origin, InvDirection, InOutT,
+		                                 FirstT);
+		const bool bSecond = IntersectBox(Nodes[SecondChild].Min, Nodes[SecondChild].Max, Origin, InvDirection,
+		                                  InOutT, SecondT);
+		if (StackSize + 2 > TraversalStackSize)
+		{
+			continue;
+		}
+		if (bFirst && bSecond)
+		{
+			Stack[StackSize++] = FirstT <= SecondT ? SecondChild : FirstChild;
+			Stack[StackSize++] = FirstT <= SecondT ? FirstChild : SecondChild;
+		}
+		else if (bFirst)
+		{
+			Stack[StackSize++] = FirstChild;
+		}
+		else if (bSecond)
+		{
+			Stack[StackSize++] = SecondChild;
+		}
+	}
+
+	return bHit;
+}
+
+FVector3f FMeshTriangleBVH::GetTriangleNormal(const int32 Triangle) const
+{
+	const FVector3f& P0 = Positions[Indices[Triangle * 3]];
+	const FVector3f& P1 = Positions[Indices[Triangle * 3 + 1]];
+	const FVector3f& P2 = Positions[Indices[Triangle * 3 + 2]];
+	return ((P2 - P0) ^ (P1 - P0)).GetSafeNormal();
+}
+
+FArchive& operator<<(FArchive& Ar, FMeshTriangleBVH::FNode& Node)
+{
+	Ar << Node.Min;
+	Ar << Node.Offset;
+	Ar << Node.Max;
+	Ar << Node.Count;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FMeshTriangleBVH& BVH)
+{
+	Ar << BVH.Positions;
+	Ar << BVH.Indices;
+	Ar << BVH.Nodes;
+	return Ar;
+}
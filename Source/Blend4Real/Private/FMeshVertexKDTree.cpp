@@ -0,0 +1,150 @@
+#include "FMeshVertexKDTree.h"
+#include "Algo/Unique.h"
+
+namespace
+{
+	constexpr int32 MaxLeafVertices = 8;
+	constexpr int32 MaxDepth = 48;
+	constexpr int32 TraversalStackSize = 64;
+}
+
+void FMeshVertexKDTree::Build(const TSharedPtr<const FMeshTriangleBVH>& InMesh)
+{
+	Mesh = InMesh;
+	VertexOrder.Reset();
+	Nodes.Reset();
+	EdgeOffsets.Reset();
+	EdgeNeighbors.Reset();
+	if (!Mesh.IsValid() || Mesh->Positions.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 NumVertices = Mesh->Positions.Num();
+	VertexOrder.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		VertexOrder[Vertex] = Vertex;
+	}
+	Nodes.Reserve(2 * NumVertices / MaxLeafVertices + 1);
+	BuildNode(0, NumVertices, 0);
+	Nodes.Shrink();
+
+	// Unique undirected edges, packed as (min << 32 | max)
+	TArray<uint64> Edges;
+	Edges.Reserve(Mesh->Indices.Num());
+	for (int32 Triangle = 0; Triangle < Mesh->GetNumTriangles(); ++Triangle)
+	{
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const uint32 A = Mesh->Indices[Triangle * 3 + Corner];
+			const uint32 B = Mesh->Indices[Triangle * 3 + (Corner + 1) % 3];
+			if (A != B)
+			{
+				Edges.Add(static_cast<uint64>(FMath::Min(A, B)) << 32 | FMath::Max(A, B));
+			}
+		}
+	}
+	Edges.Sort();
+	Edges.SetNum(Algo::Unique(Edges));
+
+	// Both directions in compressed rows
+	EdgeOffsets.SetNumZeroed(NumVertices + 1);
+	for (const uint64 Edge : Edges)
+	{
+		++EdgeOffsets[(Edge >> 32) + 1];
+		++EdgeOffsets[(Edge & 0xFFFFFFFF) + 1];
+	}
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		EdgeOffsets[Vertex + 1] += EdgeOffsets[Vertex];
+	}
+	EdgeNeighbors.SetNumUninitialized(Edges.Num() * 2);
+	TArray<uint32> Cursor(EdgeOffsets.GetData(), NumVertices);
+	for (const uint64 Edge : Edges)
+	{
+		const uint32 A = static_cast<uint32>(Edge >> 32);
+		const uint32 B = static_cast<uint32>(Edge & 0xFFFFFFFF);
+		EdgeNeighbors[Cursor[A]++] = B;
+		EdgeNeighbors[Cursor[B]++] = A;
+	}
+}
+
+int32 FMeshVertexKDTree::BuildNode(const int32 Begin, const int32 End, const int32 Depth)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox3f Bounds(ForceInit);
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		Bounds += Mesh->Positions[VertexOrder[Index]];
+	}
+
+	const int32 Count = End - Begin;
+	const FVector3f Extent = Bounds.GetSize();
+	const int32 Axis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? 0 : (Extent.Y >= Extent.Z ? 1 : 2);
+
+	if (Count <= MaxLeafVertices || Depth >= MaxDepth || Extent[Axis] <= UE_KINDA_SMALL_NUMBER)
+	{
+		FNode& Leaf = Nodes[NodeIndex];
+		Leaf.Min = Bounds.Min;
+		Leaf.Max = Bounds.Max;
+		Leaf.Offset = Begin;
+		Leaf.Count = Count;
+		return NodeIndex;
+	}
+
+	// Median split along the largest axis
+	const TArray<FVector3f>& Positions = Mesh->Positions;
+	MakeArrayView(VertexOrder.GetData() + Begin, Count).Sort([&Positions, Axis](const uint32 A, const uint32 B)
+	{
+		return Positions[A][Axis] < Positions[B][Axis];
+	});
+	const int32 Middle = Begin + Count / 2;
+
+	BuildNode(Begin, Middle, Depth + 1);
+	const int32 SecondChild = BuildNode(Middle, End, Depth + 1);
+
+	FNode& Node = Nodes[NodeIndex];
+	Node.Min = Bounds.Min;
+	Node.Max = Bounds.Max;
+	Node.Offset = SecondChild;
+	Node.Count = 0;
+	return NodeIndex;
+}
+
+void FMeshVertexKDTree::ForEachVertex(TFunctionRef<bool(const FVector3f& Min, const FVector3f& Max)> NodeFilter,
+                                      TFunctionRef<void(uint32 Vertex)> Visit) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	int32 Stack[TraversalStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+
+	while (StackSize > 0)
+	{
+		const int32 NodeIndex = Stack[--StackSize];
+		const FNode& Node = Nodes[NodeIndex];
+		if (!NodeFilter(Node.Min, Node.Max))
+		{
+			continue;
+		}
+
+		if (Node.Count > 0)
+		{
+			for (uint32 Index = Node.Offset; Index < Node.Offset + Node.Count; ++Index)
+			{
+				Visit(VertexOrder[Index]);
+			}
+		}
+		else if (StackSize + 2 <= TraversalStackSize)
+		{
+			Stack[StackSize++] = Node.Offset;
+			Stack[StackSize++] = NodeIndex + 1;
+		}
+	}
+}
@@ -1,6 +1,8 @@
 #include "FNavigationController.h"
 #include "Blend4RealUtils.h"
 #include "Blend4RealSettings.h"
+#include "FViewportRedrawController.h"
+#include "FHoverPickPrefetcher.h"
 #include "Editor.h"
 #include "EditorViewportClient.h"
 #include "MouseDeltaTracker.h"
@@ -8,7 +10,10 @@
 #include "Framework/Application/SlateApplication.h"
 #include "Engine/Selection.h"
 
-FNavigationController::FNavigationController()
+FNavigationController::FNavigationController(TSharedPtr<FViewportRedrawController> InRedrawController,
+                                             TSharedPtr<FHoverPickPrefetcher> InHoverPickPrefetcher)
+	: RedrawController(InRedrawController)
+	  , HoverPickPrefetcher(InHoverPickPrefetcher)
 {
 }
 
@@ -34,6 +39,7 @@ void FNavigationController::BeginOrbit(const FVector2D& MousePosition)
 	CapturedViewportClient = ViewportClient;
 	bIsOrbiting = true;
 	LastMousePosition = FSlateApplication::Get().GetCursorPos();
+	InteractionQuality.Begin(ViewportClient, TEXT("Orbit"));
 
 	// Enable high-precision mouse mode for infinite cursor movement
 	EnableHighPrecisionMouseMode();
@@ -50,7 +56,7 @@ void FNavigationController::BeginOrbit(const FVector2D& MousePosition)
 
 	if (Settings->ShouldOrbitAroundMouseHit())
 	{
-		const FHitResult Result = Blend4RealUtils::ScenePickAtPosition(MousePosition, RayOrigin, RayDirection);
+		const FHitResult Result = HoverPickPrefetcher->PickAtPosition(MousePosition, RayOrigin, RayDirection);
 		if (Result.IsValidBlockingHit())
 		{
 			OrbitPivot = Result.Location;
@@ -72,6 +78,7 @@ void FNavigationController::EndOrbit()
 	// Disable high-precision mouse mode and restore cursor
 	DisableHighPrecisionMouseMode();
 
+	InteractionQuality.End();
 	bIsOrbiting = false;
 	CapturedViewportClient = nullptr;
 }
@@ -102,6 +109,7 @@ void FNavigationController::BeginPan(const FVector2D& MousePosition)
 	CapturedViewportClient = ViewportClient;
 	bIsPanning = true;
 	LastMousePosition = FSlateApplication::Get().GetCursorPos();
+	InteractionQuality.Begin(ViewportClient, TEXT("Pan"));
 
 	// Enable high-precision mouse mode for infinite cursor movement
 	EnableHighPrecisionMouseMode();
@@ -116,7 +124,7 @@ void FNavigationController::BeginPan(const FVector2D& MousePosition)
 		return;
 	}
 	// pick in the scene.
-	const FHitResult Result = Blend4RealUtils::ScenePickAtPosition(MousePosition, RayOrigin, RayDirection);
+	const FHitResult Result = HoverPickPrefetcher->PickAtPosition(MousePosition, RayOrigin, RayDirection);
 	PanPivot = OrbitPivot; // default to last OrbitPivot in case we don't hit anything
 	if (Result.IsValidBlockingHit())
 	{
@@ -163,6 +171,7 @@ void FNavigationController::EndPan()
 	// Disable high-precision mouse mode and restore cursor
 	DisableHighPrecisionMouseMode();
 
+	InteractionQuality.End();
 	bIsPanning = false;
 	CapturedViewportClient = nullptr;
 }
@@ -253,7 +262,7 @@ void FNavigationController::UpdateOrbitCameraMode(FEditorViewportClient* Viewpor
 	FViewportCameraTransform& ViewTransform = ViewportClient->GetViewTransform();
 	ViewportClient->SetViewLocation(ViewTransform.ComputeOrbitMatrix().Inverse().GetOrigin());
 
-	ViewportClient->Invalidate();
+	RedrawController->RequestRedraw(ViewportClient);
 }
 
 void FNavigationController::UpdateRegularCameraMode(FEditorViewportClient* ViewportClient, const FVector2D& Delta) const
@@ -294,7 +303,7 @@ void FNavigationController::UpdateRegularCameraMode(FEditorViewportClient* Viewp
 	ViewportClient->SetViewLocation(NewLocation);
 	ViewportClient->SetViewRotation(NewRotation);
 
-	ViewportClient->Invalidate();
+	RedrawController->RequestRedraw(ViewportClient);
 }
 
 void FNavigationController::UpdatePan(const FVector2D& MousePosition)
@@ -337,8 +346,8 @@ void FNavigationController::UpdatePan(const FVector2D& MousePosition)
 
 		ViewportClient->SetViewLocation(CameraLocation + PanDelta);
 
-		// Invalidate the viewport to trigger a redraw
-		ViewportClient->Invalidate();
+		// Request a redraw of the viewport
+		RedrawController->RequestRedraw(ViewportClient);
 		return;
 	}
 	LastMousePosition = MousePosition;
@@ -353,8 +362,8 @@ void FNavigationController::UpdatePan(const FVector2D& MousePosition)
 
 
 	//DrawDebugLine(ViewportClient->GetWorld(), PanPivot, PlaneHit, FColor::Red, false, 0.1, 1);
-	// Invalidate the viewport to trigger a redraw
-	ViewportClient->Invalidate();
+	// Request a redraw of the viewport
+	RedrawController->RequestRedraw(ViewportClient);
 }
 
 void FNavigationController::UpdatePanOrbitCameraMode(FEditorViewportClient* ViewportClient,
@@ -388,7 +397,7 @@ void FNavigationController::UpdatePanOrbitCameraMode(FEditorViewportClient* View
 		const FVector PanDelta = (-RightVector * Delta.X + UpVector * Delta.Y) * PanSpeed;
 		ViewportClient->SetLookAtLocation(LookAt + PanDelta);
 		ViewportClient->SetViewLocation(ViewTransform.ComputeOrbitMatrix().Inverse().GetOrigin());
-		ViewportClient->Invalidate();
+		RedrawController->RequestRedraw(ViewportClient);
 		return;
 	}
 
@@ -410,12 +419,12 @@ void FNavigationController::UpdatePanOrbitCameraMode(FEditorViewportClient* View
 	FViewportCameraTransform& ViewTransform = ViewportClient->GetViewTransform();
 	ViewportClient->SetViewLocation(ViewTransform.ComputeOrbitMatrix().Inverse().GetOrigin());
 
-	ViewportClient->Invalidate();
+	RedrawController->RequestRedraw(ViewportClient);
 }
 
 bool FNavigationController::FocusOnMouseHit(const FVector2D& MousePosition)
 {
-	const FHitResult Result = Blend4RealUtils::ScenePickAtPosition(MousePosition, RayOrigin, RayDirection);
+	const FHitResult Result = HoverPickPrefetcher->PickAtPosition(MousePosition, RayOrigin, RayDirection);
 
 	if (!Result.IsValidBlockingHit())
 	{
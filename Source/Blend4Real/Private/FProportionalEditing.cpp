@@ -0,0 +1,359 @@
+#include "FProportionalEditing.h"
+#include "Blend4RealUtils.h"
+#include "FActorBoundsTree.h"
+#include "ActorEditorUtils.h"
+#include "LevelUtils.h"
+#include "GameFramework/Actor.h"
+
+namespace
+{
+	// The hash is built again with a cell size matching the radius when they differ by more than this factor
+	constexpr double MaxCellSizeRatio = 4.0;
+
+	// Candidates are gathered this much further than the radius, so growing it doesn't query the tree every step
+	constexpr float GatherRadiusScale = 2.f;
+
+	bool IsProportionalCandidate(const AActor* Actor, const TSet<const AActor*>& ExcludedActors)
+	{
+		return Actor
+			&& Actor->GetRootComponent()
+			&& !ExcludedActors.Contains(Actor)
+			// Attached actors follow their parent
+			&& !Actor->GetAttachParentActor()
+			&& Actor->IsEditable()
+			&& !Actor->IsHiddenEd()
+			&& !Actor->IsLockLocation()
+			&& !FActorEditorUtils::IsABuilderBrush(Actor)
+			&& !FLevelUtils::IsLevelLocked(const_cast<AActor*>(Actor));
+	}
+}
+
+void FProportionalEditing::Begin(UWorld* World, const TSet<const AActor*>& ExcludedActors,
+                                 const TArray<FVector>& InSelectedPivots, const float InRadius)
+{
+	End(false);
+	if (!World)
+	{
+		return;
+	}
+
+	CandidateWorld = World;
+	CandidateExcludedActors = ExcludedActors;
+	SelectedPivots = InSelectedPivots;
+	SelectedPivotBounds = FBox(InSelectedPivots);
+	bDeferMoveUpdates = Blend4RealUtils::ShouldDeferActorMoveUpdates(World);
+	Radius = FMath::Max(InRadius, 1.f);
+	GatherCandidates(Radius * GatherRadiusScale);
+	BuildHash(Radius);
+	bIsActive = true;
+	UpdateWeights();
+}
+
+void FProportionalEditing::GatherCandidates(const float InGatherRadius)
+{
+	GatheredRadius = InGatherRadius;
+	const FActorBoundsTree* Tree = FActorBoundsTree::Get(CandidateWorld.Get());
+	if (!Tree || !SelectedPivotBounds.IsValid)
+	{
+		return;
+	}
+
+	// The tree boxes contain the actor pivots, only the actors pivoted around the selected pivots are visited
+	const FBox GatherBox = SelectedPivotBounds.ExpandBy(InGatherRadius);
+	Tree->Query([&GatherBox](const FBox& Box)
+	{
+		return Box.Intersect(GatherBox);
+	}, [&](const int32 ProxyId)
+	{
+		AActor* Actor = const_cast<AActor*>(Tree->GetActor(ProxyId));
+		if (GatherBox.IsInsideOrOn(Tree->GetPivot(ProxyId)) && IsProportionalCandidate(Actor, CandidateExcludedActors)
+			&& !CandidateActors.Contains(Actor))
+		{
+			CandidateActors.Add(Actor);
+			Candidates.Add(Actor);
+			CandidatePivots.Add(Actor->GetActorLocation());
+		}
+	});
+}
+
+void FProportionalEditing::End(const bool bApply)
+{
+	for (const TPair<int32, FTransform>& Pair : InitialTransforms)
+	{
+		if (bApply)
+		{
+			if (AActor* Actor = Candidates[Pair.Key].Get())
+			{
+				Actor->PostEditMove(true);
+				FActorBoundsTree::MarkActorDirty(Actor);
+			}
+		}
+		else
+		{
+			RestoreNeighbour(Pair.Key, true);
+		}
+	}
+
+	bIsActive = false;
+	bHasLastPivot = false;
+	CandidateWorld.Reset();
+	CandidateExcludedActors.Reset();
+	CandidateActors.Reset();
+	SelectedPivotBounds = FBox(ForceInit);
+	GatheredRadius = 0.f;
+	Candidates.Reset();
+	CandidatePivots.Reset();
+	CellItems.Reset();
+	Cells.Reset();
+	SelectedPivots.Reset();
+	Weights.Reset();
+	InitialTransforms.Reset();
+}
+
+void FProportionalEditing::GetMovedActors(TArray<AActor*>& OutActors) const
+{
+	for (const TPair<int32, FTransform>& Pair : InitialTransforms)
+	{
+		if (AActor* Actor = Candidates[Pair.Key].Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+void FProportionalEditing::BuildHash(const double InCellSize)
+{
+	CellSize = InCellSize;
+	Cells.Reset();
+
+	// Sort the candidates by cell so each cell is a contiguous range of CellItems
+	TArray<TPair<FIntVector, int32>> Keyed;
+	Keyed.Reserve(CandidatePivots.Num());
+	for (int32 Index = 0; Index < CandidatePivots.Num(); ++Index)
+	{
+		Keyed.Emplace(GetCell(CandidatePivots[Index]), Index);
+	}
+	Keyed.Sort([](const TPair<FIntVector, int32>& A, const TPair<FIntVector, int32>& B)
+	{
+		if (A.Key.X != B.Key.X) return A.Key.X < B.Key.X;
+		if (A.Key.Y != B.Key.Y) return A.Key.Y < B.Key.Y;
+		return A.Key.Z < B.Key.Z;
+	});
+
+	CellItems.Reset(Keyed.Num());
+	for (int32 Index = 0; Index < Keyed.Num(); ++Index)
+	{
+		FCellRange& Range = Cells.FindOrAdd(Keyed[Index].Key);
+		if (Range.Num == 0)
+		{
+			Range.Start = Index;
+		}
+		++Range.Num;
+		CellItems.Add(Keyed[Index].Value);
+	}
+}
+
+FIntVector FProportionalEditing::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void FProportionalEditing::UpdateWeights()
+{
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	// Squared distance of each neighbour to its closest selected pivot
+	TMap<int32, double> DistancesSquared;
+	auto VisitCell = [&](const FCellRange& Range, const FVector& Pivot)
+	{
+		for (int32 Item = Range.Start; Item < Range.Start + Range.Num; ++Item)
+		{
+			const int32 Index = CellItems[Item];
+			const double DistanceSquared = FVector::DistSquared(CandidatePivots[Index], Pivot);
+			if (DistanceSquared <= RadiusSquared)
+			{
+				double& Closest = DistancesSquared.FindOrAdd(Index, DistanceSquared);
+				Closest = FMath::Min(Closest, DistanceSquared);
+			}
+		}
+	};
+
+	for (const FVector& Pivot : SelectedPivots)
+	{
+		const FIntVector Min = GetCell(Pivot - FVector(Radius));
+		const FIntVector Max = GetCell(Pivot + FVector(Radius));
+		const int64 NumRangeCells = static_cast<int64>(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+
+		// Sparse levels: fewer occupied cells than cells in range
+		if (NumRangeCells > Cells.Num())
+		{
+			for (const TPair<FIntVector, FCellRange>& Cell : Cells)
+			{
+				if (Cell.Key.X >= Min.X && Cell.Key.X <= Max.X
+					&& Cell.Key.Y >= Min.Y && Cell.Key.Y <= Max.Y
+					&& Cell.Key.Z >= Min.Z && Cell.Key.Z <= Max.Z)
+				{
+					VisitCell(Cell.Value, Pivot);
+				}
+			}
+			continue;
+		}
+
+		for (int32 X = Min.X; X <= Max.X; ++X)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			{
+				for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+				{
+					if (const FCellRange* Range = Cells.Find(FIntVector(X, Y, Z)))
+					{
+						VisitCell(*Range, Pivot);
+					}
+				}
+			}
+		}
+	}
+
+	const EBlend4RealProportionalFalloff Falloff = UBlend4RealSettings::Get()->ProportionalFalloff;
+	Weights.Reset();
+	Weights.Reserve(DistancesSquared.Num());
+	for (const TPair<int32, double>& Pair : DistancesSquared)
+	{
+		const float Weight = ComputeFalloff(Falloff, FMath::Sqrt(Pair.Value), Radius);
+		if (Weight > 0.f)
+		{
+			Weights.Add(Pair.Key, Weight);
+		}
+	}
+
+	// Neighbours left out of the radius go back to their initial transform
+	for (const TPair<int32, FTransform>& Pair : InitialTransforms)
+	{
+		if (!Weights.Contains(Pair.Key))
+		{
+			RestoreNeighbour(Pair.Key, false);
+		}
+	}
+}
+
+void FProportionalEditing::Apply(const FTransform& InitialPivot, const FTransform& NewPivot)
+{
+	if (!bIsActive)
+	{
+		return;
+	}
+
+	LastInitialPivot = InitialPivot;
+	LastPivot = NewPivot;
+	bHasLastPivot = true;
+
+	const FTransform InitialPivotInverse = InitialPivot.Inverse();
+	for (const TPair<int32, float>& Pair : Weights)
+	{
+		AActor* Actor = Candidates[Pair.Key].Get();
+		if (!Actor)
+		{
+			continue;
+		}
+
+		const FTransform* InitialTransform = InitialTransforms.Find(Pair.Key);
+		if (!InitialTransform)
+		{
+			// Recorded in the transaction of the transform the first time it moves
+			Actor->Modify();
+			InitialTransform = &InitialTransforms.Add(Pair.Key, Actor->GetActorTransform());
+		}
+
+		const float Weight = Pair.Value;
+		FTransform WeightedPivot;
+		WeightedPivot.SetLocation(FMath::Lerp(InitialPivot.GetLocation(), NewPivot.GetLocation(), Weight));
+		WeightedPivot.SetRotation(FQuat::Slerp(InitialPivot.GetRotation(), NewPivot.GetRotation(), Weight));
+		WeightedPivot.SetScale3D(FMath::Lerp(InitialPivot.GetScale3D(), NewPivot.GetScale3D(), Weight));
+
+		SetNeighbourTransform(Pair.Key, *InitialTransform * InitialPivotInverse * WeightedPivot);
+	}
+}
+
+void FProportionalEditing::SetRadius(const float InRadius)
+{
+	if (!bIsActive)
+	{
+		return;
+	}
+
+	Radius = FMath::Max(InRadius, 1.f);
+	if (Radius > GatheredRadius)
+	{
+		// New candidates are appended, the indices of the moved neighbours don't change
+		GatherCandidates(Radius * GatherRadiusScale);
+		BuildHash(Radius);
+	}
+	else if (Radius > CellSize * MaxCellSizeRatio || Radius < CellSize / MaxCellSizeRatio)
+	{
+		BuildHash(Radius);
+	}
+	UpdateWeights();
+
+	if (bHasLastPivot)
+	{
+		Apply(LastInitialPivot, LastPivot);
+	}
+}
+
+float FProportionalEditing::ComputeFalloff(const EBlend4RealProportionalFalloff Falloff, const float Distance,
+                                           const float InRadius)
+{
+	if (InRadius <= 0.f || Distance >= InRadius)
+	{
+		return 0.f;
+	}
+
+	const float T = 1.f - Distance / InRadius;
+	switch (Falloff)
+	{
+	case EBlend4RealProportionalFalloff::Sphere:
+		return FMath::Sqrt(2.f * T - T * T);
+	case EBlend4RealProportionalFalloff::Root:
+		return FMath::Sqrt(T);
+	case EBlend4RealProportionalFalloff::Linear:
+		return T;
+	case EBlend4RealProportionalFalloff::Sharp:
+		return T * T;
+	case EBlend4RealProportionalFalloff::Constant:
+		return 1.f;
+	case EBlend4RealProportionalFalloff::Smooth:
+	default:
+		return 3.f * T * T - 2.f * T * T * T;
+	}
+}
+
+void FProportionalEditing::SetNeighbourTransform(const int32 Index, const FTransform& Transform)
+{
+	AActor* Actor = Candidates[Index].Get();
+	if (Actor && !Transform.ContainsNaN())
+	{
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::None);
+		if (!bDeferMoveUpdates)
+		{
+			// Notify actor of movement (bFinished=false indicates movement is still in progress)
+			Actor->PostEditMove(false);
+		}
+	}
+}
+
+void FProportionalEditing::RestoreNeighbour(const int32 Index, const bool bFinished)
+{
+	AActor* Actor = Candidates[Index].Get();
+	const FTransform* InitialTransform = InitialTransforms.Find(Index);
+	if (Actor && InitialTransform)
+	{
+		Actor->SetActorTransform(*InitialTransform, false, nullptr, ETeleportType::None);
+		if (bFinished || !bDeferMoveUpdates)
+		{
+			Actor->PostEditMove(bFinished);
+		}
+	}
+}
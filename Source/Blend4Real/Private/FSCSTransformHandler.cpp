@@ -2,6 +2,7 @@
 #include "BlueprintEditor.h"
 #include "SSubobjectEditor.h"
 #include "Editor.h"
+#include "Kismet2/BlueprintEditorUtils.h"
 #include "Components/SceneComponent.h"
 
 FSCSTransformHandler::FSCSTransformHandler(TWeakPtr<FBlueprintEditor> InBlueprintEditor)
@@ -122,55 +123,125 @@ TArray<TSharedPtr<FSubobjectEditorTreeNode>> FSCSTransformHandler::GetTransforma
 	return Result;
 }
 
-bool FSCSTransformHandler::HasSelection() const
+TArray<FSubobjectDataHandle> FSCSTransformHandler::GetSelectedHandles() const
 {
-	return GetTransformableSelectedNodes().Num() > 0;
+	TArray<FSubobjectDataHandle> Selection;
+	if (const TSharedPtr<FBlueprintEditor> Editor = BlueprintEditorPtr.Pin())
+	{
+		for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Editor->GetSelectedSubobjectEditorTreeNodes())
+		{
+			const FSubobjectData* Data = Node.IsValid() ? Node->GetDataSource() : nullptr;
+			Selection.Add(Data ? Data->GetHandle() : FSubobjectDataHandle::InvalidHandle);
+		}
+	}
+	return Selection;
 }
 
-int32 FSCSTransformHandler::GetSelectionCount() const
+void FSCSTransformHandler::RefreshResolvedNodes()
 {
-	return GetTransformableSelectedNodes().Num();
+	// Only the handles are compared, resolving the nodes into components is the expensive part
+	TArray<FSubobjectDataHandle> Selection = GetSelectedHandles();
+	if (!bResolved || Selection != ResolvedSelection)
+	{
+		ResolveNodes(MoveTemp(Selection));
+	}
 }
 
-FTransform FSCSTransformHandler::ComputeSelectionPivot() const
+const TArray<FSCSTransformHandler::FResolvedNode>& FSCSTransformHandler::GetResolvedNodes() const
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	if (Nodes.Num() == 0)
+	// The node selection is only compared when a transform or transaction begins (RefreshResolvedNodes), the preview
+	// actor and the components are checked on every call
+	const TSharedPtr<FBlueprintEditor> Editor = BlueprintEditorPtr.Pin();
+	const AActor* PreviewActor = Editor.IsValid() ? Editor->GetPreviewActor() : nullptr;
+	const bool bComponentsValid = !ResolvedNodes.ContainsByPredicate([](const FResolvedNode& Resolved)
 	{
-		return FTransform::Identity;
+		return !Resolved.Template.IsValid() || !Resolved.Instance.IsValid();
+	});
+	if (!bResolved || !bComponentsValid || PreviewActor != ResolvedPreviewActor.Get())
+	{
+		ResolveNodes(GetSelectedHandles());
 	}
+	return ResolvedNodes;
+}
+
+void FSCSTransformHandler::ResolveNodes(TArray<FSubobjectDataHandle>&& Selection) const
+{
+	const TSharedPtr<FBlueprintEditor> Editor = BlueprintEditorPtr.Pin();
+
+	// The preview actor may have been rebuilt (e.g. after a compile): keep the initial transforms of the transform
+	// in progress
+	TMap<FSubobjectDataHandle, FTransform> PreviousInitialTransforms;
+	for (const FResolvedNode& Resolved : ResolvedNodes)
+	{
+		PreviousInitialTransforms.Add(Resolved.Handle, Resolved.Initial);
+	}
+
+	ResolvedNodes.Reset();
+	ResolvedPreviewActor = Editor.IsValid() ? Editor->GetPreviewActor() : nullptr;
+	ResolvedSelection = MoveTemp(Selection);
+	bResolved = true;
+
+	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : GetTransformableSelectedNodes())
+	{
+		FResolvedNode& Resolved = ResolvedNodes.AddDefaulted_GetRef();
+		Resolved.Handle = Node->GetDataSource()->GetHandle();
+		Resolved.Template = GetTemplateComponent(Node);
+		Resolved.Instance = GetPreviewInstance(Node);
 
+		if (const FTransform* PreviousInitial = PreviousInitialTransforms.Find(Resolved.Handle))
+		{
+			Resolved.Initial = *PreviousInitial;
+		}
+		else if (const USceneComponent* Instance = Resolved.Instance.Get())
+		{
+			Resolved.Initial = Instance->GetComponentTransform();
+		}
+	}
+}
+
+bool FSCSTransformHandler::HasSelection() const
+{
+	return GetResolvedNodes().Num() > 0;
+}
+
+int32 FSCSTransformHandler::GetSelectionCount() const
+{
+	return GetResolvedNodes().Num();
+}
+
+FTransform FSCSTransformHandler::ComputeSelectionPivot() const
+{
 	FVector Center = FVector::ZeroVector;
 	int32 Count = 0;
 
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
 		// Use preview instance for world position (template may have relative transform only)
-		if (USceneComponent* Instance = GetPreviewInstance(Node))
+		if (const USceneComponent* Instance = Resolved.Instance.Get())
 		{
 			Center += Instance->GetComponentLocation();
 			Count++;
 		}
 	}
 
-	if (Count > 0)
+	if (Count == 0)
 	{
-		Center /= Count;
+		return FTransform::Identity;
 	}
 
-	return FTransform(FQuat::Identity, Center, FVector::OneVector);
+	return FTransform(FQuat::Identity, Center / Count, FVector::OneVector);
 }
 
 FTransform FSCSTransformHandler::GetFirstSelectedItemTransform() const
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
+	const TArray<FResolvedNode>& Nodes = GetResolvedNodes();
 	if (Nodes.Num() == 0)
 	{
 		return FTransform::Identity;
 	}
 
 	// Use preview instance for world transform
-	if (USceneComponent* Instance = GetPreviewInstance(Nodes[0]))
+	if (const USceneComponent* Instance = Nodes[0].Instance.Get())
 	{
 		return Instance->GetComponentTransform();
 	}
@@ -180,48 +251,38 @@ FTransform FSCSTransformHandler::GetFirstSelectedItemTransform() const
 
 FVector FSCSTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	if (Nodes.Num() == 0)
-	{
-		return FVector::ZeroVector;
-	}
-
 	// Accumulate axis vectors from each selected node
 	FVector AccumulatedAxis = FVector::ZeroVector;
 	int32 Count = 0;
 
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
-		const FSubobjectData* Data = Node->GetDataSource();
-		if (!Data)
+		if (!Resolved.Instance.IsValid())
 		{
 			continue;
 		}
 
-		if (const FTransform* Transform = InitialTransforms.Find(Data->GetHandle()))
-		{
-			const FQuat Rotation = Transform->GetRotation();
-			FVector AxisVector;
+		const FQuat Rotation = Resolved.Initial.GetRotation();
+		FVector AxisVector;
 
-			switch (Axis)
-			{
-			case EAxis::X:
-				AxisVector = Rotation.GetForwardVector();
-				break;
-			case EAxis::Y:
-				AxisVector = Rotation.GetRightVector();
-				break;
-			case EAxis::Z:
-				AxisVector = Rotation.GetUpVector();
-				break;
-			default:
-				AxisVector = FVector::ZeroVector;
-				break;
-			}
-
-			AccumulatedAxis += AxisVector;
-			Count++;
+		switch (Axis)
+		{
+		case EAxis::X:
+			AxisVector = Rotation.GetForwardVector();
+			break;
+		case EAxis::Y:
+			AxisVector = Rotation.GetRightVector();
+			break;
+		case EAxis::Z:
+			AxisVector = Rotation.GetUpVector();
+			break;
+		default:
+			AxisVector = FVector::ZeroVector;
+			break;
 		}
+
+		AccumulatedAxis += AxisVector;
+		Count++;
 	}
 
 	if (Count == 0)
@@ -234,63 +295,34 @@ FVector FSCSTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 
 void FSCSTransformHandler::CaptureInitialState()
 {
-	InitialTransforms.Empty();
-
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	RefreshResolvedNodes();
+	GetResolvedNodes();
+	for (FResolvedNode& Resolved : ResolvedNodes)
 	{
-		const FSubobjectData* Data = Node->GetDataSource();
-		if (!Data)
-		{
-			continue;
-		}
-
 		// Store world transform from preview instance for computing deltas
-		if (USceneComponent* Instance = GetPreviewInstance(Node))
+		if (const USceneComponent* Instance = Resolved.Instance.Get())
 		{
-			InitialTransforms.Add(Data->GetHandle(), Instance->GetComponentTransform());
+			Resolved.Initial = Instance->GetComponentTransform();
 		}
 	}
 }
 
 void FSCSTransformHandler::RestoreInitialState()
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	// Templates weren't written yet, only the preview instances moved
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
-		const FSubobjectData* Data = Node->GetDataSource();
-		if (!Data)
-		{
-			continue;
-		}
-
-		const FTransform* Original = InitialTransforms.Find(Data->GetHandle());
-		if (!Original)
-		{
-			continue;
-		}
-
-		// Restore both template and preview instance
-		if (USceneComponent* Template = GetTemplateComponent(Node))
+		if (USceneComponent* Instance = Resolved.Instance.Get())
 		{
-			Template->SetWorldTransform(*Original);
-		}
-		if (USceneComponent* Instance = GetPreviewInstance(Node))
-		{
-			Instance->SetWorldTransform(*Original);
+			Instance->SetWorldTransform(Resolved.Initial);
 		}
 	}
+	bTemplatesDirty = false;
 }
 
 void FSCSTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot,
                                                      const FTransform& NewPivotTransform)
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	if (Nodes.Num() == 0)
-	{
-		return;
-	}
-
 	// Calculate the delta between initial and new pivot transforms
 	const FVector DeltaTranslation = NewPivotTransform.GetLocation() - InitialPivot.GetLocation();
 	const FQuat DeltaRotation = NewPivotTransform.GetRotation() * InitialPivot.GetRotation().Inverse();
@@ -298,22 +330,17 @@ void FSCSTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPi
 
 	const FVector PivotLocation = InitialPivot.GetLocation();
 
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
-		const FSubobjectData* Data = Node->GetDataSource();
-		if (!Data)
+		if (!Resolved.Instance.IsValid())
 		{
 			continue;
 		}
 
-		const FTransform* InitialComponentTransform = InitialTransforms.Find(Data->GetHandle());
-		if (!InitialComponentTransform)
-		{
-			continue;
-		}
+		const FTransform& InitialComponentTransform = Resolved.Initial;
 
 		// Calculate the component's position relative to pivot
-		const FVector InitialRelativeToPivot = InitialComponentTransform->GetLocation() - PivotLocation;
+		const FVector InitialRelativeToPivot = InitialComponentTransform.GetLocation() - PivotLocation;
 
 		// Apply rotation around pivot to get new position offset
 		const FVector RotatedOffset = DeltaRotation.RotateVector(InitialRelativeToPivot);
@@ -325,24 +352,21 @@ void FSCSTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPi
 		const FVector NewLocation = PivotLocation + DeltaTranslation + ScaledOffset;
 
 		// Apply rotation to the component's own rotation
-		const FQuat NewRotation = DeltaRotation * InitialComponentTransform->GetRotation();
+		const FQuat NewRotation = DeltaRotation * InitialComponentTransform.GetRotation();
 
 		// Apply scale to the component's own scale
-		const FVector NewScale = InitialComponentTransform->GetScale3D() * DeltaScale;
+		const FVector NewScale = InitialComponentTransform.GetScale3D() * DeltaScale;
 
 		// Build new transform
 		FTransform NewTransform(NewRotation, NewLocation, NewScale);
 
 		if (NewTransform.IsValid())
 		{
-			// Apply to BOTH template and preview instance
-			if (USceneComponent* Template = GetTemplateComponent(Node))
-			{
-				Template->SetWorldTransform(NewTransform);
-			}
-			if (USceneComponent* Instance = GetPreviewInstance(Node))
+			// Only the preview instance moves during the drag, the template is written on confirm
+			if (USceneComponent* Instance = Resolved.Instance.Get())
 			{
 				Instance->SetWorldTransform(NewTransform);
+				bTemplatesDirty = true;
 			}
 		}
 	}
@@ -350,11 +374,10 @@ void FSCSTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPi
 
 void FSCSTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale)
 {
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
-		USceneComponent* Template = GetTemplateComponent(Node);
-		USceneComponent* Instance = GetPreviewInstance(Node);
+		USceneComponent* Template = Resolved.Template.Get();
+		USceneComponent* Instance = Resolved.Instance.Get();
 
 		// Build transform from current + overrides
 		FTransform CurrentTransform = Instance
@@ -374,14 +397,15 @@ void FSCSTransformHandler::SetDirectTransform(const FVector* Location, const FRo
 			CurrentTransform.SetScale3D(*Scale);
 		}
 
-		// Apply to both template and preview instance
-		if (Template)
-		{
-			Template->SetWorldTransform(CurrentTransform);
-		}
+		// Templates without preview instance are written directly, the others when the transaction ends
 		if (Instance)
 		{
 			Instance->SetWorldTransform(CurrentTransform);
+			bTemplatesDirty = true;
+		}
+		else if (Template)
+		{
+			Template->SetWorldTransform(CurrentTransform);
 		}
 	}
 }
@@ -394,12 +418,12 @@ int32 FSCSTransformHandler::BeginTransaction(const FText& Description)
 	}
 
 	int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
+	RefreshResolvedNodes();
 
 	// Mark all template components as modified for undo
-	TArray<TSharedPtr<FSubobjectEditorTreeNode>> Nodes = GetTransformableSelectedNodes();
-	for (const TSharedPtr<FSubobjectEditorTreeNode>& Node : Nodes)
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
 	{
-		if (USceneComponent* Template = GetTemplateComponent(Node))
+		if (USceneComponent* Template = Resolved.Template.Get())
 		{
 			Template->Modify();
 		}
@@ -410,12 +434,39 @@ int32 FSCSTransformHandler::BeginTransaction(const FText& Description)
 
 void FSCSTransformHandler::EndTransaction()
 {
+	if (bTemplatesDirty)
+	{
+		WriteTemplates();
+	}
 	if (GEditor)
 	{
 		GEditor->EndTransaction();
 	}
 }
 
+void FSCSTransformHandler::WriteTemplates()
+{
+	bTemplatesDirty = false;
+	for (const FResolvedNode& Resolved : GetResolvedNodes())
+	{
+		USceneComponent* Template = Resolved.Template.Get();
+		const USceneComponent* Instance = Resolved.Instance.Get();
+		if (Template && Instance)
+		{
+			// The preview instance is attached like the template, its relative transform is the one to persist
+			Template->SetRelativeLocation_Direct(Instance->GetRelativeLocation());
+			Template->SetRelativeRotation_Direct(Instance->GetRelativeRotation());
+			Template->SetRelativeScale3D_Direct(Instance->GetRelativeScale3D());
+		}
+	}
+
+	const TSharedPtr<FBlueprintEditor> Editor = BlueprintEditorPtr.Pin();
+	if (UBlueprint* Blueprint = Editor.IsValid() ? Editor->GetBlueprintObj() : nullptr)
+	{
+		FBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
+	}
+}
+
 void FSCSTransformHandler::CancelTransaction(int32 TransactionIndex)
 {
 	if (GEditor && TransactionIndex >= 0)
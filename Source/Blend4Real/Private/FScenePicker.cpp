@@ -0,0 +1,260 @@
+#include "FScenePicker.h"
+#include "Blend4RealSettings.h"
+#include "FMeshBVHPicker.h"
+#include "FActorBoundsTree.h"
+#include "FSelectionTraceFilter.h"
+#include "CollisionQueryParams.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Margin added to the world bounds so surfaces lying exactly on the bounds are still hit
+	constexpr float WorldBoundsMargin = 100.f;
+
+	// Primitives whose simple collision blocks the ray but whose complex collision misses it, tried before giving up
+	constexpr int32 MaxSimpleBlockers = 4;
+
+	/** Union of the level bounds actors of all visible levels, invalid if none is available */
+	FBox GetWorldBounds(const UWorld* World)
+	{
+		FBox Bounds(ForceInit);
+		for (const ULevel* Level : World->GetLevels())
+		{
+			if (Level && Level->bIsVisible && Level->LevelBoundsActor.IsValid())
+			{
+				const FBox LevelBox = Level->LevelBoundsActor->GetComponentsBoundingBox();
+				if (LevelBox.IsValid)
+				{
+					Bounds += LevelBox;
+				}
+			}
+		}
+		return Bounds;
+	}
+
+	/** Keep a component hit if it is closer than the current blocking hit, with Time along the whole trace */
+	bool KeepCloserHit(const FHitResult& ComponentHit, const FVector& Start, const FVector& End, FHitResult& InOutHit)
+	{
+		if (InOutHit.bBlockingHit && ComponentHit.Distance >= InOutHit.Distance)
+		{
+			return false;
+		}
+		InOutHit = ComponentHit;
+		InOutHit.bBlockingHit = true;
+		InOutHit.TraceStart = Start;
+		InOutHit.TraceEnd = End;
+		InOutHit.Time = ComponentHit.Distance / FVector::Dist(Start, End);
+		return true;
+	}
+
+	/**
+	 * Trace the complex collision of one primitive, as the ECC_Camera world trace would see it.
+	 * Instanced static meshes keep one body per instance, traced one by one.
+	 * @return True if InOutHit was replaced by a closer hit
+	 */
+	bool TraceCandidate(const UPrimitiveComponent* Component, const FVector& Start, const FVector& End,
+	                    const FCollisionQueryParams& Params, FHitResult& InOutHit)
+	{
+		if (!Component->IsRegistered() || !Component->IsQueryCollisionEnabled()
+			|| Component->GetCollisionResponseToChannel(ECC_Camera) != ECR_Block
+			|| FSelectionTraceFilter::IsIgnored(Component, Params))
+		{
+			return false;
+		}
+
+		// Only up to the closest hit so far
+		const FVector ClippedEnd = InOutHit.bBlockingHit ? Start + (End - Start).GetSafeNormal() * InOutHit.Distance : End;
+		if (!FMath::LineBoxIntersection(Component->Bounds.GetBox(), Start, ClippedEnd, ClippedEnd - Start))
+		{
+			return false;
+		}
+
+		bool bHit = false;
+		if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+		{
+			for (const FBodyInstance* Body : Instanced->InstanceBodies)
+			{
+				FHitResult InstanceHit;
+				if (Body && (Body->GetMaskFilter() & Params.IgnoreMask) == 0
+					&& FMath::LineBoxIntersection(Body->GetBodyBounds(), Start, ClippedEnd, ClippedEnd - Start)
+					&& Body->LineTrace(InstanceHit, Start, ClippedEnd, true))
+				{
+					bHit |= KeepCloserHit(InstanceHit, Start, End, InOutHit);
+				}
+			}
+			return bHit;
+		}
+
+		FCollisionQueryParams ComplexParams(Params);
+		ComplexParams.bTraceComplex = true;
+		FHitResult ComponentHit;
+		if (const_cast<UPrimitiveComponent*>(Component)->LineTraceComponent(ComponentHit, Start, ClippedEnd, ComplexParams))
+		{
+			bHit = KeepCloserHit(ComponentHit, Start, End, InOutHit);
+		}
+		return bHit;
+	}
+
+	/** Slab test, returns the distance at which the ray leaves the box */
+	bool ComputeRayBoxExitDistance(const FBox& Box, const FVector& Start, const FVector& Direction, double& OutExit)
+	{
+		double TMin = -UE_BIG_NUMBER;
+		double TMax = UE_BIG_NUMBER;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FMath::IsNearlyZero(Direction[Axis]))
+			{
+				if (Start[Axis] < Box.Min[Axis] || Start[Axis] > Box.Max[Axis])
+				{
+					return false;
+				}
+				continue;
+			}
+			const double T1 = (Box.Min[Axis] - Start[Axis]) / Direction[Axis];
+			const double T2 = (Box.Max[Axis] - Start[Axis]) / Direction[Axis];
+			TMin = FMath::Max(TMin, FMath::Min(T1, T2));
+			TMax = FMath::Min(TMax, FMath::Max(T1, T2));
+		}
+		if (TMax < FMath::Max(TMin, 0.0))
+		{
+			return false;
+		}
+		OutExit = TMax;
+		return true;
+	}
+}
+
+float FScenePicker::ComputeTraceLength(const UWorld* World, const FVector& Start, const FVector& Direction,
+                                       const float MaxDistance)
+{
+	if (!World)
+	{
+		return MaxDistance;
+	}
+
+	const FBox WorldBounds = GetWorldBounds(World);
+	double ExitDistance;
+	if (WorldBounds.IsValid && ComputeRayBoxExitDistance(WorldBounds.ExpandBy(WorldBoundsMargin), Start, Direction,
+	                                                     ExitDistance))
+	{
+		return FMath::Min(MaxDistance, static_cast<float>(ExitDistance));
+	}
+	return MaxDistance;
+}
+
+FHitResult FScenePicker::TraceComplex(const UWorld* World, const FVector& Start, const FVector& Direction,
+                                      const FCollisionQueryParams& Params, const float MaxDistance)
+{
+	FHitResult HitResult;
+	if (!World)
+	{
+		return HitResult;
+	}
+
+	FCollisionQueryParams ComplexParams(Params);
+	ComplexParams.bTraceComplex = true;
+	World->LineTraceSingleByChannel(HitResult, Start, Start + Direction * MaxDistance, ECC_Camera, ComplexParams);
+	return HitResult;
+}
+
+FHitResult FScenePicker::Trace(const UWorld* World, const FVector& Start, const FVector& Direction,
+                               const FCollisionQueryParams& Params, const float MaxDistance)
+{
+	if (!World)
+	{
+		return FHitResult();
+	}
+
+	const UBlend4RealSettings* Settings = UBlend4RealSettings::Get();
+	const float TraceLength = ComputeTraceLength(World, Start, Direction, MaxDistance);
+	FHitResult Hit = Settings->bTwoPhasePicking
+		                 ? TraceTwoPhase(World, Start, Direction, Params, TraceLength)
+		                 : TraceComplex(World, Start, Direction, Params, TraceLength);
+
+	// Meshes without collision are invisible to the traces above
+	if (Settings->bPickMeshesWithoutCollision)
+	{
+		FMeshBVHPicker::Trace(World, Start, Direction, Params, TraceLength, Hit);
+	}
+	return Hit;
+}
+
+FHitResult FScenePicker::TraceTwoPhase(const UWorld* World, const FVector& Start, const FVector& Direction,
+                                       const FCollisionQueryParams& Params, const float MaxDistance)
+{
+	if (!World)
+	{
+		return FHitResult();
+	}
+
+	const FVector End = Start + Direction * MaxDistance;
+
+	// Phase 1: bound the nearest complex hit. The first primitive blocking the ray with its simple collision
+	// is traced against its complex collision; if the ray only crosses its simple shape, the next one is tried.
+	FCollisionQueryParams SimpleParams(Params);
+	SimpleParams.bTraceComplex = false;
+	FCollisionQueryParams ComplexParams(Params);
+	ComplexParams.bTraceComplex = true;
+	FHitResult BoundHit;
+	for (int32 Blocker = 0; Blocker < MaxSimpleBlockers; ++Blocker)
+	{
+		FHitResult SimpleHit;
+		if (!World->LineTraceSingleByChannel(SimpleHit, Start, End, ECC_Camera, SimpleParams))
+		{
+			break;
+		}
+
+		UPrimitiveComponent* Component = SimpleHit.GetComponent();
+		if (Component && Component->LineTraceComponent(BoundHit, Start, End, ComplexParams))
+		{
+			BoundHit.bBlockingHit = true;
+			break;
+		}
+		SimpleParams.AddIgnoredComponent(Component);
+	}
+
+	// Phase 2: complex trace of the candidate primitives only, the ones whose bounds the ray crosses before the
+	// bound, found through the actor bounds tree. It finds the primitives without simple collision in front of the
+	// bound, and the complex surfaces closer than the blocker's.
+	const FActorBoundsTree* Tree = FActorBoundsTree::Get(World);
+	if (!Tree)
+	{
+		const FHitResult ComplexHit = TraceComplex(World, Start, Direction, Params,
+		                                           BoundHit.bBlockingHit ? BoundHit.Distance : MaxDistance);
+		return ComplexHit.bBlockingHit ? ComplexHit : BoundHit;
+	}
+
+	FHitResult Hit = BoundHit;
+	if (Hit.bBlockingHit)
+	{
+		Hit.TraceStart = Start;
+		Hit.TraceEnd = End;
+		Hit.Time = Hit.Distance / MaxDistance;
+	}
+	const UPrimitiveComponent* BoundComponent = BoundHit.GetComponent();
+	auto NodeFilter = [&Start, &End, &Hit](const FBox& Box)
+	{
+		const FVector ClippedEnd = Hit.bBlockingHit ? Start + (End - Start) * Hit.Time : End;
+		return FMath::LineBoxIntersection(Box, Start, ClippedEnd, ClippedEnd - Start);
+	};
+	Tree->Query(NodeFilter, [&](const int32 ProxyId)
+	{
+		const AActor* Owner = Tree->GetActor(ProxyId);
+		if (!Owner)
+		{
+			return;
+		}
+		Owner->ForEachComponent<UPrimitiveComponent>(false, [&](const UPrimitiveComponent* Component)
+		{
+			if (Component != BoundComponent)
+			{
+				TraceCandidate(Component, Start, End, Params, Hit);
+			}
+		});
+	});
+	return Hit;
+}
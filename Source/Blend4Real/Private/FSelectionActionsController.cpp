@@ -1,13 +1,97 @@
 #include "FSelectionActionsController.h"
 #include "FTransformController.h"
+#include "FGhostDuplicateTransformHandler.h"
+#include "FInstanceTransformHandler.h"
+#include "FViewportRedrawController.h"
 #include "Blend4RealUtils.h"
+#include "Blend4RealSettings.h"
 #include "Editor.h"
 #include "Editor/UnrealEdEngine.h"
 #include "UnrealEdGlobals.h"
 #include "Engine/Selection.h"
+#include "Engine/World.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Widgets/Notifications/SNotificationList.h"
 
-FSelectionActionsController::FSelectionActionsController(TSharedPtr<FTransformController> InTransformController)
+namespace
+{
+	// Sweeps not completed within this delay are dropped (e.g. the world stopped ticking)
+	constexpr double MaxPendingDropAge = 2.0;
+
+	// Sweep a slightly smaller box so actors resting on a surface don't start penetrating it
+	constexpr double DropSweepSkin = 0.1;
+
+	// Actors already penetrating a surface are pushed back against the drop direction, unless the surface is too steep
+	// to rest on (e.g. a wall), where the push back would be much longer than the penetration
+	constexpr double MinPenetrationFacing = 0.1;
+
+	// Tag of the actor holding the instances created by Instanced Duplicate, one per level
+	const FName InstanceContainerTag(TEXT("Blend4RealInstances"));
+
+	AActor* FindOrCreateInstanceContainer(UWorld* World)
+	{
+		ULevel* Level = World->GetCurrentLevel();
+		for (AActor* Actor : Level->Actors)
+		{
+			if (Actor && Actor->ActorHasTag(InstanceContainerTag))
+			{
+				return Actor;
+			}
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.OverrideLevel = Level;
+		AActor* Container = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (!Container)
+		{
+			return nullptr;
+		}
+
+		USceneComponent* Root = NewObject<USceneComponent>(Container, TEXT("Root"), RF_Transactional);
+		Container->SetRootComponent(Root);
+		Container->AddInstanceComponent(Root);
+		Root->RegisterComponent();
+		Container->Tags.Add(InstanceContainerTag);
+		Container->SetActorLabel(TEXT("Blend4Real_Instances"));
+		return Container;
+	}
+
+	/** Find the container component instancing the mesh and materials of the source, or add one */
+	UHierarchicalInstancedStaticMeshComponent* FindOrCreateInstanceComponent(AActor* Container,
+	                                                                        const UStaticMeshComponent* Source)
+	{
+		TInlineComponentArray<UHierarchicalInstancedStaticMeshComponent*> InstanceComponents(Container);
+		for (UHierarchicalInstancedStaticMeshComponent* Component : InstanceComponents)
+		{
+			if (Component->GetStaticMesh() == Source->GetStaticMesh()
+				&& Component->OverrideMaterials == Source->OverrideMaterials)
+			{
+				return Component;
+			}
+		}
+
+		Container->Modify();
+		UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(
+			Container, NAME_None, RF_Transactional);
+		Component->SetStaticMesh(Source->GetStaticMesh());
+		for (int32 Index = 0; Index < Source->OverrideMaterials.Num(); ++Index)
+		{
+			Component->SetMaterial(Index, Source->OverrideMaterials[Index]);
+		}
+		Component->SetMobility(Source->Mobility);
+		Component->SetCollisionProfileName(Source->GetCollisionProfileName());
+		Component->SetupAttachment(Container->GetRootComponent());
+		Container->AddInstanceComponent(Component);
+		Component->RegisterComponent();
+		return Component;
+	}
+}
+
+FSelectionActionsController::FSelectionActionsController(TSharedPtr<FTransformController> InTransformController,
+                                                         TSharedPtr<FViewportRedrawController> InRedrawController)
 	: TransformController(InTransformController)
+	  , RedrawController(InRedrawController)
 {
 }
 
@@ -36,6 +120,16 @@ void FSelectionActionsController::DuplicateSelectedAndGrab() const
 		return;
 	}
 
+	TSharedPtr<FTransformController> TransformCtrl = TransformController.Pin();
+
+	// Large selections drag proxies of the originals, the copies are spawned in one batch on confirm
+	const int32 GhostDuplicateMinSelection = UBlend4RealSettings::Get()->GhostDuplicateMinSelection;
+	if (TransformCtrl.IsValid() && GhostDuplicateMinSelection > 0 && SelectedActors->Num() >= GhostDuplicateMinSelection)
+	{
+		TransformCtrl->BeginTransform(ETransformMode::Translation, MakeShared<FGhostDuplicateTransformHandler>());
+		return;
+	}
+
 	// Use Unreal's built-in duplication which:
 	// 1. Duplicates selected actors
 	// 2. Automatically selects the new duplicates
@@ -44,13 +138,113 @@ void FSelectionActionsController::DuplicateSelectedAndGrab() const
 	GUnrealEd->edactDuplicateSelected(World->GetCurrentLevel(), false);
 
 	// Now the new actors are selected, enter translation mode immediately
-	TSharedPtr<FTransformController> TransformCtrl = TransformController.Pin();
 	if (TransformCtrl.IsValid())
 	{
 		TransformCtrl->BeginTransform(ETransformMode::Translation);
 	}
 }
 
+void FSelectionActionsController::InstancedDuplicateSelectedAndGrab() const
+{
+	if (!GEditor)
+	{
+		return;
+	}
+
+	// Selection actions only work in Level Editor viewport
+	if (!Blend4RealUtils::IsLevelEditorViewportFocused())
+	{
+		return;
+	}
+
+	USelection* SelectedActors = GEditor->GetSelectedActors();
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	TSharedPtr<FTransformController> TransformCtrl = TransformController.Pin();
+	if (!SelectedActors || SelectedActors->Num() == 0 || !World || !TransformCtrl.IsValid())
+	{
+		return;
+	}
+
+	// One instance per selected static mesh actor
+	TArray<TWeakObjectPtr<const UStaticMeshComponent>> Sources;
+	TArray<FString> SkippedLabels;
+	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	{
+		const AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(*It);
+		const UStaticMeshComponent* Source = MeshActor ? MeshActor->GetStaticMeshComponent() : nullptr;
+		if (Source && Source->GetStaticMesh())
+		{
+			Sources.Add(Source);
+		}
+		else if (const AActor* Actor = Cast<AActor>(*It))
+		{
+			SkippedLabels.Add(Actor->GetActorLabel());
+		}
+	}
+
+	// The other actors can't be instanced, they are left out of the duplicate
+	if (SkippedLabels.Num() > 0)
+	{
+		constexpr int32 MaxListedLabels = 5;
+		FString Listed = FString::Join(TArrayView<const FString>(SkippedLabels).Left(MaxListedLabels), TEXT(", "));
+		if (SkippedLabels.Num() > MaxListedLabels)
+		{
+			Listed += FString::Printf(TEXT(" and %d more"), SkippedLabels.Num() - MaxListedLabels);
+		}
+		const FString Message = FString::Printf(
+			TEXT("Instanced duplicate only copies static mesh actors, %d actor(s) skipped: %s"), SkippedLabels.Num(),
+			*Listed);
+		UE_LOG(LogTemp, Warning, TEXT("Blend4Real: %s"), *Message);
+
+		FNotificationInfo Info(FText::FromString(Message));
+		Info.ExpireDuration = 5.f;
+		FSlateNotificationManager::Get().AddNotification(Info);
+	}
+
+	if (Sources.Num() == 0)
+	{
+		return;
+	}
+
+	// The instances are added when the grab begins, inside its transaction, grouped by mesh and materials
+	auto AddInstances = [Sources, WeakWorld = TWeakObjectPtr<UWorld>(World)]()
+	{
+		TMap<UInstancedStaticMeshComponent*, TArray<int32>> NewInstances;
+		AActor* Container = WeakWorld.IsValid() ? FindOrCreateInstanceContainer(WeakWorld.Get()) : nullptr;
+		if (!Container)
+		{
+			return NewInstances;
+		}
+
+		TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<FTransform>> NewInstanceTransforms;
+		for (const TWeakObjectPtr<const UStaticMeshComponent>& Source : Sources)
+		{
+			if (Source.IsValid())
+			{
+				NewInstanceTransforms.FindOrAdd(FindOrCreateInstanceComponent(Container, Source.Get()))
+				                     .Add(Source->GetComponentTransform());
+			}
+		}
+
+		int32 NumInstances = 0;
+		for (const TPair<UHierarchicalInstancedStaticMeshComponent*, TArray<FTransform>>& Pair : NewInstanceTransforms)
+		{
+			Pair.Key->Modify();
+			NewInstances.Add(Pair.Key, Pair.Key->AddInstances(Pair.Value, true, true));
+			NumInstances += Pair.Value.Num();
+		}
+		UE_LOG(LogTemp, Display, TEXT("Blend4Real: Instanced %d actors into %d components"), NumInstances,
+		       NewInstances.Num());
+		return NewInstances;
+	};
+
+	// The instances are grabbed instead of the sources
+	GEditor->SelectNone(true, true, false);
+	TransformCtrl->BeginTransform(ETransformMode::Translation,
+	                              MakeShared<FInstanceTransformHandler>(Sources.Num(), AddInstances,
+	                                                                    FText::FromString("Instanced Duplicate")));
+}
+
 void FSelectionActionsController::DeleteSelected()
 {
 	if (!GEditor || !GUnrealEd)
@@ -81,3 +275,361 @@ void FSelectionActionsController::DeleteSelected()
 	GUnrealEd->edactDeleteSelected(World);
 	GEditor->EndTransaction();
 }
+
+void FSelectionActionsController::DropSelectedToSurface()
+{
+	if (!GEditor || PendingDrops.Num() > 0)
+	{
+		return;
+	}
+
+	// Selection actions only work in Level Editor viewport
+	if (!Blend4RealUtils::IsLevelEditorViewportFocused())
+	{
+		return;
+	}
+
+	USelection* SelectedActors = GEditor->GetSelectedActors();
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	if (!SelectedActors || SelectedActors->Num() == 0 || !World)
+	{
+		return;
+	}
+
+	const UBlend4RealSettings* Settings = UBlend4RealSettings::Get();
+	DropDirection = Settings->GetDropDirectionVector();
+	bDropAlignToNormal = Settings->bDropAlignToNormal;
+	DropWorld = World;
+	DropIssueTime = FPlatformTime::Seconds();
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(Blend4RealDropToSurface), false);
+	DropTraceFilter.BeginFromEditorSelection();
+	DropTraceFilter.ApplyTo(Params);
+
+	// All sweeps are issued at once and run in parallel with the frame
+	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	{
+		AActor* Actor = Cast<AActor>(*It);
+		if (!Actor)
+		{
+			continue;
+		}
+
+		FVector Origin, Extent;
+		Actor->GetActorBounds(false, Origin, Extent, true);
+		const FCollisionShape Box = FCollisionShape::MakeBox(
+			FVector::Max(Extent - FVector(DropSweepSkin), FVector(DropSweepSkin)));
+		const FVector End = Origin + DropDirection * Blend4RealUtils::ScenePickDistance;
+
+		FPendingDrop& Drop = PendingDrops.AddDefaulted_GetRef();
+		Drop.Actor = Actor;
+		Drop.Sweep = World->AsyncSweepByChannel(EAsyncTraceType::Single, Origin, End, FQuat::Identity, ECC_Camera,
+		                                        Box, Params);
+	}
+
+	if (PendingDrops.Num() == 0)
+	{
+		DropTraceFilter.End();
+	}
+}
+
+void FSelectionActionsController::RepeatLastTransform()
+{
+	if (!GEditor || IsRepeating())
+	{
+		return;
+	}
+
+	// Selection actions only work in Level Editor viewport
+	if (!Blend4RealUtils::IsLevelEditorViewportFocused())
+	{
+		return;
+	}
+
+	USelection* SelectedActors = GEditor->GetSelectedActors();
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	TSharedPtr<FTransformController> TransformCtrl = TransformController.Pin();
+	if (!SelectedActors || SelectedActors->Num() == 0 || !World || !TransformCtrl.IsValid())
+	{
+		return;
+	}
+
+	const FRepeatableTransform& LastTransform = TransformCtrl->GetLastTransform();
+	if (LastTransform.Mode == ETransformMode::None)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Blend4Real: No confirmed transform to repeat"));
+		return;
+	}
+
+	for (FSelectionIterator It(*SelectedActors); It; ++It)
+	{
+		if (AActor* Actor = Cast<AActor>(*It))
+		{
+			RepeatSources.Add(Actor);
+			RepeatSourceTransforms.Add(Actor->GetActorTransform());
+		}
+	}
+	if (RepeatSources.Num() == 0)
+	{
+		return;
+	}
+
+	// Each copy is moved from the previous one, around its own pivot
+	const int32 NumCopies = FMath::Max(UBlend4RealSettings::Get()->RepeatLastCount, 1);
+	FTransform Pivot = Blend4RealUtils::ComputeSelectionPivot();
+	RepeatPivots.Add(Pivot);
+	for (int32 Copy = 0; Copy < NumCopies; ++Copy)
+	{
+		Pivot = LastTransform.ApplyTo(Pivot);
+		RepeatPivots.Add(Pivot);
+	}
+
+	RepeatLevel = World->GetCurrentLevel();
+	bRepeatTranslationOnly = LastTransform.IsTranslationOnly();
+	NextRepeatCopy = 1;
+	RepeatTransactionIndex = GEditor->BeginTransaction(TEXT(""), FText::FromString("Repeat Last"), nullptr);
+	RepeatProgress = FSlateNotificationManager::Get().StartProgressNotification(
+		FText::FromString("Repeat Last (Esc to cancel)"), NumCopies);
+}
+
+void FSelectionActionsController::TickRepeat()
+{
+	ULevel* Level = RepeatLevel.Get();
+	if (!GEditor || !Level)
+	{
+		CancelRepeat();
+		return;
+	}
+
+	// The sources still alive, with their index in RepeatSourceTransforms
+	TArray<AActor*> Sources;
+	TArray<int32> SourceIndices;
+	for (int32 Index = 0; Index < RepeatSources.Num(); ++Index)
+	{
+		if (AActor* Source = RepeatSources[Index].Get())
+		{
+			Sources.Add(Source);
+			SourceIndices.Add(Index);
+		}
+	}
+
+	// Each copy of the selection is pasted in one batch, at least one per frame
+	const double Budget = UBlend4RealSettings::Get()->RepeatLastFrameBudgetMs / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumCopies = RepeatPivots.Num() - 1;
+	while (Sources.Num() > 0 && NextRepeatCopy <= NumCopies && FPlatformTime::Seconds() - StartTime < Budget)
+	{
+		const int32 Copy = NextRepeatCopy++;
+		const FTransform CopyDelta = RepeatPivots[0].Inverse() * RepeatPivots[Copy];
+
+		// Translated copies are pasted at their final location, others are moved once pasted
+		TArray<AActor*> NewActors;
+		Blend4RealUtils::DuplicateActorsInOrder(Sources, Level,
+		                                        bRepeatTranslationOnly
+			                                        ? RepeatPivots[Copy].GetLocation() - RepeatPivots[0].GetLocation()
+			                                        : FVector::ZeroVector,
+		                                        NewActors);
+		for (int32 Index = 0; Index < NewActors.Num(); ++Index)
+		{
+			AActor* NewActor = NewActors[Index];
+			if (!NewActor)
+			{
+				continue;
+			}
+
+			const FTransform CopyTransform = RepeatSourceTransforms[SourceIndices[Index]] * CopyDelta;
+			if (!bRepeatTranslationOnly && !CopyTransform.ContainsNaN())
+			{
+				NewActor->SetActorTransform(CopyTransform, false, nullptr, ETeleportType::None);
+				NewActor->PostEditMove(true);
+			}
+			RepeatCopies.Add(NewActor);
+			if (Copy == NumCopies)
+			{
+				RepeatLastCopies.Add(NewActor);
+			}
+		}
+	}
+
+	FSlateNotificationManager::Get().UpdateProgressNotification(RepeatProgress, NextRepeatCopy - 1);
+	if (Sources.Num() == 0 || NextRepeatCopy > NumCopies)
+	{
+		FinishRepeat();
+	}
+}
+
+void FSelectionActionsController::FinishRepeat()
+{
+	GEditor->EndTransaction();
+
+	// The last copy is selected, so repeating again continues the array
+	GEditor->SelectNone(false, true, false);
+	for (const TWeakObjectPtr<AActor>& Copy : RepeatLastCopies)
+	{
+		if (AActor* Actor = Copy.Get())
+		{
+			GEditor->SelectActor(Actor, true, false);
+		}
+	}
+	GEditor->NoteSelectionChange();
+	RedrawController->RequestFullRedraw();
+
+	UE_LOG(LogTemp, Display, TEXT("Blend4Real: Repeat last created %d actors"), RepeatCopies.Num());
+	ResetRepeat();
+}
+
+void FSelectionActionsController::CancelRepeat()
+{
+	if (!IsRepeating())
+	{
+		return;
+	}
+
+	for (const TWeakObjectPtr<AActor>& Copy : RepeatCopies)
+	{
+		AActor* Actor = Copy.Get();
+		if (UWorld* World = Actor ? Actor->GetWorld() : nullptr)
+		{
+			World->EditorDestroyActor(Actor, true);
+		}
+	}
+	if (GEditor && RepeatTransactionIndex >= 0)
+	{
+		GEditor->CancelTransaction(RepeatTransactionIndex);
+		RedrawController->RequestFullRedraw();
+	}
+	FSlateNotificationManager::Get().CancelProgressNotification(RepeatProgress);
+
+	UE_LOG(LogTemp, Display, TEXT("Blend4Real: Repeat last cancelled"));
+	ResetRepeat();
+}
+
+void FSelectionActionsController::CancelPendingOperations()
+{
+	CancelRepeat();
+
+	// Sweep results still in flight are discarded with their handles
+	if (PendingDrops.Num() > 0)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Blend4Real: Drop to surface cancelled"));
+		PendingDrops.Reset();
+		DropTraceFilter.End();
+	}
+}
+
+void FSelectionActionsController::ResetRepeat()
+{
+	RepeatSources.Reset();
+	RepeatSourceTransforms.Reset();
+	RepeatPivots.Reset();
+	RepeatCopies.Reset();
+	RepeatLastCopies.Reset();
+	RepeatLevel.Reset();
+	NextRepeatCopy = 0;
+	RepeatTransactionIndex = -1;
+	RepeatProgress = FProgressNotificationHandle();
+}
+
+void FSelectionActionsController::Tick()
+{
+	if (IsRepeating())
+	{
+		TickRepeat();
+	}
+
+	if (PendingDrops.Num() == 0)
+	{
+		return;
+	}
+
+	UWorld* World = DropWorld.Get();
+	if (!World)
+	{
+		PendingDrops.Reset();
+		DropTraceFilter.End();
+		return;
+	}
+
+	bool bAllCompleted = true;
+	for (FPendingDrop& Drop : PendingDrops)
+	{
+		FTraceDatum Datum;
+		if (!Drop.bCompleted && World->QueryTraceData(Drop.Sweep, Datum))
+		{
+			Drop.bCompleted = true;
+			if (Datum.OutHits.Num() > 0)
+			{
+				Drop.Hit = Datum.OutHits[0];
+			}
+		}
+		bAllCompleted &= Drop.bCompleted;
+	}
+
+	if (bAllCompleted || FPlatformTime::Seconds() - DropIssueTime > MaxPendingDropAge)
+	{
+		ApplyDrops();
+	}
+}
+
+void FSelectionActionsController::ApplyDrops()
+{
+	DropTraceFilter.End();
+
+	int32 NumDropped = 0;
+	int32 NumTimedOut = 0;
+	if (GEditor)
+	{
+		GEditor->BeginTransaction(TEXT(""), FText::FromString("Drop to Surface"), nullptr);
+		for (const FPendingDrop& Drop : PendingDrops)
+		{
+			NumTimedOut += Drop.bCompleted ? 0 : 1;
+			AActor* Actor = Drop.Actor.Get();
+			if (!Actor || !Drop.Hit.IsValidBlockingHit())
+			{
+				continue;
+			}
+
+			// Distance to move along the drop direction, negative to get out of a surface the actor starts in
+			double Distance = Drop.Hit.Distance;
+			if (Drop.Hit.bStartPenetrating)
+			{
+				const double Facing = Drop.Hit.Normal | -DropDirection;
+				if (Facing < MinPenetrationFacing)
+				{
+					continue;
+				}
+				Distance = -Drop.Hit.PenetrationDepth / Facing;
+			}
+
+			Actor->Modify();
+			FRotator Rotation = Actor->GetActorRotation();
+			if (bDropAlignToNormal)
+			{
+				// Turn the side facing the drop direction towards the surface
+				const FQuat Alignment = FQuat::FindBetweenNormals(-DropDirection, Drop.Hit.ImpactNormal);
+				Rotation = (Alignment * Actor->GetActorQuat()).Rotator();
+			}
+			Actor->SetActorLocationAndRotation(Actor->GetActorLocation() + DropDirection * Distance, Rotation,
+			                                   false, nullptr, ETeleportType::None);
+			Actor->PostEditMove(true);
+			++NumDropped;
+		}
+		GEditor->EndTransaction();
+		RedrawController->RequestFullRedraw();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Blend4Real: dropped %d of %d actors to surface"), NumDropped, PendingDrops.Num());
+
+	// The drop is kept for the actors whose sweep completed, the others are reported as not moved
+	if (NumTimedOut > 0)
+	{
+		const FString Message = FString::Printf(
+			TEXT("Drop to surface timed out: %d of %d actors were not moved"), NumTimedOut, PendingDrops.Num());
+		UE_LOG(LogTemp, Warning, TEXT("Blend4Real: %s"), *Message);
+
+		FNotificationInfo Info(FText::FromString(Message));
+		Info.ExpireDuration = 5.f;
+		FSlateNotificationManager::Get().AddNotification(Info);
+	}
+	PendingDrops.Reset();
+}
@@ -0,0 +1,172 @@
+#include "FSelectionTraceFilter.h"
+#include "Blend4RealSettings.h"
+#include "Editor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/Selection.h"
+
+FMaskFilter FSelectionTraceFilter::GetSelectionMaskFilter()
+{
+	// Only NumExtraFilterBits (6) bits are kept by the collision filter data, higher bits would never match
+	return static_cast<FMaskFilter>(1 << FMath::Clamp(UBlend4RealSettings::Get()->SelectionMaskFilterBit, 0, 5));
+}
+
+void FSelectionTraceFilter::BeginFromEditorSelection()
+{
+	End();
+	MaskFilter = GetSelectionMaskFilter();
+	if (!GEditor)
+	{
+		return;
+	}
+
+	for (FSelectionIterator It(*GEditor->GetSelectedActors()); It; ++It)
+	{
+		if (const AActor* Actor = Cast<AActor>(*It))
+		{
+			Actor->ForEachComponent<UPrimitiveComponent>(true, [this](UPrimitiveComponent* Component)
+			{
+				Tag(Component);
+			});
+		}
+	}
+
+	// Selected components move with their children
+	for (FSelectionIterator It(*GEditor->GetSelectedComponents()); It; ++It)
+	{
+		if (USceneComponent* Component = Cast<USceneComponent>(*It))
+		{
+			Tag(Cast<UPrimitiveComponent>(Component));
+			TArray<USceneComponent*> Children;
+			Component->GetChildrenComponents(true, Children);
+			for (USceneComponent* Child : Children)
+			{
+				Tag(Cast<UPrimitiveComponent>(Child));
+			}
+		}
+	}
+}
+
+bool FSelectionTraceFilter::BeginFromComponents(const TArray<TWeakObjectPtr<UPrimitiveComponent>>& Components)
+{
+	End();
+	MaskFilter = GetSelectionMaskFilter();
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Component : Components)
+	{
+		if (!Component.IsValid())
+		{
+			End();
+			return false;
+		}
+		Tag(Component.Get());
+	}
+	return true;
+}
+
+void FSelectionTraceFilter::Tag(UPrimitiveComponent* Component)
+{
+	if (!Component || PreviousFilters.Contains(Component))
+	{
+		return;
+	}
+
+	const FMaskFilter PreviousFilter = Component->GetBodyInstance() ? Component->GetBodyInstance()->GetMaskFilter() : 0;
+	PreviousFilters.Add(Component, PreviousFilter);
+	Component->SetMaskFilterOnBodyInstance(PreviousFilter | MaskFilter);
+
+	// PostEditMove reruns the construction script while dragging, the recreated components lose the bit
+	const AActor* Owner = Component->GetOwner();
+	if (Owner && Owner->bRunConstructionScriptOnDrag && Cast<UBlueprintGeneratedClass>(Owner->GetClass()))
+	{
+		IgnoredActors.AddUnique(Owner);
+	}
+}
+
+void FSelectionTraceFilter::TagInstances(UInstancedStaticMeshComponent* Component, const TArray<int32>& Indices)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	// Physics traces hit the instance bodies, the other instances of the component stay traceable
+	FTaggedInstances& Tagged = TaggedInstances.AddDefaulted_GetRef();
+	Tagged.Component = Component;
+	Tagged.Indices.Reserve(Indices.Num());
+	Tagged.PreviousFilters.Reserve(Indices.Num());
+	for (const int32 Index : Indices)
+	{
+		FBodyInstance* Body = Component->InstanceBodies.IsValidIndex(Index) ? Component->InstanceBodies[Index] : nullptr;
+		if (Body)
+		{
+			Tagged.Indices.Add(Index);
+			Tagged.PreviousFilters.Add(Body->GetMaskFilter());
+			Body->SetMaskFilter(Body->GetMaskFilter() | MaskFilter);
+		}
+	}
+}
+
+void FSelectionTraceFilter::ApplyTo(FCollisionQueryParams& Params) const
+{
+	Params.IgnoreMask |= MaskFilter;
+	for (const TWeakObjectPtr<const AActor>& Actor : IgnoredActors)
+	{
+		if (Actor.IsValid())
+		{
+			Params.AddIgnoredActor(Actor.Get());
+		}
+	}
+}
+
+void FSelectionTraceFilter::GetTaggedComponents(TArray<TWeakObjectPtr<UPrimitiveComponent>>& OutComponents) const
+{
+	PreviousFilters.GetKeys(OutComponents);
+}
+
+void FSelectionTraceFilter::End()
+{
+	for (const TPair<TWeakObjectPtr<UPrimitiveComponent>, FMaskFilter>& Pair : PreviousFilters)
+	{
+		if (UPrimitiveComponent* Component = Pair.Key.Get())
+		{
+			Component->SetMaskFilterOnBodyInstance(Pair.Value);
+		}
+	}
+	PreviousFilters.Reset();
+
+	// Instances removed since (e.g. undone) no longer have a body
+	for (const FTaggedInstances& Tagged : TaggedInstances)
+	{
+		UInstancedStaticMeshComponent* Component = Tagged.Component.Get();
+		for (int32 Item = 0; Component && Item < Tagged.Indices.Num(); ++Item)
+		{
+			const int32 Index = Tagged.Indices[Item];
+			if (FBodyInstance* Body = Component->InstanceBodies.IsValidIndex(Index) ? Component->InstanceBodies[Index] : nullptr)
+			{
+				Body->SetMaskFilter(Tagged.PreviousFilters[Item]);
+			}
+		}
+	}
+	TaggedInstances.Reset();
+	IgnoredActors.Reset();
+}
+
+bool FSelectionTraceFilter::IsIgnored(const UPrimitiveComponent* Component, const FCollisionQueryParams& Params)
+{
+	if (!Component)
+	{
+		return true;
+	}
+
+	const FBodyInstance* BodyInstance = Component->GetBodyInstance();
+	if (BodyInstance && (BodyInstance->GetMaskFilter() & Params.IgnoreMask) != 0)
+	{
+		return true;
+	}
+
+	// Params built by other callers may still use the ignore lists
+	const AActor* Owner = Component->GetOwner();
+	return (Owner && Params.GetIgnoredActors().Num() > 0 && Params.GetIgnoredActors().Contains(Owner->GetUniqueID()))
+		|| (Params.GetIgnoredComponents().Num() > 0 && Params.GetIgnoredComponents().Contains(Component->GetUniqueID()));
+}
@@ -1,87 +1,125 @@
 #include "FSplinePointTransformHandler.h"
 #include "Components/SplineComponent.h"
 #include "Editor.h"
+#include "Blend4RealSettings.h"
 
 FSplinePointTransformHandler::FSplinePointTransformHandler(USplineComponent* InSplineComp, const TSet<int32>& InSelectedKeys)
-	: SplineComponent(InSplineComp)
-	, SelectedPointIndices(InSelectedKeys)
+	: FSplinePointTransformHandler(TMap<USplineComponent*, TSet<int32>>{{InSplineComp, InSelectedKeys}})
 {
 }
 
+FSplinePointTransformHandler::FSplinePointTransformHandler(const TMap<USplineComponent*, TSet<int32>>& InSelectedKeys)
+{
+	for (const TPair<USplineComponent*, TSet<int32>>& Pair : InSelectedKeys)
+	{
+		if (Pair.Key && Pair.Value.Num() > 0)
+		{
+			FSplineGroup& Group = Groups.AddDefaulted_GetRef();
+			Group.SplineComponent = Pair.Key;
+			Group.SelectedPointIndices = Pair.Value;
+			NumSelectedPoints += Pair.Value.Num();
+		}
+	}
+}
+
 bool FSplinePointTransformHandler::HasSelection() const
 {
-	return SplineComponent.IsValid() && SelectedPointIndices.Num() > 0;
+	for (const FSplineGroup& Group : Groups)
+	{
+		if (Group.SplineComponent.IsValid())
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
 int32 FSplinePointTransformHandler::GetSelectionCount() const
 {
-	return SelectedPointIndices.Num();
+	return NumSelectedPoints;
 }
 
 FTransform FSplinePointTransformHandler::ComputeSelectionPivot() const
 {
-	if (!SplineComponent.IsValid() || SelectedPointIndices.Num() == 0)
-	{
-		return FTransform::Identity;
-	}
-
 	FVector Pivot = FVector::ZeroVector;
 	FQuat Rotation = FQuat::Identity;
+	int32 Count = 0;
 
-	for (int32 Index : SelectedPointIndices)
+	for (const FSplineGroup& Group : Groups)
 	{
-		Pivot += SplineComponent->GetLocationAtSplinePoint(Index, ESplineCoordinateSpace::World);
+		const USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
+		{
+			continue;
+		}
+
+		// Points captured by CaptureInitialState(), the spline is only queried before a transform begins
+		const bool bCaptured = Group.InitialPointStates.Num() == Group.SelectedPointIndices.Num();
+		for (int32 Index : Group.SelectedPointIndices)
+		{
+			Pivot += bCaptured
+				         ? Group.InitialPointStates[Index].Location
+				         : SplineComponent->GetLocationAtSplinePoint(Index, ESplineCoordinateSpace::World);
+			Count++;
+		}
+
+		// Use the rotation of the first selected point for single selection
+		if (NumSelectedPoints == 1)
+		{
+			const int32 FirstIndex = *Group.SelectedPointIndices.CreateConstIterator();
+			Rotation = bCaptured
+				           ? Group.InitialPointStates[FirstIndex].Rotation
+				           : SplineComponent->GetQuaternionAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World);
+		}
 	}
-	Pivot /= SelectedPointIndices.Num();
 
-	// Use the rotation of the first selected point for single selection
-	if (SelectedPointIndices.Num() == 1)
+	if (Count == 0)
 	{
-		const int32 FirstIndex = *SelectedPointIndices.CreateConstIterator();
-		Rotation = SplineComponent->GetQuaternionAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World);
+		return FTransform::Identity;
 	}
 
-	return FTransform(Rotation, Pivot, FVector::OneVector);
+	return FTransform(Rotation, Pivot / Count, FVector::OneVector);
 }
 
 FTransform FSplinePointTransformHandler::GetFirstSelectedItemTransform() const
 {
-	if (!SplineComponent.IsValid() || SelectedPointIndices.Num() == 0)
+	for (const FSplineGroup& Group : Groups)
 	{
-		return FTransform::Identity;
-	}
+		const USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
+		{
+			continue;
+		}
 
-	const int32 FirstIndex = *SelectedPointIndices.CreateConstIterator();
-	const FPointState* State = InitialPointStates.Find(FirstIndex);
-	if (State)
-	{
-		return FTransform(State->Rotation, State->Location, State->Scale);
+		const int32 FirstIndex = *Group.SelectedPointIndices.CreateConstIterator();
+		const FPointState* State = Group.InitialPointStates.Find(FirstIndex);
+		if (State)
+		{
+			return FTransform(State->Rotation, State->Location, State->Scale);
+		}
+
+		// Fallback to current state
+		return FTransform(
+			SplineComponent->GetQuaternionAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World),
+			SplineComponent->GetLocationAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World),
+			SplineComponent->GetScaleAtSplinePoint(FirstIndex)
+		);
 	}
 
-	// Fallback to current state
-	return FTransform(
-		SplineComponent->GetQuaternionAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World),
-		SplineComponent->GetLocationAtSplinePoint(FirstIndex, ESplineCoordinateSpace::World),
-		SplineComponent->GetScaleAtSplinePoint(FirstIndex)
-	);
+	return FTransform::Identity;
 }
 
 FVector FSplinePointTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis) const
 {
-	if (!SplineComponent.IsValid() || SelectedPointIndices.Num() == 0)
-	{
-		return FVector::ZeroVector;
-	}
-
 	// Accumulate axis vectors from each selected spline point
 	FVector AccumulatedAxis = FVector::ZeroVector;
 	int32 Count = 0;
 
-	for (int32 Index : SelectedPointIndices)
+	for (const FSplineGroup& Group : Groups)
 	{
-		if (const FPointState* State = InitialPointStates.Find(Index))
+		for (const TPair<int32, FPointState>& Pair : Group.InitialPointStates)
 		{
-			const FQuat Rotation = State->Rotation;
+			const FQuat Rotation = Pair.Value.Rotation;
 			FVector AxisVector;
 
 			switch (Axis)
@@ -115,60 +153,88 @@ FVector FSplinePointTransformHandler::ComputeAverageLocalAxis(EAxis::Type Axis)
 
 void FSplinePointTransformHandler::CaptureInitialState()
 {
-	InitialPointStates.Empty();
-
-	if (!SplineComponent.IsValid())
+	for (FSplineGroup& Group : Groups)
 	{
-		return;
-	}
+		Group.InitialPointStates.Empty();
+		Group.bDirty = false;
 
-	for (int32 Index : SelectedPointIndices)
-	{
-		FPointState State;
-		State.Location = SplineComponent->GetLocationAtSplinePoint(Index, ESplineCoordinateSpace::World);
-		State.Rotation = SplineComponent->GetQuaternionAtSplinePoint(Index, ESplineCoordinateSpace::World);
-		State.Scale = SplineComponent->GetScaleAtSplinePoint(Index);
-		State.ArriveTangent = SplineComponent->GetArriveTangentAtSplinePoint(Index, ESplineCoordinateSpace::World);
-		State.LeaveTangent = SplineComponent->GetLeaveTangentAtSplinePoint(Index, ESplineCoordinateSpace::World);
-
-		InitialPointStates.Add(Index, State);
+		const USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
+		{
+			continue;
+		}
+
+		// Read from the curves in bulk, with one component transform, instead of evaluating the spline per point
+		const FSplineCurves& Curves = SplineComponent->SplineCurves;
+		const FTransform ComponentTransform = SplineComponent->GetComponentTransform();
+		const FVector UpVector = SplineComponent->GetDefaultUpVector(ESplineCoordinateSpace::Local);
+		Group.InitialPointStates.Reserve(Group.SelectedPointIndices.Num());
+
+		for (int32 Index : Group.SelectedPointIndices)
+		{
+			if (!Curves.Position.Points.IsValidIndex(Index))
+			{
+				continue;
+			}
+
+			const FInterpCurvePoint<FVector>& Position = Curves.Position.Points[Index];
+			const FQuat PointRotation = Curves.Rotation.Points.IsValidIndex(Index)
+				                            ? Curves.Rotation.Points[Index].OutVal
+				                            : FQuat::Identity;
+
+			// Same as GetQuaternionAtSplinePoint(): facing the tangent, rolled by the point rotation
+			const FVector& Tangent = Index + 1 < Curves.Position.Points.Num() || SplineComponent->IsClosedLoop()
+				                         ? Position.LeaveTangent
+				                         : Position.ArriveTangent;
+			const FQuat LocalRotation = FRotationMatrix::MakeFromXZ(
+				Tangent.GetSafeNormal(), PointRotation.RotateVector(UpVector)).ToQuat();
+
+			FPointState State;
+			State.Location = ComponentTransform.TransformPosition(Position.OutVal);
+			State.Rotation = ComponentTransform.GetRotation() * LocalRotation;
+			State.Scale = Curves.Scale.Points.IsValidIndex(Index) ? Curves.Scale.Points[Index].OutVal : FVector::OneVector;
+			State.ArriveTangent = ComponentTransform.TransformVector(Position.ArriveTangent);
+			State.LeaveTangent = ComponentTransform.TransformVector(Position.LeaveTangent);
+
+			Group.InitialPointStates.Add(Index, State);
+		}
 	}
 }
 
 void FSplinePointTransformHandler::RestoreInitialState()
 {
-	if (!SplineComponent.IsValid())
+	for (FSplineGroup& Group : Groups)
 	{
-		return;
-	}
+		USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
+		{
+			continue;
+		}
 
-	for (const auto& Pair : InitialPointStates)
-	{
-		const int32 Index = Pair.Key;
-		const FPointState& State = Pair.Value;
+		for (const auto& Pair : Group.InitialPointStates)
+		{
+			const int32 Index = Pair.Key;
+			const FPointState& State = Pair.Value;
 
-		SplineComponent->SetLocationAtSplinePoint(Index, State.Location, ESplineCoordinateSpace::World, false);
-		SplineComponent->SetRotationAtSplinePoint(Index, State.Rotation.Rotator(), ESplineCoordinateSpace::World, false);
-		SplineComponent->SetScaleAtSplinePoint(Index, State.Scale, false);
-		SplineComponent->SetTangentsAtSplinePoint(Index, State.ArriveTangent, State.LeaveTangent, ESplineCoordinateSpace::World, false);
-	}
+			SplineComponent->SetLocationAtSplinePoint(Index, State.Location, ESplineCoordinateSpace::World, false);
+			SplineComponent->SetRotationAtSplinePoint(Index, State.Rotation.Rotator(), ESplineCoordinateSpace::World, false);
+			SplineComponent->SetScaleAtSplinePoint(Index, State.Scale, false);
+			SplineComponent->SetTangentsAtSplinePoint(Index, State.ArriveTangent, State.LeaveTangent, ESplineCoordinateSpace::World, false);
+		}
 
-	SplineComponent->UpdateSpline();
+		SplineComponent->UpdateSpline();
+		Group.bDirty = false;
 
-	// Notify owning actor that movement is complete (restored to original state)
-	if (AActor* Owner = SplineComponent->GetOwner())
-	{
-		Owner->PostEditMove(true);
+		// Notify owning actor that movement is complete (restored to original state)
+		if (AActor* Owner = SplineComponent->GetOwner())
+		{
+			Owner->PostEditMove(true);
+		}
 	}
 }
 
 void FSplinePointTransformHandler::ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform)
 {
-	if (!SplineComponent.IsValid())
-	{
-		return;
-	}
-
 	// Calculate deltas
 	const FVector DeltaTranslation = NewPivotTransform.GetLocation() - InitialPivot.GetLocation();
 	const FQuat DeltaRotation = NewPivotTransform.GetRotation() * InitialPivot.GetRotation().Inverse();
@@ -176,92 +242,129 @@ void FSplinePointTransformHandler::ApplyTransformAroundPivot(const FTransform& I
 
 	const FVector PivotLocation = InitialPivot.GetLocation();
 
-	for (int32 Index : SelectedPointIndices)
+	for (FSplineGroup& Group : Groups)
 	{
-		const FPointState* InitialState = InitialPointStates.Find(Index);
-		if (!InitialState)
+		USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
 		{
 			continue;
 		}
 
-		// Calculate position relative to pivot
-		const FVector InitialRelativeToPivot = InitialState->Location - PivotLocation;
+		for (const TPair<int32, FPointState>& Pair : Group.InitialPointStates)
+		{
+			const int32 Index = Pair.Key;
+			const FPointState& InitialState = Pair.Value;
 
-		// Apply rotation around pivot
-		const FVector RotatedOffset = DeltaRotation.RotateVector(InitialRelativeToPivot);
+			// Calculate position relative to pivot
+			const FVector InitialRelativeToPivot = InitialState.Location - PivotLocation;
 
-		// Apply scale around pivot
-		const FVector ScaledOffset = RotatedOffset * DeltaScale;
+			// Apply rotation around pivot
+			const FVector RotatedOffset = DeltaRotation.RotateVector(InitialRelativeToPivot);
 
-		// Calculate new world position
-		const FVector NewLocation = PivotLocation + DeltaTranslation + ScaledOffset;
+			// Apply scale around pivot
+			const FVector ScaledOffset = RotatedOffset * DeltaScale;
 
-		// Apply rotation to the point's own rotation
-		const FQuat NewRotation = DeltaRotation * InitialState->Rotation;
+			// Calculate new world position
+			const FVector NewLocation = PivotLocation + DeltaTranslation + ScaledOffset;
 
-		// Apply scale to tangents (for scale mode)
-		const FVector NewArriveTangent = DeltaRotation.RotateVector(InitialState->ArriveTangent) * DeltaScale.X;
-		const FVector NewLeaveTangent = DeltaRotation.RotateVector(InitialState->LeaveTangent) * DeltaScale.X;
+			// Apply rotation to the point's own rotation
+			const FQuat NewRotation = DeltaRotation * InitialState.Rotation;
 
-		// Set the new values (defer spline update until all points are modified)
-		SplineComponent->SetLocationAtSplinePoint(Index, NewLocation, ESplineCoordinateSpace::World, false);
-		SplineComponent->SetRotationAtSplinePoint(Index, NewRotation.Rotator(), ESplineCoordinateSpace::World, false);
-		SplineComponent->SetTangentsAtSplinePoint(Index, NewArriveTangent, NewLeaveTangent, ESplineCoordinateSpace::World, false);
-	}
+			// Apply scale to tangents (for scale mode)
+			const FVector NewArriveTangent = DeltaRotation.RotateVector(InitialState.ArriveTangent) * DeltaScale.X;
+			const FVector NewLeaveTangent = DeltaRotation.RotateVector(InitialState.LeaveTangent) * DeltaScale.X;
 
-	// Update spline once after all points are modified
-	SplineComponent->UpdateSpline();
-
-	// Notify owning actor of movement (for dependent systems like construction scripts)
-	if (AActor* Owner = SplineComponent->GetOwner())
-	{
-		Owner->PostEditMove(false);
+			// Set the new values, the spline is updated once per frame by FlushDeferredUpdates()
+			SplineComponent->SetLocationAtSplinePoint(Index, NewLocation, ESplineCoordinateSpace::World, false);
+			SplineComponent->SetRotationAtSplinePoint(Index, NewRotation.Rotator(), ESplineCoordinateSpace::World, false);
+			SplineComponent->SetTangentsAtSplinePoint(Index, NewArriveTangent, NewLeaveTangent, ESplineCoordinateSpace::World, false);
+		}
+		Group.bDirty = true;
 	}
 }
 
 void FSplinePointTransformHandler::SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale)
 {
-	if (!SplineComponent.IsValid())
+	for (FSplineGroup& Group : Groups)
 	{
-		return;
+		USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!SplineComponent)
+		{
+			continue;
+		}
+
+		for (int32 Index : Group.SelectedPointIndices)
+		{
+			if (Location)
+			{
+				SplineComponent->SetLocationAtSplinePoint(Index, *Location, ESplineCoordinateSpace::World, false);
+			}
+			if (Rotation)
+			{
+				SplineComponent->SetRotationAtSplinePoint(Index, *Rotation, ESplineCoordinateSpace::World, false);
+			}
+			if (Scale)
+			{
+				SplineComponent->SetScaleAtSplinePoint(Index, *Scale, false);
+			}
+		}
+
+		SplineComponent->UpdateSpline();
+
+		// Notify owning actor of movement (for dependent systems like construction scripts)
+		if (AActor* Owner = SplineComponent->GetOwner())
+		{
+			Owner->PostEditMove(false);
+		}
 	}
+}
 
-	for (int32 Index : SelectedPointIndices)
+void FSplinePointTransformHandler::FlushDeferredUpdates()
+{
+	for (FSplineGroup& Group : Groups)
 	{
-		if (Location)
+		USplineComponent* SplineComponent = Group.SplineComponent.Get();
+		if (!Group.bDirty || !SplineComponent)
 		{
-			SplineComponent->SetLocationAtSplinePoint(Index, *Location, ESplineCoordinateSpace::World, false);
+			continue;
 		}
-		if (Rotation)
+
+		// Update each spline once after all its points are modified
+		Group.bDirty = false;
+		if (UseIncrementalUpdates(Group))
 		{
-			SplineComponent->SetRotationAtSplinePoint(Index, *Rotation, ESplineCoordinateSpace::World, false);
+			UpdateModifiedSegments(Group);
 		}
-		if (Scale)
+		else
 		{
-			SplineComponent->SetScaleAtSplinePoint(Index, *Scale, false);
+			SplineComponent->UpdateSpline();
 		}
-	}
-
-	SplineComponent->UpdateSpline();
 
-	// Notify owning actor of movement (for dependent systems like construction scripts)
-	if (AActor* Owner = SplineComponent->GetOwner())
-	{
-		Owner->PostEditMove(false);
+		// Notify owning actor of movement (for dependent systems like construction scripts)
+		if (AActor* Owner = SplineComponent->GetOwner())
+		{
+			Owner->PostEditMove(false);
+		}
 	}
 }
 
 int32 FSplinePointTransformHandler::BeginTransaction(const FText& Description)
 {
-	if (!GEditor || !SplineComponent.IsValid())
+	if (!GEditor || !HasSelection())
 	{
 		return -1;
 	}
 
 	int32 TransactionIndex = GEditor->BeginTransaction(TEXT(""), Description, nullptr);
 
-	// Mark spline component for undo
-	SplineComponent->Modify();
+	// Mark spline components for undo, all in the same transaction
+	for (const FSplineGroup& Group : Groups)
+	{
+		if (USplineComponent* SplineComponent = Group.SplineComponent.Get())
+		{
+			SplineComponent->Modify();
+		}
+	}
 
 	return TransactionIndex;
 }
@@ -270,9 +373,22 @@ void FSplinePointTransformHandler::EndTransaction()
 {
 	if (GEditor)
 	{
-		// Notify owning actor that movement has finished
-		if (SplineComponent.IsValid())
+		for (FSplineGroup& Group : Groups)
 		{
+			USplineComponent* SplineComponent = Group.SplineComponent.Get();
+			if (!SplineComponent)
+			{
+				continue;
+			}
+
+			// Points not flushed yet, or drags that only updated the modified segments
+			if (Group.bDirty || UseIncrementalUpdates(Group))
+			{
+				SplineComponent->UpdateSpline();
+			}
+			Group.bDirty = false;
+
+			// Notify owning actor that movement has finished
 			if (AActor* Owner = SplineComponent->GetOwner())
 			{
 				Owner->PostEditMove(true);
@@ -290,3 +406,81 @@ void FSplinePointTransformHandler::CancelTransaction(int32 TransactionIndex)
 		GEditor->CancelTransaction(TransactionIndex);
 	}
 }
+
+bool FSplinePointTransformHandler::UseIncrementalUpdates(const FSplineGroup& Group)
+{
+	const int32 MinPoints = UBlend4RealSettings::Get()->IncrementalSplineMinPoints;
+	const USplineComponent* SplineComponent = Group.SplineComponent.Get();
+	return MinPoints > 0 && SplineComponent && SplineComponent->GetNumberOfSplinePoints() >= MinPoints;
+}
+
+void FSplinePointTransformHandler::UpdateModifiedSegments(const FSplineGroup& Group)
+{
+	USplineComponent* SplineComponent = Group.SplineComponent.Get();
+	FSplineCurves& Curves = SplineComponent->SplineCurves;
+	const bool bClosedLoop = SplineComponent->IsClosedLoop();
+	const int32 NumPoints = Curves.Position.Points.Num();
+	const int32 NumSegments = SplineComponent->GetNumberOfSplineSegments();
+	const int32 Steps = SplineComponent->ReparamStepsPerSegment;
+	TArray<FInterpCurvePoint<float>>& Reparam = Curves.ReparamTable.Points;
+
+	if (NumSegments == 0 || Steps <= 0 || Reparam.Num() != NumSegments * Steps + 1)
+	{
+		// Table not built for this layout yet
+		SplineComponent->UpdateSpline();
+		return;
+	}
+
+	// Automatic tangents of the neighbours depend on the moved points, they are cheap to compute compared to lengths
+	Curves.Position.AutoSetTangents(0.0f, SplineComponent->bStationaryEndpoints);
+	Curves.Rotation.AutoSetTangents(0.0f, SplineComponent->bStationaryEndpoints);
+	Curves.Scale.AutoSetTangents(0.0f, SplineComponent->bStationaryEndpoints);
+
+	// A point bounds the segment arriving to it and the one leaving it. Its neighbours' automatic tangents
+	// changed too, so the segments on both sides of them are dirty: Index - 2 to Index + 1
+	TArray<bool> DirtySegments;
+	DirtySegments.SetNumZeroed(NumSegments);
+	int32 FirstDirtySegment = NumSegments;
+	for (const int32 Index : Group.SelectedPointIndices)
+	{
+		for (int32 Segment = Index - 2; Segment <= Index + 1; ++Segment)
+		{
+			const int32 Wrapped = bClosedLoop ? (Segment + NumPoints) % NumPoints : Segment;
+			if (Wrapped >= 0 && Wrapped < NumSegments)
+			{
+				DirtySegments[Wrapped] = true;
+				FirstDirtySegment = FMath::Min(FirstDirtySegment, Wrapped);
+			}
+		}
+	}
+
+	// Dirty segments are measured again, the distance of the following entries moves by their length difference
+	const FVector Scale3D = SplineComponent->GetComponentTransform().GetScale3D();
+	float Offset = 0.0f;
+	for (int32 Segment = FirstDirtySegment; Segment < NumSegments; ++Segment)
+	{
+		const int32 First = Segment * Steps;
+		if (!DirtySegments[Segment])
+		{
+			for (int32 Step = 0; Step < Steps; ++Step)
+			{
+				Reparam[First + Step].InVal += Offset;
+			}
+			continue;
+		}
+
+		const float OldLength = Reparam[First + Steps].InVal - Reparam[First].InVal;
+		const float SegmentStart = Reparam[First].InVal + Offset;
+		Reparam[First].InVal = SegmentStart;
+		for (int32 Step = 1; Step < Steps; ++Step)
+		{
+			const float Param = static_cast<float>(Step) / Steps;
+			Reparam[First + Step].InVal = SegmentStart + Curves.GetSegmentLength(Segment, Param, bClosedLoop, Scale3D);
+		}
+		Offset += Curves.GetSegmentLength(Segment, 1.0f, bClosedLoop, Scale3D) - OldLength;
+	}
+	Reparam.Last().InVal += Offset;
+
+	// Lets caches keyed on the curves (e.g. the visualizer) see the change
+	++Curves.Version;
+}
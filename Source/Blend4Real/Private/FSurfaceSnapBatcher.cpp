@@ -0,0 +1,178 @@
+#include "FSurfaceSnapBatcher.h"
+#include "Blend4RealSettings.h"
+#include "Blend4RealUtils.h"
+#include "FMeshBVHPicker.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Margin above the highest item where the down traces start
+	constexpr double TraceStartMargin = 100.0;
+
+	// Traces not completed within this delay are dropped and issued again (e.g. the world stopped ticking)
+	constexpr double MaxPendingTraceAge = 1.0;
+}
+
+void FSurfaceSnapBatcher::Begin(UWorld* InWorld, const FCollisionQueryParams& InParams,
+                                const TMap<uint32, FTransform>& InitialTransforms)
+{
+	End();
+	World = InWorld;
+	Params = InParams;
+
+	double MinZ = TNumericLimits<double>::Max();
+	double MaxZ = TNumericLimits<double>::Lowest();
+	Items.Reserve(InitialTransforms.Num());
+	for (const TPair<uint32, FTransform>& Pair : InitialTransforms)
+	{
+		FItem& Item = Items.AddDefaulted_GetRef();
+		Item.Id = Pair.Key;
+		Item.Initial = Pair.Value;
+		Item.Target = Item.TracedTarget = Pair.Value.GetLocation();
+		Item.bUpToDate = true;
+		MinZ = FMath::Min(MinZ, Item.Target.Z);
+		MaxZ = FMath::Max(MaxZ, Item.Target.Z);
+	}
+	TraceStartHeight = Items.Num() > 0 ? MaxZ - MinZ + TraceStartMargin : TraceStartMargin;
+}
+
+void FSurfaceSnapBatcher::End()
+{
+	Items.Reset();
+	World.Reset();
+	NextIssueIndex = 0;
+	NumInFlight = 0;
+}
+
+void FSurfaceSnapBatcher::SetGroupTranslation(const FVector& Translation, const float InSurfaceOffset,
+                                              const bool bInAlignToNormal)
+{
+	SurfaceOffset = InSurfaceOffset;
+	bAlignToNormal = bInAlignToNormal;
+	for (FItem& Item : Items)
+	{
+		Item.Target = Item.Initial.GetLocation() + Translation;
+		Item.bUpToDate = Item.bUpToDate && Item.Target.Equals(Item.TracedTarget);
+	}
+}
+
+void FSurfaceSnapBatcher::GetTraceSegment(const FVector& Target, FVector& OutStart, FVector& OutEnd) const
+{
+	// Items are translated with the group, so they can be up to the group height below their surface
+	OutStart = Target + FVector::UpVector * TraceStartHeight;
+	OutEnd = Target - FVector::UpVector * Blend4RealUtils::ScenePickDistance;
+}
+
+void FSurfaceSnapBatcher::IssueTrace(FItem& Item, const double Now)
+{
+	FVector Start, End;
+	GetTraceSegment(Item.Target, Start, End);
+	Item.Trace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Camera, Params);
+	Item.TracedTarget = Item.Target;
+	Item.IssueTime = Now;
+	Item.bUpToDate = true;
+	++NumInFlight;
+}
+
+FTransform FSurfaceSnapBatcher::MakeItemTransform(const FItem& Item, const FVector& Target, const FHitResult& Hit) const
+{
+	FTransform Transform = Item.Initial;
+	if (!Hit.IsValidBlockingHit())
+	{
+		// Nothing below: follow the group
+		Transform.SetLocation(Target);
+		return Transform;
+	}
+
+	Transform.SetLocation(Hit.Location + Hit.Normal * SurfaceOffset);
+	if (bAlignToNormal)
+	{
+		Transform.SetRotation(FRotationMatrix::MakeFromZ(Hit.Normal).ToQuat());
+	}
+	return Transform;
+}
+
+bool FSurfaceSnapBatcher::Tick(TMap<uint32, FTransform>& OutTransforms)
+{
+	UWorld* TraceWorld = World.Get();
+	if (!TraceWorld || Items.Num() == 0)
+	{
+		return false;
+	}
+
+	const bool bPickMeshesWithoutCollision = UBlend4RealSettings::Get()->bPickMeshesWithoutCollision;
+	const double Now = FPlatformTime::Seconds();
+
+	// Collect the traces issued on previous frames
+	for (FItem& Item : Items)
+	{
+		if (!Item.Trace.IsValid())
+		{
+			continue;
+		}
+
+		FTraceDatum Datum;
+		if (TraceWorld->QueryTraceData(Item.Trace, Datum))
+		{
+			FHitResult Hit = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+			if (bPickMeshesWithoutCollision)
+			{
+				FMeshBVHPicker::Trace(TraceWorld, Datum.Start, FVector::DownVector, Params,
+				                      (Datum.End - Datum.Start).Size(), Hit);
+			}
+			OutTransforms.Add(Item.Id, MakeItemTransform(Item, Item.TracedTarget, Hit));
+		}
+		else if (Now - Item.IssueTime > MaxPendingTraceAge)
+		{
+			Item.bUpToDate = false;
+		}
+		else
+		{
+			continue;
+		}
+		Item.Trace = FTraceHandle();
+		--NumInFlight;
+	}
+
+	// Issue the traces of the items that moved, up to the in-flight cap
+	const int32 MaxInFlight = FMath::Max(UBlend4RealSettings::Get()->MaxSurfaceSnapTracesInFlight, 1);
+	for (int32 Count = 0; Count < Items.Num() && NumInFlight < MaxInFlight; ++Count)
+	{
+		FItem& Item = Items[NextIssueIndex];
+		NextIssueIndex = (NextIssueIndex + 1) % Items.Num();
+		if (!Item.bUpToDate && !Item.Trace.IsValid())
+		{
+			IssueTrace(Item, Now);
+		}
+	}
+
+	return OutTransforms.Num() > 0;
+}
+
+void FSurfaceSnapBatcher::Flush(TMap<uint32, FTransform>& OutTransforms)
+{
+	UWorld* TraceWorld = World.Get();
+	if (!TraceWorld)
+	{
+		return;
+	}
+
+	for (FItem& Item : Items)
+	{
+		// Items with a trace in flight for an older target are traced again too
+		if (Item.bUpToDate && !Item.Trace.IsValid())
+		{
+			continue;
+		}
+
+		FVector Start, End;
+		GetTraceSegment(Item.Target, Start, End);
+		const FHitResult Hit = Blend4RealUtils::ProjectToSurface(TraceWorld, Start, FVector::DownVector, Params,
+		                                                         (End - Start).Size());
+		OutTransforms.Add(Item.Id, MakeItemTransform(Item, Item.Target, Hit));
+		Item.Trace = FTraceHandle();
+		Item.TracedTarget = Item.Target;
+		Item.bUpToDate = true;
+	}
+	NumInFlight = 0;
+}
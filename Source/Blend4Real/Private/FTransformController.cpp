@@ -2,11 +2,22 @@
 #include "Blend4RealUtils.h"
 #include "IBlend4RealTransformHandler.h"
 #include "FTransformHandlerFactory.h"
+#include "FActorBoundsTree.h"
+#include "FSelectionTraceFilter.h"
+#include "Blend4RealSettings.h"
+#include "FViewportRedrawController.h"
 #include "Editor.h"
 #include "EditorViewportClient.h"
 #include "Engine/Selection.h"
+#include "Engine/World.h"
 #include "Settings/LevelEditorViewportSettings.h"
 #include "Components/LineBatchComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "EditorModeManager.h"
+#include "InstancedFoliageActor.h"
+#include "SplineComponentVisualizer.h"
+#include "Elements/Framework/TypedElementSelectionSet.h"
+#include "Misc/CoreDelegates.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Widgets/SWindow.h"
 #include "Widgets/Text/STextBlock.h"
@@ -14,8 +25,102 @@
 
 using namespace Blend4RealUtils;
 
-FTransformController::FTransformController()
+FTransformController::FTransformController(TSharedPtr<FViewportRedrawController> InRedrawController)
+	: RedrawController(InRedrawController)
 {
+	// Any selection change, or undo, invalidates the session kept for chained transforms
+	SelectionChangedHandle = USelection::SelectionChangedEvent.AddRaw(this, &FTransformController::OnSelectionChanged);
+	SelectObjectHandle = USelection::SelectObjectEvent.AddRaw(this, &FTransformController::OnSelectionChanged);
+	SelectNoneHandle = USelection::SelectNoneEvent.AddRaw(this, &FTransformController::InvalidateSession);
+	UndoRedoHandle = FEditorDelegates::PostUndoRedo.AddRaw(this, &FTransformController::InvalidateSession);
+	// Foliage instances and spline points are selected by modifying their owner
+	ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &FTransformController::OnObjectModified);
+
+	// The element selection set and the mode tools exist once the editor is up
+	if (GEditor)
+	{
+		BindEditorSelectionEvents();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(
+			this, &FTransformController::BindEditorSelectionEvents);
+	}
+}
+
+FTransformController::~FTransformController()
+{
+	// The proportional editing toggle and radius are saved once, instead of on every toggle and confirm
+	if (bProportionalSettingsChanged && UObjectInitialized())
+	{
+		UBlend4RealSettings::Get()->SaveConfig();
+	}
+
+	USelection::SelectionChangedEvent.Remove(SelectionChangedHandle);
+	USelection::SelectObjectEvent.Remove(SelectObjectHandle);
+	USelection::SelectNoneEvent.Remove(SelectNoneHandle);
+	FEditorDelegates::PostUndoRedo.Remove(UndoRedoHandle);
+	FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	if (UTypedElementSelectionSet* SelectionSet = ElementSelectionSet.Get())
+	{
+		SelectionSet->OnChanged().Remove(ElementSelectionChangedHandle);
+	}
+	if (GEditor && EditorModeChangedHandle.IsValid())
+	{
+		GLevelEditorModeTools().OnEditorModeIDChanged().Remove(EditorModeChangedHandle);
+	}
+}
+
+void FTransformController::BindEditorSelectionEvents()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+	if (!GEditor)
+	{
+		return;
+	}
+
+	// Static mesh instances and other element selections
+	ElementSelectionSet = GEditor->GetSelectedActors()->GetElementSelectionSet();
+	if (UTypedElementSelectionSet* SelectionSet = ElementSelectionSet.Get())
+	{
+		ElementSelectionChangedHandle = SelectionSet->OnChanged().AddRaw(
+			this, &FTransformController::OnElementSelectionChanged);
+	}
+	// The handler depends on the active mode (e.g. foliage instances)
+	EditorModeChangedHandle = GLevelEditorModeTools().OnEditorModeIDChanged().AddRaw(
+		this, &FTransformController::OnEditorModeChanged);
+}
+
+void FTransformController::OnSelectionChanged(UObject* Object)
+{
+	InvalidateSession();
+}
+
+void FTransformController::OnElementSelectionChanged(const UTypedElementSelectionSet* SelectionSet)
+{
+	InvalidateSession();
+}
+
+void FTransformController::OnEditorModeChanged(const FName& ModeID, bool bIsEntering)
+{
+	InvalidateSession();
+}
+
+void FTransformController::OnObjectModified(UObject* Object)
+{
+	// Only the objects holding the foliage and spline point selections; the session takes the generation at the end
+	// of a transform, so the objects it modifies itself don't invalidate it
+	if (Object && (Object->IsA<USplineComponentVisualizerSelectionState>() || Object->IsA<AInstancedFoliageActor>()))
+	{
+		InvalidateSession();
+	}
+}
+
+void FTransformController::InvalidateSession()
+{
+	++SelectionGeneration;
 }
 
 void FTransformController::BeginTransform(const ETransformMode Mode)
@@ -25,8 +130,51 @@ void FTransformController::BeginTransform(const ETransformMode Mode)
 		return;
 	}
 
-	// Get appropriate handler for current viewport context
-	TransformHandler = FTransformHandlerFactory::CreateHandler();
+	// A transform chained on the same selection starts from the handler of the previous one
+	if (CanReuseSession() && Session.Handler->RecaptureInitialState())
+	{
+		BeginTransform(Mode, Session.Handler);
+	}
+	else
+	{
+		// Get appropriate handler for current viewport context
+		ReleaseSession();
+		BeginTransform(Mode, FTransformHandlerFactory::CreateHandler());
+	}
+
+	// Handlers given by other operations (e.g. duplicate) aren't kept
+	bKeepSession = bIsTransforming;
+}
+
+bool FTransformController::CanReuseSession() const
+{
+	return Session.Handler.IsValid()
+		&& Session.SelectionGeneration == SelectionGeneration
+		&& Session.ViewportClient == GetFocusedViewportClient();
+}
+
+void FTransformController::ReleaseSession()
+{
+	Session = FTransformSession();
+}
+
+void FTransformController::BeginTransform(const ETransformMode Mode,
+                                          TSharedPtr<IBlend4RealTransformHandler> Handler)
+{
+	if (!GEditor || bIsTransforming)
+	{
+		return;
+	}
+
+	const bool bReusedSession = Handler && Handler == Session.Handler;
+	if (!bReusedSession)
+	{
+		ReleaseSession();
+	}
+	bKeepSession = false;
+	bItemsMovedIndependently = false;
+
+	TransformHandler = Handler;
 	if (!TransformHandler || !TransformHandler->HasSelection())
 	{
 		TransformHandler.Reset();
@@ -41,6 +189,7 @@ void FTransformController::BeginTransform(const ETransformMode Mode)
 	}
 
 	bIsTransforming = true;
+	InteractingViewportClient = GetFocusedViewportClient();
 	CurrentMode = Mode;
 	CurrentAxis = ETransformAxis::None;
 	bIsNumericInput = false;
@@ -64,12 +213,22 @@ void FTransformController::BeginTransform(const ETransformMode Mode)
 		break;
 	}
 
+	InteractionQuality.Begin(InteractingViewportClient, *ModeText);
+
 	// Begin transaction and capture initial state
 	TransactionIndex = TransformHandler->BeginTransaction(FText::FromString(ModeText));
-	TransformHandler->CaptureInitialState();
+	if (!bReusedSession)
+	{
+		TransformHandler->CaptureInitialState();
+	}
+	for (bool& bValid : bAverageLocalAxisValid)
+	{
+		bValid = false;
+	}
 
 	// Compute pivot and initial picking state
 	TransformPivot = TransformHandler->ComputeSelectionPivot();
+	CurrentPivotTransform = TransformPivot;
 
 	const FPlane HitPlane = ComputePlane(TransformPivot.GetLocation());
 	DragInitialProjectedPosition = GetPlaneHit(HitPlane.GetNormal(), HitPlane.W, RayOrigin,
@@ -78,11 +237,70 @@ void FTransformController::BeginTransform(const ETransformMode Mode)
 	HitLocation = DragInitialProjectedPosition;
 	InitialScaleDistance = (DragInitialProjectedPosition - TransformPivot.GetLocation()).Length();
 
-	// Set up collision query params to ignore selected actors (for surface snapping)
+	BeginSelectionExclusion(bReusedSession);
+
+	if (UBlend4RealSettings::Get()->bProportionalEditing)
+	{
+		BeginProportionalEditing();
+	}
+}
+
+void FTransformController::BeginSelectionExclusion(const bool bReusedSession)
+{
+	// Set up collision query params to ignore the moving selection (for surface snapping).
+	// The selection is tagged with a mask filter bit, so the trace cost doesn't depend on the selection size.
 	IgnoreSelectionQueryParams.bTraceComplex = true;
 	IgnoreSelectionQueryParams.ClearIgnoredSourceObjects();
+	IgnoreSelectionQueryParams.IgnoreMask = 0;
+	bHasElementSnapTarget = false;
+
+	const EBlend4RealSnapElement SnapElement = UBlend4RealSettings::Get()->SnapElement;
+
+	// The excluded objects may have been destroyed since the session was built
+	bool bSnapObjectsAlive = bReusedSession;
+	for (int32 Index = 0; bSnapObjectsAlive && Index < Session.SnapExcludedObjects.Num(); ++Index)
+	{
+		bSnapObjectsAlive = Session.SnapExcludedObjects[Index].IsValid();
+	}
 
-	// Add selected actors to ignore list (only works for actor handler, but harmless for others)
+	if (bSnapObjectsAlive && Session.SnapElement == SnapElement
+		&& SelectionTraceFilter.BeginFromComponents(Session.TracedOutComponents))
+	{
+		// Same objects as the previous transform, their bounds were moved along with them by EndTransform
+		SnapContext = Session.SnapContext;
+		if (!SnapContext.SelectionBounds.IsValid)
+		{
+			// Items snapped to the surface one by one, no single transform for the union
+			for (const TWeakObjectPtr<const UObject>& Object : Session.SnapExcludedObjects)
+			{
+				if (const AActor* Actor = Cast<AActor>(Object.Get()))
+				{
+					SnapContext.SelectionBounds += Actor->GetComponentsBoundingBox(true, true);
+				}
+				else if (const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Object.Get()))
+				{
+					SnapContext.SelectionBounds += Primitive->Bounds.GetBox();
+				}
+			}
+			Session.SnapContext.SelectionBounds = SnapContext.SelectionBounds;
+		}
+		SnapContext.InitialPivot = TransformPivot.GetLocation();
+		TagMovedInstances();
+		SelectionTraceFilter.ApplyTo(IgnoreSelectionQueryParams);
+		return;
+	}
+
+	SelectionTraceFilter.BeginFromEditorSelection();
+	TagMovedInstances();
+	SnapContext = FElementSnapContext();
+	SelectionTraceFilter.ApplyTo(IgnoreSelectionQueryParams);
+	SnapContext.InitialPivot = TransformPivot.GetLocation();
+	// Only build the actor bounds tree when a mode uses it
+	const FActorBoundsTree* BoundsTree = SnapElement == EBlend4RealSnapElement::BoundsFace || SnapElement == EBlend4RealSnapElement::Pivot
+		                                     ? FActorBoundsTree::Get(GetEditorWorld())
+		                                     : nullptr;
+
+	// Selected actors and components are excluded from element snapping
 	if (GEditor)
 	{
 		// actors
@@ -91,20 +309,82 @@ void FTransformController::BeginTransform(const ETransformMode Mode)
 		{
 			if (const AActor* Actor = Cast<AActor>(*It))
 			{
-				IgnoreSelectionQueryParams.AddIgnoredSourceObject(Actor);
+				SnapContext.ExcludedObjects.Add(Actor);
+				SnapContext.SelectionBounds += Actor->GetComponentsBoundingBox(true, true);
+				if (BoundsTree)
+				{
+					SnapContext.ExcludedBoundsProxies.Add(BoundsTree->FindProxy(Actor));
+				}
 			}
 		}
-		// // components
+		// components
 		USelection* SelectedComponents = GEditor->GetSelectedComponents();
 		for (FSelectionIterator It(*SelectedComponents); It; ++It)
 		{
 			if (const UActorComponent* ActorComponent = Cast<UActorComponent>(*It))
 			{
-				UE_LOG(LogTemp, Display, TEXT("Selected Component: %s"), *ActorComponent->GetName());
-				IgnoreSelectionQueryParams.AddIgnoredSourceObject(ActorComponent);
+				SnapContext.ExcludedObjects.Add(ActorComponent);
+				if (const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(ActorComponent))
+				{
+					SnapContext.SelectionBounds += Primitive->Bounds.GetBox();
+				}
+				// The owner bounds move with the component
+				if (BoundsTree)
+				{
+					SnapContext.ExcludedBoundsProxies.Add(BoundsTree->FindProxy(ActorComponent->GetOwner()));
+				}
 			}
 		}
 	}
+
+	// Kept for the next transforms of the same selection
+	SelectionTraceFilter.GetTaggedComponents(Session.TracedOutComponents);
+	Session.SnapContext = SnapContext;
+	Session.SnapExcludedObjects.Reset(SnapContext.ExcludedObjects.Num());
+	for (const UObject* Object : SnapContext.ExcludedObjects)
+	{
+		Session.SnapExcludedObjects.Add(Object);
+	}
+	Session.SnapElement = SnapElement;
+}
+
+void FTransformController::TagMovedInstances()
+{
+	TMap<UInstancedStaticMeshComponent*, TArray<int32>> MovedInstances;
+	TransformHandler->GetMovedInstances(MovedInstances);
+	for (const TPair<UInstancedStaticMeshComponent*, TArray<int32>>& Pair : MovedInstances)
+	{
+		SelectionTraceFilter.TagInstances(Pair.Key, Pair.Value);
+	}
+}
+
+void FTransformController::BeginProportionalEditing()
+{
+	TMap<uint32, FTransform> InitialTransforms;
+	if (!GEditor || !TransformHandler->SupportsProportionalEditing()
+		|| !TransformHandler->GetInitialItemTransforms(InitialTransforms))
+	{
+		return;
+	}
+
+	TArray<FVector> SelectedPivots;
+	SelectedPivots.Reserve(InitialTransforms.Num());
+	for (const TPair<uint32, FTransform>& Pair : InitialTransforms)
+	{
+		SelectedPivots.Add(Pair.Value.GetLocation());
+	}
+
+	TSet<const AActor*> SelectedActors;
+	for (FSelectionIterator It(*GEditor->GetSelectedActors()); It; ++It)
+	{
+		if (const AActor* Actor = Cast<AActor>(*It))
+		{
+			SelectedActors.Add(Actor);
+		}
+	}
+
+	ProportionalEditing.Begin(GetEditorWorld(), SelectedActors, SelectedPivots,
+	                          UBlend4RealSettings::Get()->ProportionalRadius);
 }
 
 void FTransformController::EndTransform(const bool bApply)
@@ -122,6 +402,24 @@ void FTransformController::EndTransform(const bool bApply)
 		GEngine->SetSelectionOutlineColor(OriginalSelectionColor);
 	}
 
+	if (ProportionalEditing.IsActive())
+	{
+		// Keep the radius for the next transform, as Blender does. Saved on shutdown
+		UBlend4RealSettings::Get()->ProportionalRadius = ProportionalEditing.GetRadius();
+		bProportionalSettingsChanged = true;
+	}
+
+	// In World Partition levels, the moved actors are checked against the loaded regions once the move is confirmed,
+	// whether their move updates were deferred or not
+	const UWorld* World = GetEditorWorld();
+	const bool bWarnOutsideLoadedRegions = bApply && World && World->IsPartitionedWorld();
+	TArray<AActor*> MovedActors;
+	if (bWarnOutsideLoadedRegions)
+	{
+		ProportionalEditing.GetMovedActors(MovedActors);
+	}
+	ProportionalEditing.End(bApply);
+
 	if (!bApply)
 	{
 		// Restore original transforms and cancel transaction
@@ -130,7 +428,46 @@ void FTransformController::EndTransform(const bool bApply)
 	}
 	else
 	{
+		// Items whose last surface projection is still in flight are projected now
+		TMap<uint32, FTransform> SnappedTransforms;
+		SurfaceSnapBatcher.Flush(SnappedTransforms);
+		TransformHandler->SetItemTransforms(SnappedTransforms);
 		TransformHandler->EndTransaction();
+
+		// The cached selection bounds follow a rigid move, see BeginSelectionExclusion
+		if (bKeepSession)
+		{
+			Session.SnapContext.SelectionBounds = bItemsMovedIndependently
+				                                      ? FBox(ForceInit)
+				                                      : Session.SnapContext.SelectionBounds.TransformBy(
+					                                      TransformPivot.Inverse() * CurrentPivotTransform);
+		}
+
+		if (bWarnOutsideLoadedRegions)
+		{
+			TransformHandler->GetMovedActors(MovedActors);
+			WarnActorsOutsideLoadedRegions(MovedActors);
+		}
+
+		// Kept for Repeat Last
+		LastTransform.Mode = CurrentMode;
+		LastTransform.Translation = CurrentPivotTransform.GetLocation() - TransformPivot.GetLocation();
+		LastTransform.Rotation = CurrentPivotTransform.GetRotation() * TransformPivot.GetRotation().Inverse();
+		LastTransform.Scale = CurrentPivotTransform.GetScale3D() / TransformPivot.GetScale3D();
+	}
+	SurfaceSnapBatcher.End();
+	SelectionTraceFilter.End();
+
+	if (bKeepSession)
+	{
+		// Kept for the next transform, as long as the selection doesn't change
+		Session.Handler = TransformHandler;
+		Session.SelectionGeneration = SelectionGeneration;
+		Session.ViewportClient = InteractingViewportClient;
+	}
+	else
+	{
+		ReleaseSession();
 	}
 
 	TransactionIndex = -1;
@@ -140,8 +477,12 @@ void FTransformController::EndTransform(const bool bApply)
 	CurrentAxis = ETransformAxis::None;
 	bIsNumericInput = false;
 	NumericBuffer.Empty();
+	SnapContext = FElementSnapContext();
+	bHasElementSnapTarget = false;
 
+	InteractionQuality.End();
 	ClearVisualization();
+	InteractingViewportClient = nullptr;
 }
 
 void FTransformController::SetAxis(ETransformAxis::Type Axis)
@@ -254,11 +595,26 @@ void FTransformController::UpdateFromMouseMove(const FVector2D& MousePosition, b
 	}
 
 	// Translation
+	if (CurrentAxis == ETransformAxis::None && TrySnapToElement(bInvertSnap))
+	{
+		UpdateVisualization();
+		return;
+	}
+
 	if (CurrentAxis == ETransformAxis::None || CurrentAxis >= ETransformAxis::WorldXPlane)
 	{
 		const ULevelEditorViewportSettings* ViewportSettings = GetDefault<ULevelEditorViewportSettings>();
 		const bool Project = ViewportSettings->SnapToSurface.bEnabled && TransformHandler && TransformHandler->
 			GetSelectionCount() == 1;
+		const bool ProjectEach = ViewportSettings->SnapToSurface.bEnabled && TransformHandler && TransformHandler->
+			GetSelectionCount() > 1;
+
+		if (ProjectEach && UpdateSurfaceSnapEach(bInvertSnap))
+		{
+			// Items are moved by Tick() once their traces complete
+			UpdateVisualization();
+			return;
+		}
 
 		if (Project)
 		{
@@ -270,6 +626,7 @@ void FTransformController::UpdateFromMouseMove(const FVector2D& MousePosition, b
 				const bool AlignToNormal = ViewportSettings->SnapToSurface.bSnapRotation;
 				const float Offset = ViewportSettings->SnapToSurface.SnapOffsetExtent;
 				FVector Location = Result.Location + Result.Normal * Offset;
+				FTransform NewPivotTransform = TransformPivot;
 				const bool IsSnapTrEnabled = bInvertSnap
 					                             ? !ViewportSettings->GridEnabled
 					                             : ViewportSettings->GridEnabled;
@@ -288,11 +645,16 @@ void FTransformController::UpdateFromMouseMove(const FVector2D& MousePosition, b
 				{
 					const FRotator SurfaceRotation = FRotationMatrix::MakeFromZ(Result.Normal).Rotator();
 					SetDirectTransformToSelectedActors(&Location, &SurfaceRotation);
+					NewPivotTransform.SetRotation(SurfaceRotation.Quaternion());
 				}
 				else
 				{
 					SetDirectTransformToSelectedActors(&Location);
 				}
+				// The single selected item is its own pivot, the neighbours follow it
+				NewPivotTransform.SetLocation(Location);
+				CurrentPivotTransform = NewPivotTransform;
+				ProportionalEditing.Apply(TransformPivot, NewPivotTransform);
 			}
 		}
 		else
@@ -321,6 +683,138 @@ void FTransformController::UpdateFromMouseMove(const FVector2D& MousePosition, b
 	UpdateVisualization();
 }
 
+bool FTransformController::TrySnapToElement(const bool bInvertSnap)
+{
+	bHasElementSnapTarget = false;
+
+	const EBlend4RealSnapElement SnapElement = UBlend4RealSettings::Get()->SnapElement;
+	const ULevelEditorViewportSettings* ViewportSettings = GetDefault<ULevelEditorViewportSettings>();
+	const bool IsSnapEnabled = bInvertSnap ? !ViewportSettings->GridEnabled : ViewportSettings->GridEnabled;
+	if (SnapElement == EBlend4RealSnapElement::None || !IsSnapEnabled || !TransformHandler)
+	{
+		return false;
+	}
+
+	const FVector ProposedPivot = TransformPivot.GetLocation() + (HitLocation - DragInitialProjectedPosition);
+	FVector SnapLocation;
+	if (!FElementSnapper::FindSnapLocation(InteractingViewportClient, SnapElement, SnapContext,
+	                                       IgnoreSelectionQueryParams, ProposedPivot, SnapLocation))
+	{
+		return false;
+	}
+
+	bHasElementSnapTarget = true;
+	ElementSnapTarget = SnapLocation;
+	SurfaceSnapBatcher.End();
+
+	FTransform NewPivotTransform = TransformPivot;
+	NewPivotTransform.SetLocation(SnapLocation);
+	ApplyPivotTransform(NewPivotTransform);
+	ShowTransformInfo(FString::Printf(TEXT("%.1f"), FVector::Distance(TransformPivot.GetLocation(), SnapLocation)),
+	                  FSlateApplication::Get().GetCursorPos());
+
+	RedrawController->RequestInteractiveRedraw(InteractingViewportClient);
+	return true;
+}
+
+bool FTransformController::UpdateSurfaceSnapEach(const bool bInvertSnap)
+{
+	if (!SurfaceSnapBatcher.IsActive())
+	{
+		TMap<uint32, FTransform> InitialTransforms;
+		if (!TransformHandler->GetInitialItemTransforms(InitialTransforms))
+		{
+			return false;
+		}
+		SurfaceSnapBatcher.Begin(GetEditorWorld(), IgnoreSelectionQueryParams, InitialTransforms);
+		bItemsMovedIndependently = true;
+		// Items land independently, the neighbours have no pivot to follow
+		CurrentPivotTransform = TransformPivot;
+		ProportionalEditing.Apply(TransformPivot, TransformPivot);
+	}
+
+	// The group follows the surface under the cursor, then each item is projected below its own position
+	const FHitResult Result = ProjectToSurface(GetEditorWorld(), RayOrigin, RayDirection, IgnoreSelectionQueryParams);
+	if (!Result.IsValidBlockingHit())
+	{
+		return true;
+	}
+
+	const ULevelEditorViewportSettings* ViewportSettings = GetDefault<ULevelEditorViewportSettings>();
+	FVector Translation = Result.Location - TransformPivot.GetLocation();
+	const bool IsSnapTrEnabled = bInvertSnap ? !ViewportSettings->GridEnabled : ViewportSettings->GridEnabled;
+	if (IsSnapTrEnabled)
+	{
+		const float GridSize = GEditor->GetGridSize();
+		Translation = FVector(
+			ceilf(Translation.X / GridSize) * GridSize,
+			ceilf(Translation.Y / GridSize) * GridSize,
+			ceilf(Translation.Z / GridSize) * GridSize);
+	}
+	SurfaceSnapBatcher.SetGroupTranslation(Translation, ViewportSettings->SnapToSurface.SnapOffsetExtent,
+	                                       ViewportSettings->SnapToSurface.bSnapRotation);
+	return true;
+}
+
+void FTransformController::Tick()
+{
+	if (!bIsTransforming || !TransformHandler)
+	{
+		return;
+	}
+
+	TMap<uint32, FTransform> SnappedTransforms;
+	if (SurfaceSnapBatcher.IsActive() && SurfaceSnapBatcher.Tick(SnappedTransforms))
+	{
+		TransformHandler->SetItemTransforms(SnappedTransforms);
+		RedrawController->RequestInteractiveRedraw(InteractingViewportClient);
+	}
+
+	// Write the transforms applied since last frame, for handlers batching them
+	TransformHandler->FlushDeferredUpdates();
+}
+
+void FTransformController::ToggleProportionalEditing()
+{
+	UBlend4RealSettings* Settings = UBlend4RealSettings::Get();
+	Settings->bProportionalEditing = !Settings->bProportionalEditing;
+	bProportionalSettingsChanged = true;
+	UE_LOG(LogTemp, Display, TEXT("Blend4Real: Proportional editing %s"),
+	       Settings->bProportionalEditing ? TEXT("enabled") : TEXT("disabled"));
+
+	if (!bIsTransforming || !TransformHandler)
+	{
+		return;
+	}
+
+	if (Settings->bProportionalEditing)
+	{
+		BeginProportionalEditing();
+		ProportionalEditing.Apply(TransformPivot, CurrentPivotTransform);
+	}
+	else
+	{
+		ProportionalEditing.End(false);
+	}
+	UpdateVisualization();
+}
+
+bool FTransformController::AdjustProportionalRadius(const float WheelDelta)
+{
+	if (!bIsTransforming || !ProportionalEditing.IsActive())
+	{
+		return false;
+	}
+
+	const float Factor = WheelDelta > 0.f ? 1.1f : 1.f / 1.1f;
+	ProportionalEditing.SetRadius(ProportionalEditing.GetRadius() * Factor);
+	ShowTransformInfo(FString::Printf(TEXT("Proportional size: %.0f (%d)"), ProportionalEditing.GetRadius(),
+	                                  ProportionalEditing.GetNumAffected()),
+	                  FSlateApplication::Get().GetCursorPos());
+	UpdateVisualization();
+	return true;
+}
+
 void FTransformController::ResetTransform(const ETransformMode Mode) const
 {
 	// Get appropriate handler for current viewport context
@@ -357,11 +851,19 @@ void FTransformController::ResetTransform(const ETransformMode Mode) const
 	}
 
 	ResetHandler->EndTransaction();
-	// Invalidate the focused viewport to trigger redraw
-	if (FEditorViewportClient* ViewportClient = GetFocusedViewportClient())
+	RedrawController->RequestRedraw(GetFocusedViewportClient());
+	RedrawController->RequestFullRedraw();
+}
+
+FVector FTransformController::GetAverageLocalAxis(const EAxis::Type Axis) const
+{
+	const int32 Index = Axis == EAxis::X ? 0 : Axis == EAxis::Y ? 1 : 2;
+	if (!bAverageLocalAxisValid[Index])
 	{
-		ViewportClient->Invalidate();
+		AverageLocalAxes[Index] = TransformHandler->ComputeAverageLocalAxis(Axis);
+		bAverageLocalAxisValid[Index] = true;
 	}
+	return AverageLocalAxes[Index];
 }
 
 FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) const
@@ -374,7 +876,7 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 	case ETransformAxis::LocalX:
 		if (bHasSelection)
 		{
-			return TransformHandler->ComputeAverageLocalAxis(EAxis::X);
+			return GetAverageLocalAxis(EAxis::X);
 		}
 	// Fall through to WorldX
 	case ETransformAxis::WorldX:
@@ -383,7 +885,7 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 	case ETransformAxis::LocalY:
 		if (bHasSelection)
 		{
-			return TransformHandler->ComputeAverageLocalAxis(EAxis::Y);
+			return GetAverageLocalAxis(EAxis::Y);
 		}
 	// Fall through to WorldY
 	case ETransformAxis::WorldY:
@@ -392,7 +894,7 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 	case ETransformAxis::LocalZ:
 		if (bHasSelection)
 		{
-			return TransformHandler->ComputeAverageLocalAxis(EAxis::Z);
+			return GetAverageLocalAxis(EAxis::Z);
 		}
 	// Fall through to WorldZ
 	case ETransformAxis::WorldZ:
@@ -405,8 +907,8 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 		if (bHasSelection)
 		{
 			return CurrentMode == ETransformMode::Rotation
-				       ? TransformHandler->ComputeAverageLocalAxis(EAxis::X)
-				       : (TransformHandler->ComputeAverageLocalAxis(EAxis::Y) + TransformHandler->ComputeAverageLocalAxis(EAxis::Z)).GetSafeNormal();
+				       ? GetAverageLocalAxis(EAxis::X)
+				       : (GetAverageLocalAxis(EAxis::Y) + GetAverageLocalAxis(EAxis::Z)).GetSafeNormal();
 		}
 	// Fall through to WorldXPlane
 	case ETransformAxis::WorldXPlane:
@@ -419,8 +921,8 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 		if (bHasSelection)
 		{
 			return CurrentMode == ETransformMode::Rotation
-				       ? TransformHandler->ComputeAverageLocalAxis(EAxis::Y)
-				       : (TransformHandler->ComputeAverageLocalAxis(EAxis::X) + TransformHandler->ComputeAverageLocalAxis(EAxis::Z)).GetSafeNormal();
+				       ? GetAverageLocalAxis(EAxis::Y)
+				       : (GetAverageLocalAxis(EAxis::X) + GetAverageLocalAxis(EAxis::Z)).GetSafeNormal();
 		}
 	// Fall through to WorldYPlane
 	case ETransformAxis::WorldYPlane:
@@ -433,8 +935,8 @@ FVector FTransformController::GetAxisVector(const ETransformAxis::Type Axis) con
 		if (bHasSelection)
 		{
 			return CurrentMode == ETransformMode::Rotation
-				       ? TransformHandler->ComputeAverageLocalAxis(EAxis::Z)
-				       : (TransformHandler->ComputeAverageLocalAxis(EAxis::X) + TransformHandler->ComputeAverageLocalAxis(EAxis::Y)).GetSafeNormal();
+				       ? GetAverageLocalAxis(EAxis::Z)
+				       : (GetAverageLocalAxis(EAxis::X) + GetAverageLocalAxis(EAxis::Y)).GetSafeNormal();
 		}
 	// Fall through to WorldZPlane
 	case ETransformAxis::WorldZPlane:
@@ -489,13 +991,13 @@ FPlane FTransformController::ComputePlane(const FVector& InitialPos)
 		case ETransformAxis::WorldYPlane: return FPlane(FVector::UnitY(), TransformPivot.GetLocation().Y);
 		case ETransformAxis::WorldZPlane: return FPlane(FVector::UnitZ(), TransformPivot.GetLocation().Z);
 		case ETransformAxis::LocalXPlane:
-			Normal = -TransformHandler->ComputeAverageLocalAxis(EAxis::X);
+			Normal = -GetAverageLocalAxis(EAxis::X);
 			break;
 		case ETransformAxis::LocalYPlane:
-			Normal = -TransformHandler->ComputeAverageLocalAxis(EAxis::Y);
+			Normal = -GetAverageLocalAxis(EAxis::Y);
 			break;
 		case ETransformAxis::LocalZPlane:
-			Normal = -TransformHandler->ComputeAverageLocalAxis(EAxis::Z);
+			Normal = -GetAverageLocalAxis(EAxis::Z);
 			break;
 		default: return FPlane(FVector::UnitZ(), 0);
 		}
@@ -541,6 +1043,9 @@ void FTransformController::TransformSelectedActors(const FVector& Direction, con
 		return;
 	}
 
+	// Pivot based transforms replace the projection of each item
+	SurfaceSnapBatcher.End();
+
 	const ULevelEditorViewportSettings* ViewportSettings = GetDefault<ULevelEditorViewportSettings>();
 	const bool IsSnapTrEnabled = InvertSnap ? !ViewportSettings->GridEnabled : ViewportSettings->GridEnabled;
 	const bool IsSnapRtEnabled = InvertSnap ? !ViewportSettings->RotGridEnabled : ViewportSettings->RotGridEnabled;
@@ -612,9 +1117,16 @@ void FTransformController::TransformSelectedActors(const FVector& Direction, con
 	}
 
 	// Apply the new pivot transform to selection via handler
-	TransformHandler->ApplyTransformAroundPivot(TransformPivot, NewPivotTransform);
+	ApplyPivotTransform(NewPivotTransform);
 
-	GEditor->RedrawLevelEditingViewports();
+	RedrawController->RequestInteractiveRedraw(InteractingViewportClient);
+}
+
+void FTransformController::ApplyPivotTransform(const FTransform& NewPivotTransform)
+{
+	TransformHandler->ApplyTransformAroundPivot(TransformPivot, NewPivotTransform);
+	ProportionalEditing.Apply(TransformPivot, NewPivotTransform);
+	CurrentPivotTransform = NewPivotTransform;
 }
 
 void FTransformController::SetDirectTransformToSelectedActors(const FVector* Location, const FRotator* Rotation,
@@ -714,6 +1226,42 @@ void FTransformController::UpdateVisualization()
 			FLinearColor::White, SDPG_Foreground, 1.0f, 0.0f, TRANSFORM_BATCH_ID);
 	}
 
+	// Proportional editing radius around the moving pivot, facing the camera
+	if (ProportionalEditing.IsActive())
+	{
+		if (const FSceneView* Scene = GetActiveSceneView())
+		{
+			const FVector Center = CurrentPivotTransform.GetLocation();
+			const FVector Right = Scene->GetViewRight() * ProportionalEditing.GetRadius();
+			const FVector Up = Scene->GetViewUp() * ProportionalEditing.GetRadius();
+			constexpr int32 NumSegments = 64;
+			FVector Previous = Center + Right;
+			for (int32 Segment = 1; Segment <= NumSegments; ++Segment)
+			{
+				const float Angle = 2.f * PI * Segment / NumSegments;
+				const FVector Current = Center + Right * FMath::Cos(Angle) + Up * FMath::Sin(Angle);
+				LineBatcher->DrawLine(
+					Previous, Current,
+					FLinearColor::White, SDPG_Foreground, 1.0f, 0.0f, TRANSFORM_BATCH_ID);
+				Previous = Current;
+			}
+		}
+	}
+
+	// Mark the snapped vertex or edge point
+	if (bHasElementSnapTarget && CurrentAxis == ETransformAxis::None && !bIsNumericInput)
+	{
+		const float MarkerSize = 5.0f;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			FVector Offset = FVector::ZeroVector;
+			Offset[Axis] = MarkerSize;
+			LineBatcher->DrawLine(
+				ElementSnapTarget - Offset, ElementSnapTarget + Offset,
+				FLinearColor(FColor::Orange), SDPG_Foreground, 2.0f, 0.0f, TRANSFORM_BATCH_ID);
+		}
+	}
+
 	// Draw axis constraint line if an axis is selected
 	if (CurrentAxis != ETransformAxis::None)
 	{
@@ -737,8 +1285,8 @@ void FTransformController::UpdateVisualization()
 			{
 			// X
 			case ETransformAxis::LocalXPlane:
-				Axis1 = TransformHandler->ComputeAverageLocalAxis(EAxis::Y);
-				Axis2 = TransformHandler->ComputeAverageLocalAxis(EAxis::Z);
+				Axis1 = GetAverageLocalAxis(EAxis::Y);
+				Axis2 = GetAverageLocalAxis(EAxis::Z);
 				Color1 = AxisColors[ETransformAxis::LocalY];
 				Color2 = AxisColors[ETransformAxis::LocalZ];
 				break;
@@ -750,8 +1298,8 @@ void FTransformController::UpdateVisualization()
 				break;
 			// Y
 			case ETransformAxis::LocalYPlane:
-				Axis1 = TransformHandler->ComputeAverageLocalAxis(EAxis::X);
-				Axis2 = TransformHandler->ComputeAverageLocalAxis(EAxis::Z);
+				Axis1 = GetAverageLocalAxis(EAxis::X);
+				Axis2 = GetAverageLocalAxis(EAxis::Z);
 				Color1 = AxisColors[ETransformAxis::LocalX];
 				Color2 = AxisColors[ETransformAxis::LocalZ];
 				break;
@@ -763,8 +1311,8 @@ void FTransformController::UpdateVisualization()
 				break;
 			// Z
 			case ETransformAxis::LocalZPlane:
-				Axis1 = TransformHandler->ComputeAverageLocalAxis(EAxis::X);
-				Axis2 = TransformHandler->ComputeAverageLocalAxis(EAxis::Y);
+				Axis1 = GetAverageLocalAxis(EAxis::X);
+				Axis2 = GetAverageLocalAxis(EAxis::Y);
 				Color1 = AxisColors[ETransformAxis::LocalX];
 				Color2 = AxisColors[ETransformAxis::LocalY];
 				break;
@@ -794,11 +1342,7 @@ void FTransformController::UpdateVisualization()
 		}
 	}
 
-	// Invalidate the focused viewport to trigger redraw
-	if (FEditorViewportClient* ViewportClient = GetFocusedViewportClient())
-	{
-		ViewportClient->Invalidate();
-	}
+	RedrawController->RequestInteractiveRedraw(InteractingViewportClient);
 }
 
 void FTransformController::ClearVisualization()
@@ -810,9 +1354,7 @@ void FTransformController::ClearVisualization()
 		LineBatcher = nullptr;
 	}
 
-	// Invalidate the focused viewport to trigger redraw
-	if (FEditorViewportClient* ViewportClient = GetFocusedViewportClient())
-	{
-		ViewportClient->Invalidate();
-	}
+	// The operation is over: bring every viewport up to date
+	RedrawController->RequestRedraw(InteractingViewportClient);
+	RedrawController->RequestFullRedraw();
 }
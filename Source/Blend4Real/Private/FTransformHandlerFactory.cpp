@@ -4,20 +4,81 @@
 #include "FComponentTransformHandler.h"
 #include "FSCSTransformHandler.h"
 #include "FSplinePointTransformHandler.h"
+#include "FInstanceTransformHandler.h"
+#include "FFoliageTransformHandler.h"
+#include "FBoneTransformHandler.h"
+#include "FCompositeTransformHandler.h"
 #include "Blend4RealUtils.h"
 #include "Editor.h"
+#include "EditorViewportClient.h"
 #include "Engine/Selection.h"
 #include "Framework/Application/SlateApplication.h"
 #include "BlueprintEditorModule.h"
 #include "BlueprintEditor.h"
+#include "SSCSEditorViewport.h"
+#include "Subsystems/AssetEditorSubsystem.h"
 #include "Features/IModularFeatures.h"
+#include "Misc/CoreDelegates.h"
 #include "SplineDetailsProvider.h"
 #include "Components/SplineComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Elements/Framework/TypedElementSelectionSet.h"
+#include "Elements/SMInstance/SMInstanceElementData.h"
 
 namespace
 {
+	/** Blueprint editor owning each SCS viewport, rebuilt when an asset editor is opened or closed */
+	TMap<const SWidget*, TWeakPtr<FBlueprintEditor>> ViewportEditors;
+	bool bViewportEditorsDirty = true;
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle EditorOpenedHandle;
+	FDelegateHandle EditorClosedHandle;
+
+	void BindAssetEditorEvents()
+	{
+		UAssetEditorSubsystem* AssetEditorSubsystem = GEditor ? GEditor->GetEditorSubsystem<UAssetEditorSubsystem>() : nullptr;
+		if (!AssetEditorSubsystem)
+		{
+			return;
+		}
+
+		EditorOpenedHandle = AssetEditorSubsystem->OnAssetEditorOpened().AddLambda([](UObject*)
+		{
+			bViewportEditorsDirty = true;
+		});
+		EditorClosedHandle = AssetEditorSubsystem->OnAssetClosedInEditor().AddLambda([](UObject*, IAssetEditorInstance*)
+		{
+			bViewportEditorsDirty = true;
+		});
+	}
+
+	void RebuildViewportEditors()
+	{
+		ViewportEditors.Reset();
+		bViewportEditorsDirty = false;
+
+		FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
+		for (const TSharedRef<IBlueprintEditor>& Editor : BlueprintEditorModule.GetBlueprintEditors())
+		{
+			const TSharedRef<FBlueprintEditor> BlueprintEditor = StaticCastSharedRef<FBlueprintEditor>(Editor);
+			if (const TSharedPtr<SSCSEditorViewport> Viewport = BlueprintEditor->GetSubobjectViewport())
+			{
+				ViewportEditors.Add(Viewport.Get(), BlueprintEditor);
+			}
+		}
+	}
+
+	TSharedPtr<FBlueprintEditor> FindViewportEditor(const TSharedPtr<SWidget>& Viewport)
+	{
+		const TWeakPtr<FBlueprintEditor>* Found = ViewportEditors.Find(Viewport.Get());
+		TSharedPtr<FBlueprintEditor> Editor = Found ? Found->Pin() : nullptr;
+		// The address of a destroyed viewport may be reused
+		return Editor.IsValid() && Editor->GetSubobjectViewport().Get() == Viewport.Get() ? Editor : nullptr;
+	}
+
 	/**
 	 * Try to create a spline point transform handler if spline control points are selected.
+	 * Points selected on several splines are grouped per spline component in the same handler.
 	 * Returns nullptr if no spline points are selected.
 	 */
 	TSharedPtr<IBlend4RealTransformHandler> TryCreateSplinePointHandler()
@@ -26,6 +87,7 @@ namespace
 		TArray<ISplineDetailsProvider*> Providers = IModularFeatures::Get()
 			.GetModularFeatureImplementations<ISplineDetailsProvider>(ISplineDetailsProvider::GetModularFeatureName());
 
+		TMap<USplineComponent*, TSet<int32>> SelectedKeys;
 		for (ISplineDetailsProvider* Provider : Providers)
 		{
 			if (Provider && Provider->GetSelectedKeys().Num() > 0)
@@ -33,12 +95,38 @@ namespace
 				USplineComponent* SplineComp = Provider->GetEditedSplineComponent();
 				if (SplineComp)
 				{
-					return MakeShared<FSplinePointTransformHandler>(SplineComp, Provider->GetSelectedKeys());
+					SelectedKeys.FindOrAdd(SplineComp).Append(Provider->GetSelectedKeys());
 				}
 			}
 		}
 
-		return nullptr;
+		return SelectedKeys.Num() > 0 ? MakeShared<FSplinePointTransformHandler>(SelectedKeys) : nullptr;
+	}
+
+	/**
+	 * Try to create an instance transform handler if instances of (H)ISM components are selected.
+	 * Returns nullptr if no instances are selected.
+	 */
+	TSharedPtr<IBlend4RealTransformHandler> TryCreateInstanceHandler()
+	{
+		const USelection* SelectedActors = GEditor->GetSelectedActors();
+		const UTypedElementSelectionSet* SelectionSet = SelectedActors ? SelectedActors->GetElementSelectionSet() : nullptr;
+		if (!SelectionSet)
+		{
+			return nullptr;
+		}
+
+		TMap<UInstancedStaticMeshComponent*, TArray<int32>> Instances;
+		for (const FTypedElementHandle& Handle : SelectionSet->GetSelectedElementHandles())
+		{
+			const FSMInstanceManager Instance = SMInstanceElementDataUtil::GetSMInstanceFromHandle(Handle, true);
+			if (Instance)
+			{
+				Instances.FindOrAdd(Instance.GetISMComponent()).AddUnique(Instance.GetISMInstanceIndex());
+			}
+		}
+
+		return Instances.Num() > 0 ? MakeShared<FInstanceTransformHandler>(Instances) : nullptr;
 	}
 
 	/**
@@ -47,32 +135,51 @@ namespace
 	 */
 	TWeakPtr<FBlueprintEditor> FindBlueprintEditorAtPosition(const FVector2D& MousePosition)
 	{
-		// Get the Blueprint editor module
-		FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
-
-		// Get all open Blueprint editors
-		TArray<TSharedRef<IBlueprintEditor>> BlueprintEditors = BlueprintEditorModule.GetBlueprintEditors();
-
-		for (const TSharedRef<IBlueprintEditor>& Editor : BlueprintEditors)
+		const TSharedPtr<SWidget> Viewport = Blend4RealUtils::GetViewportWidgetAtPosition(
+			MousePosition, FName("SSCSEditorViewport"));
+		if (!Viewport.IsValid())
 		{
-			// Cast to FBlueprintEditor to access the subobject viewport
-			TSharedRef<FBlueprintEditor> BlueprintEditor = StaticCastSharedRef<FBlueprintEditor>(Editor);
-
-			// Check if this editor has a valid preview actor (indicates SCS editor is active)
-			if (BlueprintEditor->GetPreviewActor() != nullptr)
-			{
-				// Check if this editor has any selected nodes
-				// This helps confirm we're in the right editor
-				TArray<TSharedPtr<FSubobjectEditorTreeNode>> SelectedNodes = BlueprintEditor->GetSelectedSubobjectEditorTreeNodes();
+			return nullptr;
+		}
 
-				// For now, return the first editor that has a preview actor
-				// TODO: More precise matching by checking if the viewport widget matches
-				return BlueprintEditor;
-			}
+		if (bViewportEditorsDirty)
+		{
+			RebuildViewportEditors();
+		}
+		TSharedPtr<FBlueprintEditor> Editor = FindViewportEditor(Viewport);
+		if (!Editor.IsValid())
+		{
+			// The viewport can be created after the editor opened, when its tab is first shown
+			RebuildViewportEditors();
+			Editor = FindViewportEditor(Viewport);
 		}
+		return Editor;
+	}
+}
 
-		return nullptr;
+void FTransformHandlerFactory::Initialize()
+{
+	// The plugin is loaded before the editor is created
+	if (GEditor)
+	{
+		BindAssetEditorEvents();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddStatic(&BindAssetEditorEvents);
+	}
+}
+
+void FTransformHandlerFactory::Shutdown()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	if (UAssetEditorSubsystem* AssetEditorSubsystem = GEditor ? GEditor->GetEditorSubsystem<UAssetEditorSubsystem>() : nullptr)
+	{
+		AssetEditorSubsystem->OnAssetEditorOpened().Remove(EditorOpenedHandle);
+		AssetEditorSubsystem->OnAssetClosedInEditor().Remove(EditorClosedHandle);
 	}
+	ViewportEditors.Reset();
+	bViewportEditorsDirty = true;
 }
 
 TSharedPtr<IBlend4RealTransformHandler> FTransformHandlerFactory::CreateHandler()
@@ -88,33 +195,65 @@ TSharedPtr<IBlend4RealTransformHandler> FTransformHandlerFactory::CreateHandler(
 	// Level Editor: Check selection state to determine handler type
 	if (Blend4RealUtils::IsMouseOverViewport(MousePosition, FName("SLevelViewport")))
 	{
+		// Foliage mode: the foliage instances selected in the mode, actors can't be selected there
+		if (FFoliageTransformHandler::IsFoliageModeActive())
+		{
+			TSharedPtr<FFoliageTransformHandler> FoliageHandler = MakeShared<FFoliageTransformHandler>();
+			return FoliageHandler->HasSelection() ? FoliageHandler : nullptr;
+		}
+
 		// Priority 0: Spline control points (most specific selection)
 		if (TSharedPtr<IBlend4RealTransformHandler> SplineHandler = TryCreateSplinePointHandler())
 		{
 			return SplineHandler;
 		}
 
-		// Priority 1: Components (more specific selection)
+		// Priority 1: Instances of instanced static mesh components
+		if (TSharedPtr<IBlend4RealTransformHandler> InstanceHandler = TryCreateInstanceHandler())
+		{
+			return InstanceHandler;
+		}
+
+		// Priority 2: Components (more specific selection)
 		USelection* SelectedComponents = GEditor->GetSelectedComponents();
 		if (SelectedComponents && SelectedComponents->Num() > 0)
 		{
-			bool bHasSceneComponent = false;
+			// Owners of the selected components are part of the actor selection too
+			TSet<const AActor*> ComponentOwners;
 			for (FSelectionIterator It(*SelectedComponents); It; ++It)
 			{
 				if (const USceneComponent* Obj = Cast<USceneComponent>(*It))
 				{
 					// Only SceneComponents can be transformed
-					bHasSceneComponent = true;
-					break;
+					ComponentOwners.Add(Obj->GetOwner());
 				}
 			}
-			if (bHasSceneComponent)
+			if (ComponentOwners.Num() > 0)
 			{
-				return MakeShared<FComponentTransformHandler>();
+				// Mixed selection: the other selected actors are transformed with the components
+				TArray<AActor*> OtherActors;
+				for (FSelectionIterator It(*GEditor->GetSelectedActors()); It; ++It)
+				{
+					AActor* Actor = Cast<AActor>(*It);
+					if (Actor && !ComponentOwners.Contains(Actor))
+					{
+						OtherActors.Add(Actor);
+					}
+				}
+				if (OtherActors.Num() == 0)
+				{
+					return MakeShared<FComponentTransformHandler>();
+				}
+
+				// Actors first: components attached under a moved actor are then set to their own transform
+				return MakeShared<FCompositeTransformHandler>(TArray<TSharedPtr<IBlend4RealTransformHandler>>{
+					MakeShared<FActorTransformHandler>(OtherActors),
+					MakeShared<FComponentTransformHandler>()
+				});
 			}
 		}
 
-		// Priority 2: Actors
+		// Priority 3: Actors
 		USelection* SelectedActors = GEditor->GetSelectedActors();
 		if (SelectedActors && SelectedActors->Num() > 0)
 		{
@@ -141,8 +280,24 @@ TSharedPtr<IBlend4RealTransformHandler> FTransformHandlerFactory::CreateHandler(
 		return nullptr;
 	}
 
+	// Persona: bones of the preview mesh (Skeleton, Skeletal Mesh and Animation editors)
+	if (Blend4RealUtils::IsMouseOverViewport(MousePosition, FName("SAnimationEditorViewport")))
+	{
+		FVector2D ViewportOrigin;
+		FEditorViewportClient* ViewportClient = Blend4RealUtils::GetViewportClientAndScreenOrigin(
+			MousePosition, ViewportOrigin, FName("SAnimationEditorViewport"));
+		if (UDebugSkelMeshComponent* PreviewComponent = FBoneTransformHandler::FindPreviewComponent(ViewportClient))
+		{
+			TSharedPtr<FBoneTransformHandler> Handler = MakeShared<FBoneTransformHandler>(PreviewComponent);
+			if (Handler->HasSelection())
+			{
+				return Handler;
+			}
+		}
+		return nullptr;
+	}
+
 	// TODO: Add more viewport types here:
-	// - Animation Editor (bones)
 	// - Static Mesh Editor (sockets)
 	// - Skeleton Editor (sockets)
 
@@ -0,0 +1,104 @@
+#include "FViewportRedrawController.h"
+#include "Blend4RealSettings.h"
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#include "LevelEditorViewport.h"
+
+FViewportRedrawController::FViewportRedrawController()
+{
+}
+
+void FViewportRedrawController::RequestInteractiveRedraw(FEditorViewportClient* InteractingClient)
+{
+	if (InteractingClient)
+	{
+		PendingClients.Add(InteractingClient);
+		InteractiveClients.Add(InteractingClient);
+	}
+	bInactiveViewportsStale = true;
+}
+
+void FViewportRedrawController::RequestRedraw(FEditorViewportClient* ViewportClient)
+{
+	if (ViewportClient)
+	{
+		PendingClients.Add(ViewportClient);
+	}
+}
+
+void FViewportRedrawController::RequestFullRedraw()
+{
+	bFullRedrawPending = true;
+}
+
+void FViewportRedrawController::Flush(const float DeltaTime)
+{
+	TimeSinceInactiveRedraw += DeltaTime;
+
+	if (!GEditor)
+	{
+		PendingClients.Reset();
+		InteractiveClients.Reset();
+		return;
+	}
+
+	if (bFullRedrawPending)
+	{
+		// Redraws every level viewport and invalidates their hit proxies
+		GEditor->RedrawLevelEditingViewports(true);
+
+		// Non level viewports (e.g. Blueprint SCS viewport) are not covered by the call above
+		for (FEditorViewportClient* ViewportClient : PendingClients)
+		{
+			if (!ViewportClient->IsLevelEditorClient() && IsViewportClientAlive(ViewportClient))
+			{
+				ViewportClient->Invalidate();
+			}
+		}
+
+		PendingClients.Reset();
+		InteractiveClients.Reset();
+		bFullRedrawPending = false;
+		bInactiveViewportsStale = false;
+		TimeSinceInactiveRedraw = 0.f;
+		return;
+	}
+
+	for (FEditorViewportClient* ViewportClient : PendingClients)
+	{
+		if (!IsViewportClientAlive(ViewportClient))
+		{
+			continue;
+		}
+
+		// Hit proxies of the interacting viewport are not needed until the operation ends,
+		// they are invalidated by the full redraw that follows it.
+		const bool bInvalidateHitProxies = !InteractiveClients.Contains(ViewportClient);
+		ViewportClient->Invalidate(false, bInvalidateHitProxies);
+	}
+
+	// Refresh the other level viewports at the throttled rate.
+	// A rate of 0 means they are only refreshed by the full redraw at the end of the operation.
+	const float InactiveRedrawRate = UBlend4RealSettings::Get()->InactiveViewportRedrawRate;
+	if (bInactiveViewportsStale && InactiveRedrawRate > 0.f && TimeSinceInactiveRedraw >= 1.f / InactiveRedrawRate)
+	{
+		for (FLevelEditorViewportClient* LevelClient : GEditor->GetLevelViewportClients())
+		{
+			if (LevelClient && !PendingClients.Contains(LevelClient))
+			{
+				LevelClient->Invalidate(false, false);
+			}
+		}
+		bInactiveViewportsStale = false;
+		TimeSinceInactiveRedraw = 0.f;
+	}
+
+	PendingClients.Reset();
+	InteractiveClients.Reset();
+}
+
+bool FViewportRedrawController::IsViewportClientAlive(const FEditorViewportClient* ViewportClient)
+{
+	// Viewport clients can be destroyed between the request and the flush (e.g. editor tab closed)
+	return ViewportClient && GEditor && GEditor->GetAllViewportClients().Contains(ViewportClient);
+}
@@ -0,0 +1,57 @@
+#include "FBoneTransformHandler.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/**
+	 * Component space transform of a bone with a modifier, evaluated like FAnimNode_ModifyBone does with the modes
+	 * of the preview instance: additive scale, rotation then translation, each in parent bone space
+	 */
+	FTransform EvaluateModifiedBone(const FTransform& ParentComponentSpace, const FTransform& BaseLocal,
+	                                const FTransform& Modifier)
+	{
+		FTransform Local = BaseLocal;
+		Local.SetScale3D(Local.GetScale3D() * Modifier.GetScale3D());
+		Local.SetRotation(Modifier.GetRotation() * Local.GetRotation());
+		Local.AddToTranslation(Modifier.GetTranslation());
+		return Local * ParentComponentSpace;
+	}
+
+	bool IsSameTransform(const FTransform& A, const FTransform& B)
+	{
+		return A.GetTranslation().Equals(B.GetTranslation(), 0.01)
+			&& A.GetRotation().Equals(B.GetRotation(), 1.e-4)
+			&& A.GetScale3D().Equals(B.GetScale3D(), 1.e-4);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBoneModifierRotatedChildTest,
+                                 "Blend4Real.Bones.Modifier.RotatedChildBone",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FBoneModifierRotatedChildTest::RunTest(const FString& Parameters)
+{
+	// Rotated and offset parent, child bone with its own local rotation
+	const FTransform ParentComponentSpace(FRotator(30.f, 45.f, 10.f), FVector(10.0, 20.0, 100.0));
+	const FTransform BaseLocal(FRotator(-20.f, 90.f, 0.f), FVector(0.0, 15.0, 0.0));
+
+	// Moved, rotated and scaled in component space, as the grab does
+	const FTransform BaseComponentSpace = BaseLocal * ParentComponentSpace;
+	const FTransform Target = BaseComponentSpace
+		* FTransform(FRotator(0.f, 0.f, 60.f), FVector(5.0, -30.0, 12.0), FVector(1.5));
+
+	const FTransform Modifier = FBoneTransformHandler::ComputeModifier(ParentComponentSpace, BaseLocal, Target);
+	const FTransform Result = EvaluateModifiedBone(ParentComponentSpace, BaseLocal, Modifier);
+	TestTrue(FString::Printf(TEXT("Modified bone at %s, expected %s"), *Result.ToString(), *Target.ToString()),
+	         IsSameTransform(Result, Target));
+
+	// No move, no modifier
+	const FTransform Identity = FBoneTransformHandler::ComputeModifier(ParentComponentSpace, BaseLocal,
+	                                                                   BaseComponentSpace);
+	TestTrue(TEXT("Unmoved bone has an identity modifier"), IsSameTransform(Identity, FTransform::Identity));
+	return true;
+}
+
+#endif
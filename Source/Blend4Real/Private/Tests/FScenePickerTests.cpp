@@ -0,0 +1,154 @@
+#include "FScenePicker.h"
+#include "CollisionQueryParams.h"
+#include "Editor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "PhysicsEngine/BodySetup.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Transient editor world, destroyed with the test */
+	class FPickingTestWorld
+	{
+	public:
+		FPickingTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Editor, false);
+			GEngine->CreateNewWorldContext(EWorldType::Editor).SetCurrentWorld(World);
+		}
+
+		~FPickingTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		UStaticMeshComponent* SpawnMesh(UStaticMesh* Mesh, const FVector& Location, const FRotator& Rotation,
+		                                const FVector& Scale) const
+		{
+			AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Location, Rotation);
+			UStaticMeshComponent* Component = Actor->GetStaticMeshComponent();
+			Component->SetMobility(EComponentMobility::Movable);
+			Component->SetStaticMesh(Mesh);
+			Component->SetWorldScale3D(Scale);
+			Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			return Component;
+		}
+
+		UWorld* World = nullptr;
+	};
+
+	/** Engine cube, with a box as simple collision */
+	UStaticMesh* LoadCube()
+	{
+		return LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	}
+
+	/** Copy of the engine cube with complex collision only, physics traces without bTraceComplex can't hit it */
+	UStaticMesh* CreateCubeWithoutSimpleCollision(UStaticMesh* Cube)
+	{
+		UStaticMesh* Mesh = DuplicateObject<UStaticMesh>(Cube, GetTransientPackage());
+		UBodySetup* BodySetup = Mesh->GetBodySetup();
+		BodySetup->RemoveSimpleCollision();
+		BodySetup->CollisionTraceFlag = CTF_UseDefault;
+		BodySetup->InvalidatePhysicsData();
+		BodySetup->CreatePhysicsMeshes();
+		return Mesh;
+	}
+
+	bool IsSameHit(const FHitResult& A, const FHitResult& B)
+	{
+		return A.bBlockingHit == B.bBlockingHit
+			&& (!A.bBlockingHit || (A.GetComponent() == B.GetComponent() && FVector::Dist(A.Location, B.Location) < 0.1));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FScenePickerFrontMeshWithoutSimpleCollisionTest,
+                                 "Blend4Real.Picking.TwoPhase.FrontMeshWithoutSimpleCollision",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FScenePickerFrontMeshWithoutSimpleCollisionTest::RunTest(const FString& Parameters)
+{
+	UStaticMesh* Cube = LoadCube();
+	if (!TestNotNull(TEXT("Engine cube"), Cube))
+	{
+		return false;
+	}
+
+	const FPickingTestWorld TestWorld;
+	const UStaticMeshComponent* Front = TestWorld.SpawnMesh(CreateCubeWithoutSimpleCollision(Cube),
+	                                                        FVector(500.0, 0.0, 0.0), FRotator::ZeroRotator,
+	                                                        FVector::OneVector);
+	TestWorld.SpawnMesh(Cube, FVector(1000.0, 0.0, 0.0), FRotator::ZeroRotator, FVector::OneVector);
+
+	const FCollisionQueryParams Params;
+	const FHitResult Hit = FScenePicker::TraceTwoPhase(TestWorld.World, FVector::ZeroVector, FVector::ForwardVector,
+	                                                   Params, 10000.f);
+	TestTrue(TEXT("Two-phase trace hits"), Hit.bBlockingHit);
+	TestEqual(TEXT("Two-phase trace hits the front mesh"), Hit.GetComponent(), Front);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FScenePickerMatchesComplexTraceTest,
+                                 "Blend4Real.Picking.TwoPhase.MatchesComplexTrace",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FScenePickerMatchesComplexTraceTest::RunTest(const FString& Parameters)
+{
+	UStaticMesh* Cube = LoadCube();
+	if (!TestNotNull(TEXT("Engine cube"), Cube))
+	{
+		return false;
+	}
+
+	// Rows of rotated and scaled cubes at increasing depth, with and without simple collision
+	const FPickingTestWorld TestWorld;
+	UStaticMesh* CubeWithoutSimpleCollision = CreateCubeWithoutSimpleCollision(Cube);
+	FRandomStream Random(0);
+	for (int32 Row = 0; Row < 4; ++Row)
+	{
+		for (int32 Y = -3; Y <= 3; ++Y)
+		{
+			for (int32 Z = -3; Z <= 3; ++Z)
+			{
+				const FVector Location(500.0 + Row * 300.0, Y * 150.0, Z * 150.0);
+				const FRotator Rotation(Random.FRandRange(0.f, 90.f), Random.FRandRange(0.f, 90.f), 0.f);
+				const FVector Scale(Random.FRandRange(0.5f, 1.5f));
+				TestWorld.SpawnMesh(Random.FRand() < 0.3f ? CubeWithoutSimpleCollision : Cube, Location, Rotation, Scale);
+			}
+		}
+	}
+
+	// Rays from a point in front of the rows, through a grid on the first row plane
+	const FCollisionQueryParams Params;
+	constexpr int32 GridSize = 32;
+	int32 Mismatches = 0;
+	for (int32 Y = 0; Y < GridSize; ++Y)
+	{
+		for (int32 Z = 0; Z < GridSize; ++Z)
+		{
+			const FVector Target(500.0, (Y + 0.5) * 1200.0 / GridSize - 600.0, (Z + 0.5) * 1200.0 / GridSize - 600.0);
+			const FVector Direction = Target.GetSafeNormal();
+			const FHitResult Complex = FScenePicker::TraceComplex(TestWorld.World, FVector::ZeroVector, Direction,
+			                                                      Params, 10000.f);
+			const FHitResult TwoPhase = FScenePicker::TraceTwoPhase(TestWorld.World, FVector::ZeroVector, Direction,
+			                                                        Params, 10000.f);
+			if (!IsSameHit(Complex, TwoPhase))
+			{
+				++Mismatches;
+				AddError(FString::Printf(TEXT("Mismatch towards %s: %s vs %s"), *Target.ToString(),
+				                         Complex.GetComponent() ? *Complex.GetComponent()->GetPathName() : TEXT("none"),
+				                         TwoPhase.GetComponent() ? *TwoPhase.GetComponent()->GetPathName() : TEXT("none")));
+			}
+		}
+	}
+	TestEqual(TEXT("Mismatches with the complex trace"), Mismatches, 0);
+	return true;
+}
+
+#endif
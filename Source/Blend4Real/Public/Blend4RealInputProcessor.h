@@ -8,6 +8,8 @@ class FNavigationController;
 class FTransformController;
 class FSelectionActionsController;
 class FPivotVisualizationController;
+class FViewportRedrawController;
+class FHoverPickPrefetcher;
 class UBlenderOrbitInteraction;
 class UViewportOrbitInteraction;
 
@@ -30,6 +32,8 @@ public:
 	virtual bool
 	HandleMouseButtonDoubleClickEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override;
 	virtual bool HandleMouseButtonUpEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override;
+	virtual bool HandleMouseWheelOrGestureEvent(FSlateApplication& SlateApp, const FPointerEvent& InWheelEvent,
+	                                            const FPointerEvent* InGestureEvent) override;
 
 	void ToggleEnabled(const bool bInvalidateRender = true);
 	bool IsEnabled() const { return bIsEnabled; }
@@ -49,4 +53,6 @@ private:
 	TSharedPtr<FTransformController> TransformController;
 	TSharedPtr<FSelectionActionsController> SelectionActionsController;
 	TSharedPtr<FPivotVisualizationController> PivotVisualizationController;
+	TSharedPtr<FViewportRedrawController> RedrawController;
+	TSharedPtr<FHoverPickPrefetcher> HoverPickPrefetcher;
 };
@@ -13,6 +13,78 @@ enum class EBlend4RealOrbitMode : uint8
 	OrbitAroundSelection UMETA(DisplayName = "Orbit Around Selection", ToolTip = "Orbit around the center of the selected actors")
 };
 
+UENUM(BlueprintType)
+enum class EBlend4RealSnapElement : uint8
+{
+	None UMETA(DisplayName = "None", ToolTip = "Grab only snaps to the grid"),
+	Vertex UMETA(DisplayName = "Vertex", ToolTip = "Snap the grabbed pivot to the mesh vertex closest to the cursor"),
+	Edge UMETA(DisplayName = "Edge", ToolTip = "Snap the grabbed pivot to the closest point of the mesh edge closest to the cursor"),
+	VertexAndEdge UMETA(DisplayName = "Vertex and Edge", ToolTip = "Snap to vertices, or to edges when no vertex is in range"),
+	BoundsFace UMETA(DisplayName = "Bounds Face", ToolTip = "Move the selection so its bounds touch or align with the closest faces of nearby actors bounds"),
+	Pivot UMETA(DisplayName = "Actor Pivot", ToolTip = "Snap the grabbed pivot to the pivot of the actor closest to the cursor")
+};
+
+UENUM(BlueprintType)
+enum class EBlend4RealDropDirection : uint8
+{
+	Down UMETA(DisplayName = "Down (-Z)"),
+	Up UMETA(DisplayName = "Up (+Z)"),
+	PositiveX UMETA(DisplayName = "+X"),
+	NegativeX UMETA(DisplayName = "-X"),
+	PositiveY UMETA(DisplayName = "+Y"),
+	NegativeY UMETA(DisplayName = "-Y")
+};
+
+UENUM(BlueprintType)
+enum class EBlend4RealProportionalFalloff : uint8
+{
+	Smooth UMETA(DisplayName = "Smooth"),
+	Sphere UMETA(DisplayName = "Sphere"),
+	Root UMETA(DisplayName = "Root"),
+	Linear UMETA(DisplayName = "Linear"),
+	Sharp UMETA(DisplayName = "Sharp"),
+	Constant UMETA(DisplayName = "Constant")
+};
+
+/**
+ * Rendering features degraded in the interacting viewport while orbiting, panning or transforming.
+ * Everything is restored when the operation ends.
+ */
+USTRUCT()
+struct FBlend4RealInteractionQuality
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality",
+		meta = (DisplayName = "Enable Interaction Quality", ToolTip = "Lower the rendering quality of the interacting viewport during navigation and transforms"))
+	bool bEnabled = false;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality",
+		meta = (EditCondition = "bEnabled", ClampMin = "10", ClampMax = "100", Units = "Percent",
+			ToolTip = "Screen percentage used during the interaction. 100 keeps the viewport resolution"))
+	int32 ScreenPercentage = 50;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality", meta = (EditCondition = "bEnabled"))
+	bool bDisableDynamicShadows = true;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality", meta = (EditCondition = "bEnabled"))
+	bool bDisableGlobalIllumination = true;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality", meta = (EditCondition = "bEnabled"))
+	bool bDisableTranslucency = false;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality", meta = (EditCondition = "bEnabled"))
+	bool bDisablePostProcessing = false;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality",
+		meta = (EditCondition = "bEnabled", ToolTip = "Force the viewport to render in realtime during the interaction"))
+	bool bForceRealtime = false;
+
+	UPROPERTY(EditAnywhere, Category = "Interaction Quality",
+		meta = (EditCondition = "bEnabled", ToolTip = "Log the frame rate before and during each interaction"))
+	bool bReportFrameRate = false;
+};
+
 UCLASS(config = EditorPerProjectUserSettings, meta = (DisplayName = "Blend4Real"))
 class BLEND4REAL_API UBlend4RealSettings : public UDeveloperSettings
 {
@@ -35,6 +107,104 @@ public:
 	bool ShouldOrbitAroundSelection() const { return OrbitMode == EBlend4RealOrbitMode::OrbitAroundSelection; }
 	bool ShouldOrbitAroundMouseHit() const { return OrbitMode == EBlend4RealOrbitMode::OrbitAroundMouseProjection; }
 
+	// ===== Snapping =====
+	UPROPERTY(Config, EditAnywhere, Category = "Snapping",
+		meta = (DisplayName = "Snap Element",
+			ToolTip = "Element the pivot snaps to during a free grab when snapping is active (grid snapping enabled, or Ctrl held)"))
+	EBlend4RealSnapElement SnapElement = EBlend4RealSnapElement::None;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Snapping",
+		meta = (DisplayName = "Element Snap Radius", ClampMin = "1", ClampMax = "64", Units = "Pixels",
+			EditCondition = "SnapElement != EBlend4RealSnapElement::None",
+			ToolTip = "Maximum distance from the cursor to a snapped vertex, edge or pivot. Bounds faces snap within the same distance on screen"))
+	int32 ElementSnapRadius = 12;
+
+	// ===== Proportional Editing =====
+	UPROPERTY(Config, EditAnywhere, Category = "Proportional Editing",
+		meta = (DisplayName = "Proportional Editing",
+			ToolTip = "Transforms also move the unselected actors around the selection, weighted by the falloff. Toggled with the Proportional Editing key"))
+	bool bProportionalEditing = false;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Proportional Editing",
+		meta = (DisplayName = "Falloff", ToolTip = "How the influence of the transform decreases with the distance to the selection"))
+	EBlend4RealProportionalFalloff ProportionalFalloff = EBlend4RealProportionalFalloff::Smooth;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Proportional Editing",
+		meta = (DisplayName = "Radius", ClampMin = "1", Units = "Centimeters",
+			ToolTip = "Distance from the selected pivots where the influence reaches zero. Adjusted with the mouse wheel during a transform"))
+	float ProportionalRadius = 1000.f;
+
+	// ===== Repeat Last =====
+	UPROPERTY(Config, EditAnywhere, Category = "Repeat Last",
+		meta = (DisplayName = "Number of Copies", ClampMin = "1", UIMin = "1", UIMax = "1000",
+			ToolTip = "Copies of the selection created by Repeat Last, each one moved by the last confirmed transform from the previous one"))
+	int32 RepeatLastCount = 1;
+
+	// ===== Drop to Surface =====
+	UPROPERTY(Config, EditAnywhere, Category = "Drop to Surface",
+		meta = (DisplayName = "Drop Direction", ToolTip = "World direction the selected actors are swept along by Drop to Surface"))
+	EBlend4RealDropDirection DropDirection = EBlend4RealDropDirection::Down;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Drop to Surface",
+		meta = (DisplayName = "Align to Surface Normal", ToolTip = "Rotate the dropped actors so they follow the normal of the surface they land on"))
+	bool bDropAlignToNormal = false;
+
+	FVector GetDropDirectionVector() const;
+
+	// ===== Performance =====
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Inactive Viewport Redraw Rate", ClampMin = "0", UIMin = "0", UIMax = "60", Units = "Hz",
+			ToolTip = "How often level viewports other than the one being interacted with are redrawn during a transform. 0 only redraws them when the transform is confirmed or cancelled"))
+	float InactiveViewportRedrawRate = 10.f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Prefetch Hover Pick",
+			ToolTip = "Trace the scene under the resting cursor in the background, so orbit, pan and focus start without a blocking trace"))
+	bool bPrefetchHoverPick = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Two-Phase Picking",
+			ToolTip = "Bound the complex trace by the first primitive blocking the ray with its simple collision, so the complex trace stops there instead of crossing the whole scene"))
+	bool bTwoPhasePicking = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Pick Meshes Without Collision",
+			ToolTip = "Pick, focus and snap to static meshes without collision by tracing their triangles. Triangle data is cached in the DerivedDataCache"))
+	bool bPickMeshesWithoutCollision = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Max Surface Snap Traces In Flight", ClampMin = "1", UIMin = "16", UIMax = "4096",
+			ToolTip = "Surface snapping of a multi-selection traces each item asynchronously. Caps the number of traces issued and not yet completed, items beyond it are traced on the next frames"))
+	int32 MaxSurfaceSnapTracesInFlight = 256;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Selection Mask Filter Bit", ClampMin = "0", ClampMax = "5",
+			ToolTip = "Body mask filter bit tagging the moving selection, so surface snapping traces skip it at a constant cost. The engine has 6 mask filter bits (0 to 5). Change it if the project or another plugin already uses this bit"))
+	int32 SelectionMaskFilterBit = 5;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Ghost Duplicate Min Selection", ClampMin = "0", UIMin = "0", UIMax = "1000",
+			ToolTip = "Duplicating at least this many actors drags bounds box proxies and only spawns the copies when the grab is confirmed. Cancelling spawns nothing. 0 always spawns the copies before the grab"))
+	int32 GhostDuplicateMinSelection = 50;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Repeat Last Frame Budget", ClampMin = "1", UIMin = "1", UIMax = "100", Units = "Milliseconds",
+			ToolTip = "Time spent spawning the copies of Repeat Last per frame. Large arrays are spawned over several frames and can be cancelled with Escape"))
+	float RepeatLastFrameBudgetMs = 10.f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Incremental Spline Min Points", ClampMin = "0", UIMin = "0", UIMax = "10000",
+			ToolTip = "Dragging points of splines with at least this many points only measures the segments next to the moved points again. The whole spline is updated when the transform is confirmed. 0 always updates the whole spline"))
+	int32 IncrementalSplineMinPoints = 100;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance",
+		meta = (DisplayName = "Defer World Partition Updates",
+			ToolTip = "In World Partition levels, moved actors are only notified when the transform is confirmed, so actor descriptors, cell assignment and loading ranges are updated once instead of at every mouse move"))
+	bool bDeferWorldPartitionUpdates = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Performance", meta = (DisplayName = "Interaction Quality"))
+	FBlend4RealInteractionQuality InteractionQuality;
+
 	// ===== Keybindings: Transform Initiation =====
 	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Transform",
 		meta = (DisplayName = "Begin Translation (Grab)"))
@@ -48,6 +218,10 @@ public:
 		meta = (DisplayName = "Begin Scale"))
 	FInputChord ScaleKey = FInputChord(EKeys::S);
 
+	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Transform",
+		meta = (DisplayName = "Toggle Proportional Editing"))
+	FInputChord ProportionalEditingKey = FInputChord(EKeys::O);
+
 	// ===== Keybindings: Transform Reset =====
 	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Transform Reset",
 		meta = (DisplayName = "Reset Translation"))
@@ -66,10 +240,22 @@ public:
 		meta = (DisplayName = "Duplicate"))
 	FInputChord DuplicateKey = FInputChord(EModifierKey::Shift, EKeys::D);
 
+	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Objects",
+		meta = (DisplayName = "Instanced Duplicate", ToolTip = "Duplicate the selected static mesh actors as instances of a shared instanced static mesh component"))
+	FInputChord InstancedDuplicateKey = FInputChord(EModifierKey::Alt, EKeys::D);
+
+	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Objects",
+		meta = (DisplayName = "Repeat Last", ToolTip = "Duplicate the selection and apply the last confirmed transform to the copy, Number of Copies times"))
+	FInputChord RepeatLastKey = FInputChord(EModifierKey::Shift, EKeys::R);
+
 	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Objects",
 		meta = (DisplayName = "Delete Selected"))
 	FInputChord DeleteSelectedKey = FInputChord(EKeys::X);
 
+	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Objects",
+		meta = (DisplayName = "Drop to Surface", ToolTip = "Sweep the bounds of every selected actor along the drop direction and place it on the first hit"))
+	FInputChord DropToSurfaceKey = FInputChord(EKeys::End);
+
 	// ===== Keybindings: Camera Navigation =====
 	UPROPERTY(Config, EditAnywhere, Category = "Keybindings|Camera",
 		meta = (DisplayName = "Orbit Camera"))
@@ -4,7 +4,9 @@
 #include "InputCoreTypes.h"
 
 class FSceneView;
+class ULevel;
 class FEditorViewportClient;
+class SWidget;
 struct FHitResult;
 struct FCollisionQueryParams;
 struct FKeyEvent;
@@ -55,9 +57,45 @@ namespace Blend4RealUtils
 	/** Axis labels for debug output (indexed by ETransformAxis) */
 	extern const char* AxisLabels[ETransformAxis::TransformAxes_Count];
 
+	/** Length of the scene picking traces */
+	constexpr float ScenePickDistance = 1000000.f;
+
+	/** A ray cast from a viewport pixel, identified by the pixel and the view it was computed from */
+	struct FScreenRay
+	{
+		FEditorViewportClient* ViewportClient = nullptr;
+		FIntPoint Pixel = FIntPoint::ZeroValue;
+		/** Hash of the view projection matrix and view rect, changes whenever the camera moves */
+		uint32 ViewHash = 0;
+		FVector Origin = FVector::ZeroVector;
+		FVector Direction = FVector::ZeroVector;
+		/** Distance to the far clip plane of the view, ScenePickDistance if it has none */
+		float MaxDistance = ScenePickDistance;
+	};
+
 	/** Get the editor world from the active viewport */
 	UWorld* GetEditorWorld();
 
+	/**
+	 * Check if actors moved in the world are only notified once the move is finished (PostEditMove(true)).
+	 * True in World Partition levels with bDeferWorldPartitionUpdates, where in-progress move notifications
+	 * update the World Partition bookkeeping at input rate.
+	 */
+	bool ShouldDeferActorMoveUpdates(const UWorld* World);
+
+	/**
+	 * Warn about the spatially loaded actors moved outside of every region loaded in the editor, where they will be
+	 * unloaded with their cells. Only applies to World Partition levels with streaming enabled.
+	 */
+	void WarnActorsOutsideLoadedRegions(const TArray<AActor*>& Actors);
+
+	/**
+	 * Duplicate the actors into the level in one batch, offset by Offset.
+	 * OutCopies[i] is the copy of Sources[i], or nullptr if it couldn't be duplicated.
+	 */
+	void DuplicateActorsInOrder(const TArray<AActor*>& Sources, ULevel* Level, const FVector& Offset,
+	                            TArray<AActor*>& OutCopies);
+
 	/** Get the active scene view for raycasting */
 	FSceneView* GetActiveSceneView(FEditorViewportClient* EClient = nullptr);
 
@@ -86,15 +124,24 @@ namespace Blend4RealUtils
 	 */
 	FHitResult ScenePickAtPosition(const FVector2D& MousePosition, FVector& OutRayOrigin, FVector& OutRayDirection);
 
+	/**
+	 * Compute the world space ray under the given mouse position
+	 * @param MousePosition - Screen space position
+	 * @param OutRay - Output ray, with the viewport client, pixel and view hash it was computed from
+	 * @return False if the mouse is not over an editor viewport
+	 */
+	bool ComputeScreenRay(const FVector2D& MousePosition, FScreenRay& OutRay);
+
 	/**
 	 * Project a ray onto scene surfaces
 	 * @param Start - Ray start position
 	 * @param Direction - Ray direction (should be normalized)
 	 * @param Params - Collision query parameters
+	 * @param MaxDistance - Maximum trace length, further clipped to the world bounds
 	 * @return Hit result from the trace
 	 */
 	FHitResult ProjectToSurface(const UWorld* World, const FVector& Start, const FVector& Direction,
-	                            const FCollisionQueryParams& Params);
+	                            const FCollisionQueryParams& Params, float MaxDistance = ScenePickDistance);
 
 	/** Check if the key event is a transform key (G/R/S) */
 	bool IsTransformKey(const FKeyEvent& KeyEvent);
@@ -164,6 +211,14 @@ namespace Blend4RealUtils
 	                                                        FVector2D& OutViewportScreenOrigin,
 	                                                        const FName& ViewportTypeFilter = NAME_None);
 
+	/**
+	 * Get the viewport widget of the given type under a screen position
+	 * @param ScreenPosition - Screen space position to check
+	 * @param ViewportType - Widget type of the viewport (e.g., "SSCSEditorViewport")
+	 * @return The viewport widget, or nullptr if not over a viewport of that type
+	 */
+	TSharedPtr<SWidget> GetViewportWidgetAtPosition(const FVector2D& ScreenPosition, const FName& ViewportType);
+
 	/** Get the 3D hit point on a plane from mouse position */
 	FVector GetPlaneHit(const FVector& Normal, float Distance, FVector& RayOrigin, FVector& RayDirection);
 }
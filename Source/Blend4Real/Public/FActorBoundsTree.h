@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Dynamic AABB tree over the bounds of the actors of a world, used for bounds and pivot snapping.
+ *
+ * One tree is built per world on first use, then kept up to date from the editor delegates
+ * (actor moved, added, deleted) instead of iterating actors. Moves that don't broadcast OnActorMoved
+ * (e.g. components moved on their own) are reported by the transform handlers through MarkActorDirty().
+ * Leaves store fattened boxes so small moves don't restructure the tree. Leaves are identified by proxy ids, stable for the lifetime of the actor.
+ */
+class FActorBoundsTree
+{
+public:
+	/**
+	 * Subscribe to the editor delegates keeping the trees up to date. Called on module startup.
+	 * The engine delegates are bound once the engine is initialized.
+	 */
+	static void Initialize();
+
+	/** Release all trees and unsubscribe. Called on module shutdown */
+	static void Shutdown();
+
+	/** Get the tree of a world, building it if needed */
+	static FActorBoundsTree* Get(const UWorld* World);
+
+	/** Update the bounds of an actor (and its attached actors) the next time its tree is used */
+	static void MarkActorDirty(const AActor* Actor);
+
+	/** Get the proxy id of an actor, INDEX_NONE if it is not in the tree */
+	int32 FindProxy(const AActor* Actor) const;
+
+	/** Get the actor of a proxy, null if it was destroyed */
+	const AActor* GetActor(int32 ProxyId) const { return Nodes[ProxyId].Actor.Get(); }
+
+	/** Get the component bounds of the actor of a proxy, invalid if it has no primitive */
+	const FBox& GetBounds(int32 ProxyId) const { return Nodes[ProxyId].Bounds; }
+
+	/** Get the pivot (actor location) of a proxy */
+	const FVector& GetPivot(int32 ProxyId) const { return Nodes[ProxyId].Pivot; }
+
+	/**
+	 * Visit the proxies of the nodes accepted by the filter
+	 * @param NodeFilter - Returns false to skip a node (given its fattened box) and its children
+	 * @param Visit - Called with each proxy in an accepted leaf
+	 */
+	void Query(TFunctionRef<bool(const FBox& Box)> NodeFilter, TFunctionRef<void(int32 ProxyId)> Visit) const;
+
+	int32 GetNumProxies() const { return ActorProxies.Num(); }
+	int32 GetHeight() const { return Root == INDEX_NONE ? 0 : Nodes[Root].Height; }
+
+private:
+	struct FNode
+	{
+		/** Fattened box for leaves, union of the children for internal nodes */
+		FBox Box = FBox(ForceInit);
+		int32 Parent = INDEX_NONE;
+		int32 Child1 = INDEX_NONE;
+		int32 Child2 = INDEX_NONE;
+		/** Leaves have height 0, free nodes -1 */
+		int32 Height = -1;
+
+		// Leaf data
+		TWeakObjectPtr<const AActor> Actor;
+		FBox Bounds = FBox(ForceInit);
+		FVector Pivot = FVector::ZeroVector;
+
+		bool IsLeaf() const { return Child1 == INDEX_NONE; }
+	};
+
+	void Build(const UWorld* World);
+	void AddActor(const AActor* Actor);
+	void RemoveActor(const AActor* Actor);
+	void UpdateActor(const AActor* Actor);
+
+	int32 AllocateNode();
+	void FreeNode(int32 NodeIndex);
+	void InsertLeaf(int32 Leaf);
+	void RemoveLeaf(int32 Leaf);
+	int32 Balance(int32 NodeIndex);
+
+	/** Update an actor and the actors attached to it */
+	void UpdateActorHierarchy(const AActor* Actor);
+
+	static void BindEngineDelegates();
+	static bool ShouldTrack(const AActor* Actor);
+	static void ComputeActorBounds(const AActor* Actor, FBox& OutBounds, FVector& OutPivot);
+	static void ForEachWorldTree(const AActor* Actor, TFunctionRef<void(FActorBoundsTree&)> Callback);
+
+	TArray<FNode> Nodes;
+	int32 Root = INDEX_NONE;
+	/** Free nodes are chained through their Parent index */
+	int32 FreeList = INDEX_NONE;
+	TMap<TObjectKey<AActor>, int32> ActorProxies;
+	bool bDirty = true;
+
+	/** Actors to update before the next use of the tree */
+	TSet<TWeakObjectPtr<const AActor>> DirtyActors;
+
+	static TMap<TObjectKey<UWorld>, TUniquePtr<FActorBoundsTree>> WorldTrees;
+	static FDelegateHandle PostEngineInitHandle;
+	static FDelegateHandle ActorMovedHandle;
+	static FDelegateHandle ActorAddedHandle;
+	static FDelegateHandle ActorDeletedHandle;
+	static FDelegateHandle PropertyChangedHandle;
+	static FDelegateHandle UndoRedoHandle;
+	static FDelegateHandle MapChangedHandle;
+	static FDelegateHandle LevelAddedHandle;
+	static FDelegateHandle LevelRemovedHandle;
+	static FDelegateHandle WorldCleanupHandle;
+};
@@ -3,14 +3,24 @@
 #include "CoreMinimal.h"
 #include "IBlend4RealTransformHandler.h"
 
+class AActor;
+
 /**
  * Transform handler for Level Editor actors.
- * Operates on GEditor->GetSelectedActors().
+ * Operates on GEditor->GetSelectedActors(), or on a subset of them given on construction (mixed selections).
+ * The actors are cached when the initial state is first captured, the handler can then be reused by the next
+ * transforms of the same selection.
+ *
+ * In World Partition levels, the actors are only notified of their move on confirm (see bDeferWorldPartitionUpdates),
+ * so the World Partition bookkeeping runs once for the whole selection instead of at every mouse move.
  */
 class FActorTransformHandler : public IBlend4RealTransformHandler
 {
 public:
 	FActorTransformHandler() = default;
+
+	/** Transform the given actors only, instead of the whole actor selection */
+	explicit FActorTransformHandler(const TArray<AActor*>& InActors);
 	virtual ~FActorTransformHandler() override = default;
 
 	// Selection Queries
@@ -25,11 +35,16 @@ public:
 	// State Management
 	virtual void CaptureInitialState() override;
 	virtual void RestoreInitialState() override;
+	virtual bool RecaptureInitialState() override;
 
 	// Transform Application
 	virtual void
 	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
 	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
+	virtual bool SupportsProportionalEditing() const override { return true; }
+	virtual void GetMovedActors(TArray<AActor*>& OutActors) const override { OutActors.Append(GetActors()); }
 
 	// Transaction Handling
 	virtual int32 BeginTransaction(const FText& Description) override;
@@ -40,6 +55,16 @@ public:
 	const FTransform* GetInitialTransform(uint32 ActorUniqueID) const;
 
 private:
+	/** The actors to transform: the cached actors, or the selected actors before the first capture */
+	TArray<AActor*> GetActors() const;
+
+	/** Actors given on construction, or selected when the initial state was first captured */
+	TArray<TWeakObjectPtr<AActor>> CachedActors;
+	bool bActorsCached = false;
+
+	/** The actors are only notified of their move on confirm */
+	bool bDeferMoveUpdates = false;
+
 	/** Stored initial transforms keyed by actor unique ID */
 	TMap<uint32, FTransform> InitialTransforms;
 };
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IBlend4RealTransformHandler.h"
+
+class UDebugSkelMeshComponent;
+class FEditorViewportClient;
+
+/**
+ * Transform handler for the bones selected in a Persona preview scene (Skeleton, Skeletal Mesh and Animation editors).
+ * Bones are edited like Persona does, through the bone modifiers of the preview instance.
+ *
+ * The component space pose of the selected bones is cached once when the initial state is captured.
+ * Applied transforms only update that cache, the bone modifiers are written once per frame from
+ * FlushDeferredUpdates() and picked up by the next pose evaluation of the preview component.
+ */
+class FBoneTransformHandler : public IBlend4RealTransformHandler
+{
+public:
+	/**
+	 * @param InPreviewComponent - Preview mesh component of the Persona viewport, its selected bones are transformed
+	 */
+	explicit FBoneTransformHandler(UDebugSkelMeshComponent* InPreviewComponent);
+	virtual ~FBoneTransformHandler() override = default;
+
+	/** Get the preview mesh component of the Persona preview scene displayed by the given viewport */
+	static UDebugSkelMeshComponent* FindPreviewComponent(FEditorViewportClient* ViewportClient);
+
+	/**
+	 * Compute the bone modifier moving a bone to a component space transform.
+	 * The preview instance applies its modifiers as additive, in parent bone space: the scale multiplies the local
+	 * scale, the rotation is pre-multiplied onto the local rotation and the translation is added to the local translation.
+	 * @param ParentComponentSpace - Component space transform of the parent bone, identity for the root
+	 * @param BaseLocal - Local transform of the bone without modifier, relative to its parent
+	 * @param Target - Component space transform the bone should end at
+	 * @return The modifier translation, rotation and scale, stored as is in a transform (not to be composed)
+	 */
+	static FTransform ComputeModifier(const FTransform& ParentComponentSpace, const FTransform& BaseLocal,
+	                                  const FTransform& Target);
+
+	// Selection Queries
+	virtual bool HasSelection() const override;
+	virtual int32 GetSelectionCount() const override;
+
+	// Transform Data
+	virtual FTransform ComputeSelectionPivot() const override;
+	virtual FTransform GetFirstSelectedItemTransform() const override;
+	virtual FVector ComputeAverageLocalAxis(EAxis::Type Axis) const override;
+
+	// State Management
+	virtual void CaptureInitialState() override;
+	virtual void RestoreInitialState() override;
+
+	// Transform Application
+	virtual void
+	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
+	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual void FlushDeferredUpdates() override;
+
+	// Transaction Handling
+	virtual int32 BeginTransaction(const FText& Description) override;
+	virtual void EndTransaction() override;
+	virtual void CancelTransaction(int32 TransactionIndex) override;
+
+	// Visualization Context
+	virtual UWorld* GetVisualizationWorld() const override;
+
+private:
+	struct FSelectedBone
+	{
+		FName Name;
+		int32 Index = INDEX_NONE;
+		/** Component space transform of the parent bone, identity for the root */
+		FTransform ParentComponentSpace;
+		/** Local transform of the bone before its modifier is applied, relative to its parent */
+		FTransform BaseLocal;
+		/** World transforms */
+		FTransform Initial;
+		FTransform Current;
+		/** Modifier of the bone when the transform began, restored on cancel, see ComputeModifier() */
+		bool bHadModifier = false;
+		FTransform InitialModifier;
+	};
+
+	/** Write a bone modifier, see ComputeModifier() */
+	void WriteModifier(const FSelectedBone& Bone, const FTransform& Modifier) const;
+
+	TWeakObjectPtr<UDebugSkelMeshComponent> PreviewComponent;
+
+	/** Selected bones whose ancestors aren't selected, children follow their parent */
+	TArray<FSelectedBone> Bones;
+	bool bDirty = false;
+	bool bCaptured = false;
+};
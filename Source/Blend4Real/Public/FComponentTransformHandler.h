@@ -9,6 +9,8 @@ class USelection;
 /**
  * Transform handler for components selected in the Level Editor.
  * Uses GEditor->GetSelectedComponents() for selection.
+ * The components are cached when the initial state is first captured, the handler can then be reused by the next
+ * transforms of the same selection.
  */
 class FComponentTransformHandler : public IBlend4RealTransformHandler
 {
@@ -28,11 +30,14 @@ public:
 	// === State Management ===
 	virtual void CaptureInitialState() override;
 	virtual void RestoreInitialState() override;
+	virtual bool RecaptureInitialState() override;
 
 	// === Transform Application ===
 	virtual void
 	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
 	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
 
 	// === Transaction Handling ===
 	virtual int32 BeginTransaction(const FText& Description) override;
@@ -43,6 +48,13 @@ private:
 	/** Get the component selection from GEditor */
 	USelection* GetSelectedComponents() const;
 
+	/** The components to transform: the cached components, or the selected components before the first capture */
+	TArray<USceneComponent*> GetComponents() const;
+
+	/** Components selected when the initial state was first captured */
+	TArray<TWeakObjectPtr<USceneComponent>> CachedComponents;
+	bool bComponentsCached = false;
+
 	/** Stored initial transforms keyed by component unique ID */
 	TMap<uint32, FTransform> InitialTransforms;
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IBlend4RealTransformHandler.h"
+
+/**
+ * Transform handler for mixed selections, e.g. actors and components selected together in the Level Editor.
+ *
+ * The selection is partitioned into one handler per item type when the composite is created.
+ * The sub-handlers share the pivot of the whole selection and are applied in a fixed order, inside one transaction,
+ * so each batch still runs through the handler of its type.
+ * Item ids of the sub-handlers must be distinct (e.g. UObject unique ids).
+ */
+class FCompositeTransformHandler : public IBlend4RealTransformHandler
+{
+public:
+	/** @param InHandlers - Sub-handlers, applied in this order */
+	explicit FCompositeTransformHandler(const TArray<TSharedPtr<IBlend4RealTransformHandler>>& InHandlers);
+	virtual ~FCompositeTransformHandler() override = default;
+
+	// Selection Queries
+	virtual bool HasSelection() const override;
+	virtual int32 GetSelectionCount() const override;
+
+	// Transform Data
+	virtual FTransform ComputeSelectionPivot() const override;
+	virtual FTransform GetFirstSelectedItemTransform() const override;
+	virtual FVector ComputeAverageLocalAxis(EAxis::Type Axis) const override;
+
+	// State Management
+	virtual void CaptureInitialState() override;
+	virtual void RestoreInitialState() override;
+	virtual bool RecaptureInitialState() override;
+
+	// Transform Application
+	virtual void
+	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
+	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
+	virtual void GetMovedInstances(TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const override;
+	virtual void GetMovedActors(TArray<AActor*>& OutActors) const override;
+	virtual void FlushDeferredUpdates() override;
+
+	// Transaction Handling
+	virtual int32 BeginTransaction(const FText& Description) override;
+	virtual void EndTransaction() override;
+	virtual void CancelTransaction(int32 TransactionIndex) override;
+
+private:
+	/** Sub-handlers with a selection */
+	TArray<TSharedPtr<IBlend4RealTransformHandler>> Handlers;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blend4RealSettings.h"
+
+class FEditorViewportClient;
+struct FCollisionQueryParams;
+
+/** What is being moved, captured when a grab begins */
+struct FElementSnapContext
+{
+	/** Actors and components never snapped to by vertex and edge snapping (e.g. the ones being moved) */
+	TSet<const UObject*> ExcludedObjects;
+
+	/** Actor bounds tree proxies never snapped to by bounds and pivot snapping */
+	TSet<int32> ExcludedBoundsProxies;
+
+	/** World bounds of the moved objects when the grab began */
+	FBox SelectionBounds = FBox(ForceInit);
+
+	/** Pivot location when the grab began */
+	FVector InitialPivot = FVector::ZeroVector;
+};
+
+/**
+ * Finds the element the grabbed pivot snaps to, for Blender-style element snapping during grab.
+ *
+ * Vertex and edge candidates are the actors of the world's FActorBoundsTree reaching the snap cone around the cursor ray,
+ * in front of the first surface under the cursor. They are then searched through the shared per-mesh vertex KD-trees.
+ * Bounds face and pivot candidates are found through the same tree.
+ */
+class FElementSnapper
+{
+public:
+	/**
+	 * Find the snapped pivot location for the cursor of a viewport
+	 * @param ViewportClient - Viewport the cursor is in
+	 * @param Element - Elements to snap to
+	 * @param Context - Objects being moved
+	 * @param TraceParams - Query params of the trace finding the surface under the cursor, ignoring the moved objects
+	 * @param ProposedPivot - Pivot location of the unsnapped grab
+	 * @param OutLocation - New pivot location: the vertex, closest point on the edge, actor pivot,
+	 *                      or ProposedPivot offset so the moved bounds touch the closest faces
+	 * @return True if an element was found within the snap radius
+	 */
+	static bool FindSnapLocation(FEditorViewportClient* ViewportClient, EBlend4RealSnapElement Element,
+	                             const FElementSnapContext& Context, const FCollisionQueryParams& TraceParams,
+	                             const FVector& ProposedPivot, FVector& OutLocation);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IBlend4RealTransformHandler.h"
+#include "FInstanceTransformHandler.h"
+
+class AInstancedFoliageActor;
+class UFoliageType;
+struct FFoliageInfo;
+
+/**
+ * Transform handler for the foliage instances selected in the foliage edit mode.
+ *
+ * The selected indices are cached per foliage actor and foliage type when the initial state is captured.
+ * During the transform the instances are only stored and written to their component once per frame, with one
+ * BatchUpdateInstancesTransforms() call per foliage type. The foliage hash grid is updated once, when the transform
+ * is confirmed or cancelled.
+ */
+class FFoliageTransformHandler : public IBlend4RealTransformHandler
+{
+public:
+	/** Transform the foliage instances currently selected in the editor world */
+	FFoliageTransformHandler();
+	virtual ~FFoliageTransformHandler() override = default;
+
+	// Selection Queries
+	virtual bool HasSelection() const override;
+	virtual int32 GetSelectionCount() const override;
+
+	// Transform Data
+	virtual FTransform ComputeSelectionPivot() const override;
+	virtual FTransform GetFirstSelectedItemTransform() const override;
+	virtual FVector ComputeAverageLocalAxis(EAxis::Type Axis) const override;
+
+	// State Management
+	virtual void CaptureInitialState() override;
+	virtual void RestoreInitialState() override;
+
+	// Transform Application
+	virtual void
+	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
+	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
+	virtual void GetMovedInstances(TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const override;
+	virtual void FlushDeferredUpdates() override;
+
+	// Transaction Handling
+	virtual int32 BeginTransaction(const FText& Description) override;
+	virtual void EndTransaction() override;
+	virtual void CancelTransaction(int32 TransactionIndex) override;
+
+	/** Returns true if the foliage edit mode is active in the level editor */
+	static bool IsFoliageModeActive();
+
+private:
+	/** Selected instances of one foliage type in one foliage actor, sorted by index */
+	struct FFoliageSelection
+	{
+		TWeakObjectPtr<AInstancedFoliageActor> FoliageActor;
+		TWeakObjectPtr<UFoliageType> FoliageType;
+		TArray<int32> Indices;
+		/** World transforms, indexed like Indices */
+		TArray<FTransform> Initial;
+		TArray<FTransform> Current;
+		/** Item id of the first instance, ids are contiguous per foliage type */
+		uint32 FirstItemId = 0;
+		/** Batched writes to the instance component, one per run of nearby selected instances */
+		FInstanceWriteRuns WriteRuns;
+		bool bDirty = false;
+		/** True once the instances were taken out of the foliage hash, they are inserted back on confirm or cancel */
+		bool bMoving = false;
+	};
+
+	FFoliageInfo* FindInfo(const FFoliageSelection& Selection) const;
+
+	/** Take the instances out of the foliage hash before their first move */
+	void BeginMove(FFoliageSelection& Selection) const;
+
+	/** Copy the current transforms to the foliage instances and insert them back into the foliage hash */
+	void FinishMove(FFoliageSelection& Selection) const;
+
+	/** Write the current transforms to the instance component, one batch per run */
+	void WriteInstances(FFoliageSelection& Selection) const;
+
+	TArray<FFoliageSelection> Selections;
+	int32 NumInstances = 0;
+};
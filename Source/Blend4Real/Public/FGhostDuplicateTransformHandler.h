@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IBlend4RealTransformHandler.h"
+
+class AActor;
+class ULineBatchComponent;
+
+static constexpr uint32 GHOST_DUPLICATE_BATCH_ID = 14521275;
+
+/**
+ * Transform handler for a duplicate that doesn't exist yet.
+ *
+ * The selected actors are previewed as bounds boxes while the duplicate is dragged, nothing is spawned.
+ * The copies are created in one batch when the transaction ends, at their final transform,
+ * so cancelling the transform leaves the level untouched.
+ */
+class FGhostDuplicateTransformHandler : public IBlend4RealTransformHandler
+{
+public:
+	/** Preview the duplicate of the actors currently selected in the level editor */
+	FGhostDuplicateTransformHandler();
+	virtual ~FGhostDuplicateTransformHandler() override;
+
+	// Selection Queries
+	virtual bool HasSelection() const override;
+	virtual int32 GetSelectionCount() const override;
+
+	// Transform Data
+	virtual FTransform ComputeSelectionPivot() const override;
+	virtual FTransform GetFirstSelectedItemTransform() const override;
+	virtual FVector ComputeAverageLocalAxis(EAxis::Type Axis) const override;
+
+	// State Management
+	virtual void CaptureInitialState() override;
+	virtual void RestoreInitialState() override;
+
+	// Transform Application
+	virtual void
+	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
+	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
+
+	// Transaction Handling
+	virtual int32 BeginTransaction(const FText& Description) override;
+	virtual void EndTransaction() override;
+	virtual void CancelTransaction(int32 TransactionIndex) override;
+
+private:
+	struct FGhostItem
+	{
+		TWeakObjectPtr<AActor> Source;
+		FTransform Initial;
+		FTransform Current;
+		/** Bounds of the source in its local space, drawn at the current transform */
+		FBox LocalBounds;
+	};
+
+	/** Spawn the copies at the current transforms and select them */
+	void SpawnDuplicates();
+
+	void DrawGhosts();
+	void ClearGhosts();
+
+	TArray<FGhostItem> Items;
+
+	/** True while every item moved by the same translation, the copies can then be offset while they are pasted */
+	bool bUniformTranslation = true;
+	FVector UniformTranslation = FVector::ZeroVector;
+
+	ULineBatchComponent* LineBatcher = nullptr;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blend4RealUtils.h"
+#include "Engine/HitResult.h"
+#include "WorldCollision.h"
+
+class FEditorViewportClient;
+
+/**
+ * Traces the scene under the cursor in the background while the mouse rests over a viewport,
+ * so navigation (orbit pivot, pan plane, focus) can start from a cached hit instead of a blocking trace.
+ * With vertex or edge snapping, the vertex KD-tree of the hovered mesh is built as well, before a grab needs it.
+ *
+ * The cache holds a single pick, keyed by viewport, cursor pixel and view hash.
+ * A pick that doesn't match the cache falls back to a synchronous trace.
+ */
+class FHoverPickPrefetcher
+{
+public:
+	/**
+	 * Collect the result of the pending trace and issue a new one if the cursor or view changed.
+	 * @param MousePosition - Current mouse screen position
+	 */
+	void Tick(const FVector2D& MousePosition);
+
+	/**
+	 * Pick the scene at the given position, using the cached hit when it matches
+	 * @param MousePosition - Screen space position to pick from
+	 * @param OutRayOrigin - Output ray origin in world space
+	 * @param OutRayDirection - Output ray direction in world space
+	 * @return Same result as Blend4RealUtils::ScenePickAtPosition
+	 */
+	FHitResult PickAtPosition(const FVector2D& MousePosition, FVector& OutRayOrigin, FVector& OutRayDirection);
+
+	/** Drop the cached pick and ignore the pending trace (e.g. when the scene is being edited) */
+	void Invalidate();
+
+private:
+	struct FPickKey
+	{
+		FEditorViewportClient* ViewportClient = nullptr;
+		FIntPoint Pixel = FIntPoint::ZeroValue;
+		uint32 ViewHash = 0;
+
+		bool operator==(const FPickKey& Other) const
+		{
+			return ViewportClient == Other.ViewportClient && Pixel == Other.Pixel && ViewHash == Other.ViewHash;
+		}
+	};
+
+	static FPickKey MakeKey(const Blend4RealUtils::FScreenRay& Ray);
+
+	/** Poll the pending trace and move its result to the cache once available */
+	void CollectPendingTrace();
+
+	/** Build the vertex KD-tree (and triangle BVH) of the hovered mesh when element snapping searches vertices */
+	static void PrebuildSnapTree(const FHitResult& Hit);
+
+	// Cached pick
+	bool bHasCachedPick = false;
+	FPickKey CachedKey;
+	FHitResult CachedHit;
+	TWeakObjectPtr<UWorld> CachedWorld;
+	double CachedTime = 0.0;
+
+	// Trace in flight
+	FTraceHandle PendingTrace;
+	FPickKey PendingKey;
+	TWeakObjectPtr<UWorld> PendingWorld;
+	FVector PendingOrigin = FVector::ZeroVector;
+	FVector PendingDirection = FVector::ZeroVector;
+	float PendingLength = 0.f;
+	double PendingIssueTime = 0.0;
+};
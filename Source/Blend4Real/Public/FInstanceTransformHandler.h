@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IBlend4RealTransformHandler.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ * Batched writes of the selected instances of one instanced static mesh component.
+ *
+ * Selected indices are grouped in runs of nearby indices, each written with one BatchUpdateInstancesTransforms() call.
+ * Unselected instances in the small gaps of a run are written back with the transform captured at the beginning,
+ * larger gaps split the run so sparse selections don't rewrite the instances in between.
+ */
+struct FInstanceWriteRuns
+{
+	/**
+	 * Capture the transforms of the instances covered by the runs
+	 * @param SortedIndices - Selected instance indices, sorted
+	 * @param OutTransforms - Optional: world transforms of the selected instances, indexed like SortedIndices
+	 */
+	void Capture(const UInstancedStaticMeshComponent* Component, const TArray<int32>& SortedIndices,
+	             TArray<FTransform>* OutTransforms = nullptr);
+
+	/** Write the world transforms of the selected instances, indexed like the indices given to Capture() */
+	void Write(UInstancedStaticMeshComponent* Component, const TArray<int32>& SortedIndices,
+	           const TArray<FTransform>& Transforms);
+
+	bool IsEmpty() const { return Runs.Num() == 0; }
+	void Reset() { Runs.Reset(); }
+
+private:
+	struct FRun
+	{
+		int32 StartIndex = 0;
+		/** World transforms of the instances from StartIndex */
+		TArray<FTransform> Transforms;
+
+		int32 GetEndIndex() const { return StartIndex + Transforms.Num(); }
+	};
+	TArray<FRun> Runs;
+};
+
+/**
+ * Transform handler for instances of instanced static mesh components (ISM / HISM),
+ * created for the instances selected in the level editor or by Instanced Duplicate.
+ * Instances added by Instanced Duplicate are added inside the transform transaction, so one undo removes them
+ * and cancelling the transform undoes their creation.
+ *
+ * Transforms applied during a frame are only stored. They are written once per frame from FlushDeferredUpdates(),
+ * with one BatchUpdateInstancesTransforms() call per run of nearby selected instances (FInstanceWriteRuns),
+ * instead of one UpdateInstanceTransform() per instance, so grabbing thousands of instances stays interactive.
+ */
+class FInstanceTransformHandler : public IBlend4RealTransformHandler
+{
+public:
+	/**
+	 * @param InInstances - Instance indices to transform, per component
+	 */
+	explicit FInstanceTransformHandler(const TMap<UInstancedStaticMeshComponent*, TArray<int32>>& InInstances);
+
+	/** Adds instances to the world and returns their indices, per component */
+	using FAddInstances = TFunction<TMap<UInstancedStaticMeshComponent*, TArray<int32>>()>;
+
+	/**
+	 * Transform instances added when the transaction begins
+	 * @param InNumInstances - Number of instances InAddInstances adds
+	 * @param InAddInstances - Called once, inside the transaction
+	 * @param InDescription - Transaction description, named after the action adding the instances
+	 */
+	FInstanceTransformHandler(int32 InNumInstances, FAddInstances InAddInstances, const FText& InDescription);
+	virtual ~FInstanceTransformHandler() override = default;
+
+	// Selection Queries
+	virtual bool HasSelection() const override;
+	virtual int32 GetSelectionCount() const override;
+
+	// Transform Data
+	virtual FTransform ComputeSelectionPivot() const override;
+	virtual FTransform GetFirstSelectedItemTransform() const override;
+	virtual FVector ComputeAverageLocalAxis(EAxis::Type Axis) const override;
+
+	// State Management
+	virtual void CaptureInitialState() override;
+	virtual void RestoreInitialState() override;
+
+	// Transform Application
+	virtual void
+	ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
+	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const override;
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) override;
+	virtual void GetMovedInstances(TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const override;
+	virtual void FlushDeferredUpdates() override;
+
+	// Transaction Handling
+	virtual int32 BeginTransaction(const FText& Description) override;
+	virtual void EndTransaction() override;
+	virtual void CancelTransaction(int32 TransactionIndex) override;
+
+private:
+	/** Selected instances of one component, sorted by index */
+	struct FComponentInstances
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+		TArray<int32> Indices;
+		/** World transforms, indexed like Indices */
+		TArray<FTransform> Initial;
+		TArray<FTransform> Current;
+		/** Item id of the first instance, ids are contiguous per component */
+		uint32 FirstItemId = 0;
+		FInstanceWriteRuns WriteRuns;
+		bool bDirty = false;
+	};
+
+	/** Write the current transforms of a component, one batch per run */
+	static void WriteInstances(FComponentInstances& Instances);
+
+	/** Set the instances to transform */
+	void SetInstances(const TMap<UInstancedStaticMeshComponent*, TArray<int32>>& InInstances);
+
+	TArray<FComponentInstances> Components;
+	int32 NumInstances = 0;
+
+	/** Adds the instances to transform when the transaction begins, reset once called */
+	FAddInstances AddInstances;
+	FText AddInstancesDescription;
+	/** True once the instances were added, the transaction is undone instead of cancelled */
+	bool bAddedInstances = false;
+};
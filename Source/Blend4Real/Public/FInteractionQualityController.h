@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShowFlags.h"
+
+class FEditorViewportClient;
+
+/**
+ * Applies the interaction quality profile (UBlend4RealSettings::InteractionQuality) to a viewport
+ * for the duration of a navigation or transform operation, and restores it afterward.
+ * Only the viewport passed to Begin() is affected.
+ */
+class FInteractionQualityController
+{
+public:
+	FInteractionQualityController() = default;
+	~FInteractionQualityController();
+
+	/**
+	 * Apply the interaction quality profile to the viewport.
+	 * Does nothing if the profile is disabled.
+	 * @param ViewportClient - The viewport the operation is captured in
+	 * @param OperationName - Name used when reporting the frame rate
+	 */
+	void Begin(FEditorViewportClient* ViewportClient, const TCHAR* OperationName);
+
+	/** Restore the viewport to its state before Begin() */
+	void End();
+
+	/** Returns true if the profile is currently applied to a viewport */
+	bool IsActive() const { return AppliedViewportClient != nullptr; }
+
+private:
+	FEditorViewportClient* AppliedViewportClient = nullptr;
+	FString CurrentOperationName;
+
+	// Saved viewport state
+	FEngineShowFlags SavedShowFlags = FEngineShowFlags(ESFIM_Editor);
+	bool bScreenPercentageApplied = false;
+	bool bSavedPreviewingScreenPercentage = false;
+	int32 SavedScreenPercentage = 100;
+	bool bRealtimeOverrideApplied = false;
+
+	// Frame rate report
+	bool bReportFrameRate = false;
+	float FrameRateBefore = 0.f;
+	uint64 StartFrameCounter = 0;
+	double StartTime = 0.0;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FMeshTriangleBVH.h"
+#include "FMeshVertexKDTree.h"
+#include "UObject/ObjectKey.h"
+
+class UStaticMesh;
+class UStaticMeshComponent;
+struct FCollisionQueryParams;
+struct FHitResult;
+
+/**
+ * Picking backend for static meshes that physics traces can't hit (no collision, or query collision disabled).
+ *
+ * Triangle BVHs are built lazily from LOD0 render data, shared by all instances of a mesh,
+ * and persisted in the DerivedDataCache keyed by the mesh render data key.
+ * Candidate components are found through the actor bounds tree, then rays are transformed into each
+ * component's local space and tested against the mesh BVH. BVHs of meshes no component uses anymore are
+ * released after garbage collection.
+ */
+class FMeshBVHPicker
+{
+public:
+	/** Subscribe to garbage collection to release unused BVHs. Called on module startup */
+	static void Initialize();
+
+	/** Release all BVHs and unsubscribe. Called on module shutdown */
+	static void Shutdown();
+
+	/**
+	 * Trace the meshes without collision of a world
+	 * @param World - World to trace in
+	 * @param Start - Ray start position
+	 * @param Direction - Ray direction (should be normalized)
+	 * @param Params - Collision query parameters, ignored actors and components are skipped
+	 * @param MaxDistance - Maximum trace length
+	 * @param InOutHit - Replaced by the mesh hit if it is closer than its current blocking hit
+	 * @return True if InOutHit was replaced
+	 */
+	static bool Trace(const UWorld* World, const FVector& Start, const FVector& Direction,
+	                  const FCollisionQueryParams& Params, float MaxDistance, FHitResult& InOutHit);
+
+	/**
+	 * Trace a single component against its mesh BVH
+	 * @return True if the component was hit before OutHit's current blocking hit
+	 */
+	static bool TraceComponent(const UStaticMeshComponent* Component, const FVector& Start, const FVector& End,
+	                           FHitResult& InOutHit);
+
+	/** Get the shared BVH of a mesh, building it or loading it from the DDC if needed */
+	static TSharedPtr<const FMeshTriangleBVH> FindOrBuildBVH(const UStaticMesh* Mesh);
+
+	/** Get the shared vertex KD-tree of a mesh, built from its BVH on first use */
+	static TSharedPtr<const FMeshVertexKDTree> FindOrBuildVertexTree(const UStaticMesh* Mesh);
+
+	/** Returns true if physics traces can't hit this component, so it is picked through its BVH */
+	static bool NeedsBVHPicking(const UStaticMeshComponent* Component);
+
+private:
+	struct FCachedMeshBVH
+	{
+		/** Render data key the BVH was built from, a different key means the mesh was rebuilt */
+		FString SourceKey;
+		TSharedPtr<const FMeshTriangleBVH> BVH;
+	};
+
+	/** Release the BVHs and KD-trees of meshes that were destroyed or that no registered component uses */
+	static void EvictUnusedMeshes();
+
+	static TMap<TObjectKey<UStaticMesh>, FCachedMeshBVH> MeshBVHs;
+	static TMap<TObjectKey<UStaticMesh>, TSharedPtr<const FMeshVertexKDTree>> VertexTrees;
+	static FDelegateHandle PostGarbageCollectHandle;
+};
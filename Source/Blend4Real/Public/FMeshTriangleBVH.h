@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Compact bounding volume hierarchy over the triangles of a mesh, in the mesh's local space.
+ * Built once per static mesh and shared by all its instances, used to pick meshes without collision.
+ */
+struct FMeshTriangleBVH
+{
+	struct FNode
+	{
+		FVector3f Min;
+		/** Leaf: first triangle. Inner node: index of the second child, the first child is the next node */
+		uint32 Offset = 0;
+		FVector3f Max;
+		/** Number of triangles in a leaf, 0 for inner nodes */
+		uint32 Count = 0;
+	};
+
+	TArray<FVector3f> Positions;
+	/** Three vertex indices per triangle, ordered by leaf */
+	TArray<uint32> Indices;
+	TArray<FNode> Nodes;
+
+	/**
+	 * Build the hierarchy from an indexed triangle list
+	 * @param InPositions - Vertex positions
+	 * @param InIndices - Three indices per triangle
+	 */
+	void Build(TArray<FVector3f>&& InPositions, const TArray<uint32>& InIndices);
+
+	/**
+	 * Find the closest triangle intersected by a ray (both triangle faces are hit)
+	 * @param Origin - Ray origin
+	 * @param Direction - Ray direction, doesn't need to be normalized
+	 * @param InOutT - In: maximum ray parameter. Out: ray parameter of the hit, in units of Direction
+	 * @param OutTriangle - Index of the hit triangle
+	 * @return True if a triangle was hit before InOutT
+	 */
+	bool Raycast(const FVector3f& Origin, const FVector3f& Direction, float& InOutT, int32& OutTriangle) const;
+
+	/** Get the unit normal of a triangle, following its winding */
+	FVector3f GetTriangleNormal(int32 Triangle) const;
+
+	int32 GetNumTriangles() const { return Indices.Num() / 3; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Positions.GetAllocatedSize() + Indices.GetAllocatedSize() + Nodes.GetAllocatedSize();
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FNode& Node);
+	friend FArchive& operator<<(FArchive& Ar, FMeshTriangleBVH& BVH);
+
+private:
+	int32 BuildNode(TArray<int32>& TriangleOrder, const TArray<FVector3f>& Centroids, const TArray<uint32>& SourceIndices,
+	                int32 Begin, int32 End, int32 Depth);
+};
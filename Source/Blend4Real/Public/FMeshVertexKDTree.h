@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FMeshTriangleBVH.h"
+
+/**
+ * KD-tree over the vertices of a mesh, with vertex to vertex edge adjacency, in the mesh's local space.
+ * Shares positions and triangles with the mesh's FMeshTriangleBVH. Used for vertex and edge snapping.
+ */
+struct FMeshVertexKDTree
+{
+	/** Same layout as the BVH nodes, leaves reference ranges of VertexOrder */
+	using FNode = FMeshTriangleBVH::FNode;
+
+	/** Positions and triangles the tree was built from */
+	TSharedPtr<const FMeshTriangleBVH> Mesh;
+	TArray<uint32> VertexOrder;
+	TArray<FNode> Nodes;
+
+	/** Compressed adjacency: neighbors of vertex V are EdgeNeighbors[EdgeOffsets[V] .. EdgeOffsets[V + 1]] */
+	TArray<uint32> EdgeOffsets;
+	TArray<uint32> EdgeNeighbors;
+
+	/** Build the tree and the edge adjacency from a mesh BVH */
+	void Build(const TSharedPtr<const FMeshTriangleBVH>& InMesh);
+
+	/**
+	 * Visit the vertices of the nodes accepted by the filter
+	 * @param NodeFilter - Returns false to skip a node (given its local bounds) and its children
+	 * @param Visit - Called with the index of each vertex in an accepted leaf
+	 */
+	void ForEachVertex(TFunctionRef<bool(const FVector3f& Min, const FVector3f& Max)> NodeFilter,
+	                   TFunctionRef<void(uint32 Vertex)> Visit) const;
+
+	/** Get the vertices sharing an edge with the given vertex */
+	TConstArrayView<uint32> GetNeighbors(const uint32 Vertex) const
+	{
+		return MakeArrayView(EdgeNeighbors.GetData() + EdgeOffsets[Vertex], EdgeOffsets[Vertex + 1] - EdgeOffsets[Vertex]);
+	}
+
+	const FVector3f& GetPosition(const uint32 Vertex) const { return Mesh->Positions[Vertex]; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return VertexOrder.GetAllocatedSize() + Nodes.GetAllocatedSize() + EdgeOffsets.GetAllocatedSize()
+			+ EdgeNeighbors.GetAllocatedSize();
+	}
+
+private:
+	int32 BuildNode(int32 Begin, int32 End, int32 Depth);
+};
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FInteractionQualityController.h"
 
 class FEditorViewportClient;
+class FViewportRedrawController;
+class FHoverPickPrefetcher;
 
 /**
  * Handles camera navigation operations: orbit, pan, and focus
@@ -10,7 +13,8 @@ class FEditorViewportClient;
 class FNavigationController
 {
 public:
-	FNavigationController();
+	FNavigationController(TSharedPtr<FViewportRedrawController> InRedrawController,
+	                      TSharedPtr<FHoverPickPrefetcher> InHoverPickPrefetcher);
 
 	/** Start orbiting around a pivot point */
 	void BeginOrbit(const FVector2D& MousePosition);
@@ -70,6 +74,15 @@ private:
 	/** Disable high-precision mouse mode and restore cursor position */
 	void DisableHighPrecisionMouseMode();
 
+	/** Merges viewport redraws requested by several mouse events into one per frame */
+	TSharedPtr<FViewportRedrawController> RedrawController;
+
+	/** Provides the scene pick under the cursor, traced in the background before the button press */
+	TSharedPtr<FHoverPickPrefetcher> HoverPickPrefetcher;
+
+	/** Lowers the rendering quality of the captured viewport while navigating */
+	FInteractionQualityController InteractionQuality;
+
 	bool bIsOrbiting = false;
 	bool bIsPanning = false;
 	bool bHighPrecisionMouseEnabled = false;
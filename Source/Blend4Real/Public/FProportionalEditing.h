@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blend4RealSettings.h"
+
+class AActor;
+class UWorld;
+
+/**
+ * Moves the unselected actors around the selection with a falloff (Blender's proportional editing).
+ *
+ * The candidate actors are gathered from the actor bounds tree around the selection when the transform starts, and
+ * again when the radius grows past the gathered range. Their pivots are stored in a uniform spatial hash,
+ * so finding the neighbours in range of the selection only visits the cells the radius overlaps.
+ * The weights only depend on the initial positions and the radius: they are computed again when the radius changes,
+ * not when the selection moves.
+ */
+class FProportionalEditing
+{
+public:
+	/**
+	 * Start moving the neighbours of the selection
+	 * @param World - World whose actors are candidates
+	 * @param ExcludedActors - Selected actors, moved by the transform handler
+	 * @param InSelectedPivots - Initial locations of the selected items, the distances are measured from them
+	 * @param InRadius - Distance where the influence reaches zero
+	 */
+	void Begin(UWorld* World, const TSet<const AActor*>& ExcludedActors, const TArray<FVector>& InSelectedPivots,
+	           float InRadius);
+
+	/**
+	 * Stop moving the neighbours
+	 * @param bApply - Keep the neighbours where they are and notify them the move is finished, or restore them
+	 */
+	void End(bool bApply);
+
+	/** Append the neighbours moved since Begin() */
+	void GetMovedActors(TArray<AActor*>& OutActors) const;
+
+	bool IsActive() const { return bIsActive; }
+
+	/** Move each neighbour with the pivot delta, scaled by its weight */
+	void Apply(const FTransform& InitialPivot, const FTransform& NewPivot);
+
+	/** Change the radius, find the neighbours again and move them with the last applied pivot */
+	void SetRadius(float InRadius);
+
+	float GetRadius() const { return Radius; }
+
+	/** Number of neighbours within the radius */
+	int32 GetNumAffected() const { return Weights.Num(); }
+
+	/** Weight of a neighbour at the given distance from the selection, in [0, 1] */
+	static float ComputeFalloff(EBlend4RealProportionalFalloff Falloff, float Distance, float InRadius);
+
+private:
+	struct FCellRange
+	{
+		int32 Start = 0;
+		int32 Num = 0;
+	};
+
+	/** Add the candidates pivoted within InGatherRadius of the selected pivots bounds, from the actor bounds tree */
+	void GatherCandidates(float InGatherRadius);
+	void BuildHash(double InCellSize);
+	FIntVector GetCell(const FVector& Location) const;
+	void UpdateWeights();
+	void SetNeighbourTransform(int32 Index, const FTransform& Transform);
+	void RestoreNeighbour(int32 Index, bool bFinished);
+
+	bool bIsActive = false;
+
+	/** Neighbours are only notified of their move when it ends (World Partition levels) */
+	bool bDeferMoveUpdates = false;
+	float Radius = 0.f;
+
+	/** Candidate actors and their initial pivots, indexed the same way */
+	TArray<TWeakObjectPtr<AActor>> Candidates;
+	TArray<FVector> CandidatePivots;
+
+	/** Gathering state, to add candidates when the radius grows */
+	TWeakObjectPtr<UWorld> CandidateWorld;
+	TSet<const AActor*> CandidateExcludedActors;
+	TSet<const AActor*> CandidateActors;
+	FBox SelectedPivotBounds = FBox(ForceInit);
+	float GatheredRadius = 0.f;
+
+	/** Uniform spatial hash: candidate indices sorted by cell, and the range of each cell */
+	double CellSize = 0.0;
+	TArray<int32> CellItems;
+	TMap<FIntVector, FCellRange> Cells;
+
+	TArray<FVector> SelectedPivots;
+
+	/** Weight of each neighbour within the radius, keyed by candidate index */
+	TMap<int32, float> Weights;
+
+	/** Initial transform of each neighbour moved since Begin, keyed by candidate index */
+	TMap<int32, FTransform> InitialTransforms;
+
+	/** Last applied pivot, to move the neighbours again when the radius changes */
+	FTransform LastInitialPivot;
+	FTransform LastPivot;
+	bool bHasLastPivot = false;
+};
@@ -14,8 +14,13 @@ class USceneComponent;
  *
  * Key differences from FComponentTransformHandler:
  * - Selection comes from the subobject editor tree, not GEditor
- * - Must write transforms to both template (for persistence) and preview instance (for visualization)
+ * - Must write transforms to both template (for persistence) and preview instance (for visualization).
+ *   Only the preview instances move during the transform, the templates are written once when the transaction ends.
  * - Uses the preview scene world for visualization
+ *
+ * The selected nodes are resolved once into their template and preview instance components. The node selection is
+ * only checked again when a transform or transaction begins; during the drag the nodes are only resolved again when the
+ * Blueprint editor rebuilds its preview actor or a resolved component is gone.
  */
 class FSCSTransformHandler : public IBlend4RealTransformHandler
 {
@@ -61,9 +66,41 @@ private:
 	/** Get all selected nodes that are transformable */
 	TArray<TSharedPtr<FSubobjectEditorTreeNode>> GetTransformableSelectedNodes() const;
 
+	/** A transformable selected node, resolved to its components */
+	struct FResolvedNode
+	{
+		FSubobjectDataHandle Handle;
+		TWeakObjectPtr<USceneComponent> Template;
+		TWeakObjectPtr<USceneComponent> Instance;
+		/** World transform of the preview instance when the transform began */
+		FTransform Initial;
+	};
+
+	/** Get the resolved selected nodes, resolving them again if the preview actor changed or a component is gone */
+	const TArray<FResolvedNode>& GetResolvedNodes() const;
+
+	/** Resolve the selected nodes again if the node selection changed. Called when a transform or transaction begins */
+	void RefreshResolvedNodes();
+
+	/** Resolve the transformable selected nodes into their components */
+	void ResolveNodes(TArray<FSubobjectDataHandle>&& Selection) const;
+
+	/** Handles of all the selected nodes, transformable or not */
+	TArray<FSubobjectDataHandle> GetSelectedHandles() const;
+
+	/** Write the relative transform of the moved preview instances to their template */
+	void WriteTemplates();
+
 	/** Weak reference to the Blueprint editor */
 	TWeakPtr<FBlueprintEditor> BlueprintEditorPtr;
 
-	/** Stored initial transforms keyed by subobject data handle */
-	TMap<FSubobjectDataHandle, FTransform> InitialTransforms;
+	mutable TArray<FResolvedNode> ResolvedNodes;
+	/** Preview actor the nodes were resolved against */
+	mutable TWeakObjectPtr<AActor> ResolvedPreviewActor;
+	/** Handles of all the selected nodes when they were resolved, transformable or not */
+	mutable TArray<FSubobjectDataHandle> ResolvedSelection;
+	mutable bool bResolved = false;
+
+	/** True when preview instances moved since the templates were written */
+	bool bTemplatesDirty = false;
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+
+struct FCollisionQueryParams;
+
+/**
+ * Scene picking engine used by ScenePickAtPosition and ProjectToSurface.
+ *
+ * Picks in two phases: the first primitive blocking the ray with its simple collision is traced against its
+ * complex collision, then only the primitives whose bounds the ray crosses before that hit (found through the actor
+ * bounds tree) are traced against their complex collision. Primitives without simple collision in front of it are
+ * still picked by that second phase.
+ * Static meshes without any collision are picked through FMeshBVHPicker.
+ */
+class FScenePicker
+{
+public:
+	/**
+	 * Trace the scene along a ray, returning the nearest complex collision hit on the ECC_Camera channel
+	 * @param World - World to trace in
+	 * @param Start - Ray start position
+	 * @param Direction - Ray direction (should be normalized)
+	 * @param Params - Collision query parameters (ignored actors and components are respected)
+	 * @param MaxDistance - Maximum trace length, further clipped to the world bounds
+	 * @return Hit result, invalid if nothing was hit
+	 */
+	static FHitResult Trace(const UWorld* World, const FVector& Start, const FVector& Direction,
+	                        const FCollisionQueryParams& Params, float MaxDistance);
+
+	/** Two-phase trace over exactly MaxDistance, regardless of the two-phase picking setting */
+	static FHitResult TraceTwoPhase(const UWorld* World, const FVector& Start, const FVector& Direction,
+	                                const FCollisionQueryParams& Params, float MaxDistance);
+
+	/** Single complex trace against the whole world, the behavior before two-phase picking */
+	static FHitResult TraceComplex(const UWorld* World, const FVector& Start, const FVector& Direction,
+	                               const FCollisionQueryParams& Params, float MaxDistance);
+
+	/**
+	 * Compute how far a ray needs to be traced: MaxDistance, clipped to where the ray leaves the world bounds
+	 * (union of the level bounds actors). Returns MaxDistance when the bounds are unknown or the ray misses them.
+	 */
+	static float ComputeTraceLength(const UWorld* World, const FVector& Start, const FVector& Direction,
+	                                float MaxDistance);
+};
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FSelectionTraceFilter.h"
+#include "Engine/HitResult.h"
+#include "WorldCollision.h"
+#include "Framework/Notifications/NotificationManager.h"
 
 class FTransformController;
+class FViewportRedrawController;
 
 /**
- * Handles selection-based actions: delete and duplicate
+ * Handles selection-based actions: delete, duplicate, repeat last and drop to surface
  */
 class FSelectionActionsController
 {
@@ -13,15 +18,92 @@ public:
 	/**
 	 * Constructor
 	 * @param InTransformController - Reference to transform controller for duplicate+grab
+	 * @param InRedrawController - Viewport redraw coalescing, shared with the other controllers
 	 */
-	explicit FSelectionActionsController(TSharedPtr<FTransformController> InTransformController);
+	FSelectionActionsController(TSharedPtr<FTransformController> InTransformController,
+	                            TSharedPtr<FViewportRedrawController> InRedrawController);
 
 	/** Duplicate selected actors and immediately enter grab mode */
 	void DuplicateSelectedAndGrab() const;
 
+	/**
+	 * Duplicate the selected static mesh actors as instances of per-mesh HISM components,
+	 * on a container actor of the current level, and immediately grab the new instances
+	 */
+	void InstancedDuplicateSelectedAndGrab() const;
+
 	/** Delete all selected actors */
 	void DeleteSelected();
 
+	/**
+	 * Sweep the bounds of every selected actor along the drop direction, as async sweeps.
+	 * The actors are placed on their first hit by Tick(), in a single transaction, once every sweep completed.
+	 */
+	void DropSelectedToSurface();
+
+	/**
+	 * Duplicate the selection RepeatLastCount times, each copy moved by the last confirmed transform from the previous one.
+	 * The copies are spawned by Tick() within a per frame time budget, in a single transaction.
+	 */
+	void RepeatLastTransform();
+
+	/** Destroy the copies spawned so far by Repeat Last and cancel its transaction */
+	void CancelRepeat();
+
+	/** Returns true while Repeat Last is spawning copies */
+	bool IsRepeating() const { return RepeatSources.Num() > 0; }
+
+	/** Cancel Repeat Last and the drops in progress, e.g. before Tick() stops being called */
+	void CancelPendingOperations();
+
+	/** Spawn the next copies of Repeat Last and apply the drop to surface results once available. Called every frame */
+	void Tick();
+
 private:
+	struct FPendingDrop
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FTraceHandle Sweep;
+		FHitResult Hit;
+		bool bCompleted = false;
+	};
+
+	/** Move the dropped actors to their hits in one transaction */
+	void ApplyDrops();
+
+	/** Spawn the next copies of Repeat Last, one DuplicateActors() batch per copy, until the frame budget is spent */
+	void TickRepeat();
+
+	/** Commit the Repeat Last transaction and select the last copy */
+	void FinishRepeat();
+
+	void ResetRepeat();
+
 	TWeakPtr<FTransformController> TransformController;
+	TSharedPtr<FViewportRedrawController> RedrawController;
+
+	// Drop to surface in progress
+	TArray<FPendingDrop> PendingDrops;
+	TWeakObjectPtr<UWorld> DropWorld;
+	FVector DropDirection = FVector::DownVector;
+	bool bDropAlignToNormal = false;
+	double DropIssueTime = 0.0;
+
+	/** Excludes the dropped actors from the sweeps, so they don't land on each other */
+	FSelectionTraceFilter DropTraceFilter;
+
+	// Repeat last in progress
+	TArray<TWeakObjectPtr<AActor>> RepeatSources;
+	TArray<FTransform> RepeatSourceTransforms;
+	/** Pivot of the sources, then the pivot of each copy */
+	TArray<FTransform> RepeatPivots;
+	/** Next copy of the sources to spawn, from 1 (RepeatPivots index) */
+	int32 NextRepeatCopy = 0;
+	TArray<TWeakObjectPtr<AActor>> RepeatCopies;
+	/** Copies of the last repetition, selected when done */
+	TArray<TWeakObjectPtr<AActor>> RepeatLastCopies;
+	TWeakObjectPtr<ULevel> RepeatLevel;
+	int32 RepeatTransactionIndex = -1;
+	bool bRepeatTranslationOnly = false;
+	FProgressNotificationHandle RepeatProgress;
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+
+class UInstancedStaticMeshComponent;
+class UPrimitiveComponent;
+
+/**
+ * Excludes the moving selection from scene traces at a constant cost per hit, whatever the selection size.
+ *
+ * Instead of growing the ignore lists of FCollisionQueryParams (checked linearly by every trace),
+ * the selected primitives are tagged with a reserved body mask filter bit for the duration of the transform,
+ * and the query params ignore that bit. The previous mask filters are restored when the filter ends.
+ * Blueprint actors whose construction script runs on drag recreate their components without the bit,
+ * so they are ignored through the actor ignore list instead.
+ */
+class FSelectionTraceFilter
+{
+public:
+	/** Mask filter bit reserved for the moving selection, from the settings */
+	static FMaskFilter GetSelectionMaskFilter();
+
+	~FSelectionTraceFilter() { End(); }
+
+	/** Tag the primitives of the selected actors and components of the editor */
+	void BeginFromEditorSelection();
+
+	/**
+	 * Tag the primitives tagged by a previous filter, see GetTaggedComponents()
+	 * @return False if one of them was destroyed since, nothing is tagged then
+	 */
+	bool BeginFromComponents(const TArray<TWeakObjectPtr<UPrimitiveComponent>>& Components);
+
+	/** Tag a primitive moved outside of the editor selection */
+	void Tag(UPrimitiveComponent* Component);
+
+	/** Tag instances moved outside of the editor selection, through their instance bodies */
+	void TagInstances(UInstancedStaticMeshComponent* Component, const TArray<int32>& Indices);
+
+	/** Get the primitives currently tagged */
+	void GetTaggedComponents(TArray<TWeakObjectPtr<UPrimitiveComponent>>& OutComponents) const;
+
+	/** Restore the mask filters of the tagged primitives */
+	void End();
+
+	/** Make traces using these params ignore the tagged primitives. Call once the primitives are tagged */
+	void ApplyTo(FCollisionQueryParams& Params) const;
+
+	/**
+	 * Returns true if a trace using these params should skip the component.
+	 * Shared by the traces that don't go through physics (e.g. FMeshBVHPicker).
+	 */
+	static bool IsIgnored(const UPrimitiveComponent* Component, const FCollisionQueryParams& Params);
+
+private:
+	/** Tagged primitives and their mask filter before tagging */
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FMaskFilter> PreviousFilters;
+
+	/** Tagged instances of a component and their mask filter before tagging, indexed like Indices */
+	struct FTaggedInstances
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+		TArray<int32> Indices;
+		TArray<FMaskFilter> PreviousFilters;
+	};
+	TArray<FTaggedInstances> TaggedInstances;
+
+	/** Owners of tagged primitives whose construction script runs on drag */
+	TArray<TWeakObjectPtr<const AActor>> IgnoredActors;
+
+	/** Bit the primitives are tagged with, read from the settings when the filter begins */
+	FMaskFilter MaskFilter = 0;
+};
@@ -7,12 +7,21 @@ class USplineComponent;
 
 /**
  * Transform handler for spline control points.
- * Uses the spline visualizer's selection state to determine which points to transform.
+ * Uses the spline visualizers' selection state to determine which points to transform.
+ * Points selected on several spline components are transformed together, grouped per component.
+ *
+ * Points are written as the transform is applied, each modified spline is updated once per frame
+ * from FlushDeferredUpdates(). On splines with at least IncrementalSplineMinPoints points, drags only measure
+ * the segments next to the moved points again, instead of the whole reparameterization table.
+ * The splines are fully updated on confirm.
  */
 class FSplinePointTransformHandler : public IBlend4RealTransformHandler
 {
 public:
 	FSplinePointTransformHandler(USplineComponent* InSplineComp, const TSet<int32>& InSelectedKeys);
+
+	/** @param InSelectedKeys - Selected control points, per spline component */
+	explicit FSplinePointTransformHandler(const TMap<USplineComponent*, TSet<int32>>& InSelectedKeys);
 	virtual ~FSplinePointTransformHandler() override = default;
 
 	// === Selection Queries ===
@@ -31,6 +40,7 @@ public:
 	// === Transform Application ===
 	virtual void ApplyTransformAroundPivot(const FTransform& InitialPivot, const FTransform& NewPivotTransform) override;
 	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) override;
+	virtual void FlushDeferredUpdates() override;
 
 	// === Transaction Handling ===
 	virtual int32 BeginTransaction(const FText& Description) override;
@@ -38,12 +48,6 @@ public:
 	virtual void CancelTransaction(int32 TransactionIndex) override;
 
 private:
-	/** The spline component being edited */
-	TWeakObjectPtr<USplineComponent> SplineComponent;
-
-	/** Indices of selected control points */
-	TSet<int32> SelectedPointIndices;
-
 	/** Initial state for each control point (for cancel/restore) */
 	struct FPointState
 	{
@@ -53,5 +57,31 @@ private:
 		FVector ArriveTangent;
 		FVector LeaveTangent;
 	};
-	TMap<int32, FPointState> InitialPointStates;
+
+	/** Selected points of one spline component */
+	struct FSplineGroup
+	{
+		/** The spline component being edited */
+		TWeakObjectPtr<USplineComponent> SplineComponent;
+
+		/** Indices of selected control points */
+		TSet<int32> SelectedPointIndices;
+
+		TMap<int32, FPointState> InitialPointStates;
+
+		/** True when points moved since the spline was last updated */
+		bool bDirty = false;
+	};
+
+	/** True if drags update the modified segments of the spline only */
+	static bool UseIncrementalUpdates(const FSplineGroup& Group);
+
+	/**
+	 * Update the spline after the selected points moved, during a drag.
+	 * Recomputes the reparameterization entries of the segments next to the selected points and shifts the others.
+	 */
+	static void UpdateModifiedSegments(const FSplineGroup& Group);
+
+	TArray<FSplineGroup> Groups;
+	int32 NumSelectedPoints = 0;
 };
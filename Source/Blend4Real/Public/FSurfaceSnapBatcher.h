@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "WorldCollision.h"
+
+/**
+ * Projects each item of a multi-selection onto the surface below its own position (Blender's "snap each").
+ *
+ * The group translation follows the cursor, and every item is traced down from its translated position.
+ * Traces are issued as one batch of async traces per frame, capped by MaxSurfaceSnapTracesInFlight,
+ * and their results are returned on a later frame so large selections stay interactive.
+ */
+class FSurfaceSnapBatcher
+{
+public:
+	/**
+	 * Start projecting a set of items
+	 * @param InWorld - World to trace in
+	 * @param InParams - Query parameters, should ignore the moved items
+	 * @param InitialTransforms - Initial world transform of each item, keyed by handler item id
+	 */
+	void Begin(UWorld* InWorld, const FCollisionQueryParams& InParams, const TMap<uint32, FTransform>& InitialTransforms);
+
+	/** Stop projecting and ignore the traces in flight */
+	void End();
+
+	bool IsActive() const { return Items.Num() > 0; }
+
+	/**
+	 * Set the translation applied to every item before its projection. Items are traced again on the next Tick.
+	 * @param Translation - Translation of the group from the initial transforms
+	 * @param InSurfaceOffset - Distance kept from the surface, along its normal
+	 * @param bInAlignToNormal - Rotate the items so their Z axis follows the surface normal
+	 */
+	void SetGroupTranslation(const FVector& Translation, float InSurfaceOffset, bool bInAlignToNormal);
+
+	/**
+	 * Collect the completed traces and issue the traces of the items whose target moved
+	 * @param OutTransforms - Receives the new transforms of the items whose trace completed
+	 * @return True if OutTransforms isn't empty
+	 */
+	bool Tick(TMap<uint32, FTransform>& OutTransforms);
+
+	/**
+	 * Synchronously project the items whose latest target wasn't traced yet, e.g. when the transform is confirmed
+	 * @param OutTransforms - Receives the new transforms of those items
+	 */
+	void Flush(TMap<uint32, FTransform>& OutTransforms);
+
+private:
+	struct FItem
+	{
+		uint32 Id = 0;
+		FTransform Initial;
+		FVector Target = FVector::ZeroVector;
+		/** Target of the trace in flight, or of the last applied result */
+		FVector TracedTarget = FVector::ZeroVector;
+		FTraceHandle Trace;
+		double IssueTime = 0.0;
+		bool bUpToDate = false;
+	};
+
+	void IssueTrace(FItem& Item, double Now);
+	FTransform MakeItemTransform(const FItem& Item, const FVector& Target, const FHitResult& Hit) const;
+	void GetTraceSegment(const FVector& Target, FVector& OutStart, FVector& OutEnd) const;
+
+	TWeakObjectPtr<UWorld> World;
+	FCollisionQueryParams Params;
+	TArray<FItem> Items;
+	/** Round robin start, so every item gets traced when the in-flight cap is reached */
+	int32 NextIssueIndex = 0;
+	int32 NumInFlight = 0;
+	/** Traces start above the highest possible item position */
+	double TraceStartHeight = 0.0;
+	float SurfaceOffset = 0.f;
+	bool bAlignToNormal = false;
+};
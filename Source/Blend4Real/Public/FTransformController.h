@@ -3,25 +3,54 @@
 #include "CoreMinimal.h"
 #include "Blend4RealUtils.h"
 #include "CollisionQueryParams.h"
+#include "FInteractionQualityController.h"
+#include "FElementSnapper.h"
+#include "FSurfaceSnapBatcher.h"
+#include "FSelectionTraceFilter.h"
+#include "FProportionalEditing.h"
 
 class ULineBatchComponent;
 class SWindow;
 class STextBlock;
 class IBlend4RealTransformHandler;
+class FViewportRedrawController;
+class FEditorViewportClient;
+class UTypedElementSelectionSet;
 
 static constexpr uint32 TRANSFORM_BATCH_ID = 14521274;
 
+/** Pivot delta of a confirmed transform, relative to the pivot it was applied around */
+struct FRepeatableTransform
+{
+	ETransformMode Mode = ETransformMode::None;
+	FVector Translation = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Scale = FVector::OneVector;
+
+	/** Apply the delta to a pivot */
+	FTransform ApplyTo(const FTransform& Pivot) const
+	{
+		return FTransform(Rotation * Pivot.GetRotation(), Pivot.GetLocation() + Translation, Pivot.GetScale3D() * Scale);
+	}
+
+	bool IsTranslationOnly() const { return Rotation.IsIdentity() && Scale.Equals(FVector::OneVector); }
+};
+
 /**
  * Handles all object transformation operations: translate, rotate, scale
  */
 class FTransformController
 {
 public:
-	FTransformController();
+	explicit FTransformController(TSharedPtr<FViewportRedrawController> InRedrawController);
+	~FTransformController();
 
 	/** Begin a transform operation of the given mode */
 	void BeginTransform(ETransformMode Mode);
 
+	/** Begin a transform operation applied through the given handler, instead of the handler of the focused viewport */
+	void BeginTransform(ETransformMode Mode, TSharedPtr<IBlend4RealTransformHandler> Handler);
+
 	/** End the current transform operation */
 	void EndTransform(bool bApply);
 
@@ -56,10 +85,53 @@ public:
 	/** Reset transform of selected actors for the given mode */
 	void ResetTransform(ETransformMode Mode) const;
 
+	/** Pivot delta of the last confirmed transform, Mode is None if there is none */
+	const FRepeatableTransform& GetLastTransform() const { return LastTransform; }
+
+	/**
+	 * Apply the surface snapping results of the previous frames and flush the deferred handler updates.
+	 * Called every frame while transforming
+	 */
+	void Tick();
+
+	/** Toggle proportional editing, also during a transform */
+	void ToggleProportionalEditing();
+
+	/**
+	 * Grow or shrink the proportional editing radius
+	 * @param WheelDelta - Mouse wheel delta, positive grows the radius
+	 * @return False if proportional editing isn't active in the current transform
+	 */
+	bool AdjustProportionalRadius(float WheelDelta);
+
 private:
 	/** Get axis direction vector for the given axis */
 	FVector GetAxisVector(ETransformAxis::Type Axis) const;
 
+	/** Average local axis of the selection, computed once per transform since the initial state doesn't change */
+	FVector GetAverageLocalAxis(EAxis::Type Axis) const;
+
+	/** Returns true if the next transform can start from the session of the previous one */
+	bool CanReuseSession() const;
+
+	/** Forget the session of the previous transform */
+	void ReleaseSession();
+
+	/** Exclude the selection from the traces and element snapping, from the reused session if possible */
+	void BeginSelectionExclusion(bool bReusedSession);
+
+	/** Tag the instances moved by the handler, without the rest of their component */
+	void TagMovedInstances();
+
+	/** Bind the selection events that need the editor: element selection set and editor modes */
+	void BindEditorSelectionEvents();
+
+	void OnSelectionChanged(UObject* Object);
+	void OnElementSelectionChanged(const UTypedElementSelectionSet* SelectionSet);
+	void OnEditorModeChanged(const FName& ModeID, bool bIsEntering);
+	void OnObjectModified(UObject* Object);
+	void InvalidateSession();
+
 	/** Compute the transform plane based on current mode and axis */
 	FPlane ComputePlane(const FVector& InitialPos);
 
@@ -75,6 +147,24 @@ private:
 	/** Apply the internal transform state to actors */
 	void ApplyTransform(const FVector& Direction, float Value, bool InvertSnapState = false);
 
+	/** Move the selection, and its neighbours when proportional editing is active, with the pivot */
+	void ApplyPivotTransform(const FTransform& NewPivotTransform);
+
+	/** Find the neighbours of the selection moved by proportional editing */
+	void BeginProportionalEditing();
+
+	/**
+	 * Move the pivot to the mesh vertex or edge under the cursor, if element snapping is active
+	 * @return True if the selection was snapped
+	 */
+	bool TrySnapToElement(bool bInvertSnap);
+
+	/**
+	 * Move a multi-selection with the surface under the cursor, projecting each item onto the surface below it
+	 * @return False if the handler can't transform items independently
+	 */
+	bool UpdateSurfaceSnapEach(bool bInvertSnap);
+
 	// Visualization
 	void ShowTransformInfo(const FString& Text, const FVector2D& ScreenPosition);
 	void HideTransformInfo();
@@ -89,6 +179,9 @@ private:
 	ETransformAxis::Type CurrentAxis = ETransformAxis::None;
 	FString NumericBuffer;
 	FTransform TransformPivot;
+	/** Pivot transform last applied to the selection */
+	FTransform CurrentPivotTransform;
+	FRepeatableTransform LastTransform;
 	FVector DragInitialProjectedPosition = FVector::ZeroVector;
 	FVector HitLocation = FVector::ZeroVector;
 	FVector TransformViewDir = FVector::ZeroVector;
@@ -96,9 +189,83 @@ private:
 	FLinearColor OriginalSelectionColor = FLinearColor::Black;
 	FCollisionQueryParams IgnoreSelectionQueryParams;
 
+	/** Excludes the moving selection from the traces using IgnoreSelectionQueryParams */
+	FSelectionTraceFilter SelectionTraceFilter;
+
+	/** Projects each item of a multi-selection onto the surface below it */
+	FSurfaceSnapBatcher SurfaceSnapBatcher;
+
+	/** Moves the unselected actors around the selection with a falloff */
+	FProportionalEditing ProportionalEditing;
+
+	/** True once the proportional editing setting or radius changed, saved to the config on destruction */
+	bool bProportionalSettingsChanged = false;
+
+	/** Selected actors and components, never used as element snap targets */
+	FElementSnapContext SnapContext;
+	bool bHasElementSnapTarget = false;
+	FVector ElementSnapTarget = FVector::ZeroVector;
+
 	/** Current transform handler - determines how transforms are applied to selection */
 	TSharedPtr<IBlend4RealTransformHandler> TransformHandler;
 
+	/** Cached ComputeAverageLocalAxis() results of the current transform, per EAxis::X/Y/Z */
+	mutable FVector AverageLocalAxes[3];
+	mutable bool bAverageLocalAxisValid[3] = {false, false, false};
+
+	/**
+	 * Handler and selection data of the last transform, kept while the selection is unchanged.
+	 * Chained transforms (e.g. G, then R, then S) start from it instead of creating and capturing a handler again.
+	 */
+	struct FTransformSession
+	{
+		TSharedPtr<IBlend4RealTransformHandler> Handler;
+		/** SelectionGeneration the session was built at */
+		uint64 SelectionGeneration = 0;
+		FEditorViewportClient* ViewportClient = nullptr;
+		/** Primitives excluded from the traces */
+		TArray<TWeakObjectPtr<UPrimitiveComponent>> TracedOutComponents;
+		/**
+		 * Objects and bounds proxies excluded from element snapping, built for SnapElement.
+		 * The selection bounds are moved by each applied transform, invalid after a per-item surface snap.
+		 */
+		FElementSnapContext SnapContext;
+		/** Weak copies of SnapContext.ExcludedObjects, checked before the context is reused */
+		TArray<TWeakObjectPtr<const UObject>> SnapExcludedObjects;
+		EBlend4RealSnapElement SnapElement = EBlend4RealSnapElement::None;
+	};
+	FTransformSession Session;
+
+	/** True if the current transform is kept as the session of the next one */
+	bool bKeepSession = false;
+
+	/** True once the current transform snapped the items to the surface one by one */
+	bool bItemsMovedIndependently = false;
+
+	/**
+	 * Incremented whenever the editor selection changes or an undo/redo happens, including the selections USelection
+	 * doesn't report: typed elements (e.g. static mesh instances), foliage instances, spline points and editor modes
+	 */
+	uint64 SelectionGeneration = 0;
+	FDelegateHandle SelectionChangedHandle;
+	FDelegateHandle SelectObjectHandle;
+	FDelegateHandle SelectNoneHandle;
+	FDelegateHandle UndoRedoHandle;
+	FDelegateHandle ObjectModifiedHandle;
+	FDelegateHandle ElementSelectionChangedHandle;
+	FDelegateHandle EditorModeChangedHandle;
+	FDelegateHandle PostEngineInitHandle;
+	TWeakObjectPtr<UTypedElementSelectionSet> ElementSelectionSet;
+
+	/** Merges viewport redraws requested during the transform into one per frame */
+	TSharedPtr<FViewportRedrawController> RedrawController;
+
+	/** Viewport the transform was started from, redrawn at full rate during the transform */
+	FEditorViewportClient* InteractingViewportClient = nullptr;
+
+	/** Lowers the rendering quality of the interacting viewport during the transform */
+	FInteractionQualityController InteractionQuality;
+
 	// Ray state (updated during GetPlaneHit)
 	FVector RayOrigin = FVector::ZeroVector;
 	FVector RayDirection = FVector::ZeroVector;
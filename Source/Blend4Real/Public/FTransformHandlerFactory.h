@@ -11,6 +11,15 @@ class IBlend4RealTransformHandler;
 class FTransformHandlerFactory
 {
 public:
+	/**
+	 * Subscribe to the asset editor events keeping the SCS viewport to Blueprint editor map up to date.
+	 * Called on module startup, the events are bound once the editor is initialized.
+	 */
+	static void Initialize();
+
+	/** Release the map and unsubscribe. Called on module shutdown */
+	static void Shutdown();
+
 	/**
 	 * Create the appropriate transform handler based on the current viewport context.
 	 * @return A new handler instance, or nullptr if the current context is not supported.
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FEditorViewportClient;
+
+/**
+ * Coalesces viewport redraw requests made during interactive operations.
+ * Requests are only recorded when they are made, and flushed once per frame:
+ * - The viewport being interacted with is redrawn every frame
+ * - Other level viewports are redrawn at a throttled rate (see UBlend4RealSettings::InactiveViewportRedrawRate)
+ * - A full redraw of every level viewport can be requested when an operation ends
+ */
+class FViewportRedrawController
+{
+public:
+	FViewportRedrawController();
+
+	/**
+	 * Request a redraw of the viewport being interacted with.
+	 * Other level viewports are marked as stale and refreshed at the throttled rate.
+	 */
+	void RequestInteractiveRedraw(FEditorViewportClient* InteractingClient);
+
+	/** Request a redraw of a single viewport, leaving other viewports untouched */
+	void RequestRedraw(FEditorViewportClient* ViewportClient);
+
+	/** Request a redraw of all level viewports (e.g. when an operation is confirmed or cancelled) */
+	void RequestFullRedraw();
+
+	/** Perform all pending redraws. Must be called once per frame. */
+	void Flush(float DeltaTime);
+
+private:
+	/** Returns true if the viewport client is still registered in the editor */
+	static bool IsViewportClientAlive(const FEditorViewportClient* ViewportClient);
+
+	/** Viewports to redraw on next flush, merged across all requests of the frame */
+	TSet<FEditorViewportClient*> PendingClients;
+
+	/** Pending viewports redrawn as part of an interaction: their hit proxies are kept until the operation ends */
+	TSet<FEditorViewportClient*> InteractiveClients;
+
+	bool bInactiveViewportsStale = false;
+	bool bFullRedrawPending = false;
+	float TimeSinceInactiveRedraw = 0.f;
+};
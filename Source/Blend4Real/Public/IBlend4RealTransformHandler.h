@@ -3,6 +3,9 @@
 #include "CoreMinimal.h"
 #include "Blend4RealUtils.h"
 
+class AActor;
+class UInstancedStaticMeshComponent;
+
 /**
  * Abstract interface for transform handlers.
  *
@@ -57,6 +60,13 @@ public:
 	/** Restore all selected items to their initial transforms (for cancel) */
 	virtual void RestoreInitialState() = 0;
 
+	/**
+	 * Capture the initial state again, for a transform following the previous one on an unchanged selection.
+	 * Handlers caching their items when first captured read their current transforms, without walking the selection.
+	 * Returns false if the handler can't be reused, a new handler is then created for the transform.
+	 */
+	virtual bool RecaptureInitialState() { return false; }
+
 	// === Transform Application ===
 
 	/**
@@ -78,6 +88,36 @@ public:
 	 */
 	virtual void SetDirectTransform(const FVector* Location, const FRotator* Rotation, const FVector* Scale) = 0;
 
+	// === Per Item Transforms ===
+
+	/**
+	 * Get the initial world transform of each selected item, captured by CaptureInitialState().
+	 * Items are keyed by an id stable during the transform.
+	 * Returns false if the handler can't transform items independently (e.g. surface snapping of each item).
+	 */
+	virtual bool GetInitialItemTransforms(TMap<uint32, FTransform>& OutTransforms) const { return false; }
+
+	/** Set the world transform of the given items, keyed by the ids of GetInitialItemTransforms() */
+	virtual void SetItemTransforms(const TMap<uint32, FTransform>& Transforms) {}
+
+	/** Returns true if the items are level actors, whose unselected neighbours can follow with proportional editing */
+	virtual bool SupportsProportionalEditing() const { return false; }
+
+	/**
+	 * Get the instances moved by the handler, per instanced component. They aren't part of the editor selection and
+	 * are excluded from the snapping traces one by one, the other instances of their component can still be hit.
+	 */
+	virtual void GetMovedInstances(TMap<UInstancedStaticMeshComponent*, TArray<int32>>& OutInstances) const {}
+
+	/** Get the level actors moved by the handler, checked against the World Partition loaded regions on confirm */
+	virtual void GetMovedActors(TArray<AActor*>& OutActors) const {}
+
+	/**
+	 * Called once per frame during the transform.
+	 * Handlers coalescing the transforms applied during the frame write them here, and before ending the transaction.
+	 */
+	virtual void FlushDeferredUpdates() {}
+
 	// === Transaction Handling (Undo/Redo) ===
 
 	/** Begin an undo transaction with the given description */